@@ -15,7 +15,6 @@ struct DirectionalLight {
 };
 
 struct Material {
-    float specularExponent;
     sampler2D diffuseTexture0;
     sampler2D specularTexture0;
 };
@@ -24,6 +23,8 @@ in vec3 vPosition;
 in vec3 vNormal;
 in vec2 vTextureCoordinate;
 in vec4 vPositionLightSpace;
+flat in vec3 vColor;
+flat in float vSpecularExponent;
 
 uniform vec3 viewPosition;
 uniform Material material;
@@ -51,7 +52,7 @@ Lighting calculateBaseLight(vec3 lightDirection, Lighting lighting) {
     Lighting result;
 
     // Sets ambient color the same as the diffuse color
-    vec3 materialDiffuse = texture(material.diffuseTexture0, vTextureCoordinate).rgb;
+    vec3 materialDiffuse = vColor * texture(material.diffuseTexture0, vTextureCoordinate).rgb;
     result.ambient = lighting.ambient * materialDiffuse;
 
     // Fragment is brighter the closer it is aligned to the light ray direction
@@ -66,7 +67,7 @@ Lighting calculateBaseLight(vec3 lightDirection, Lighting lighting) {
     float specularAngle = dot(halfwayDirection, vNormal);
 
     result.specular = lighting.specular *
-            pow(max(specularAngle, 0.0), material.specularExponent) *
+            pow(max(specularAngle, 0.0), vSpecularExponent) *
             texture(material.specularTexture0, vTextureCoordinate).rgb;
 
     return result;
@@ -1,13 +1,18 @@
 #version 320 es
 
-in vec3 aPosition;
-in vec3 aNormal;
-in vec2 aTextureCoordinate;
+layout (location = 0) in vec3 aPosition;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTextureCoordinate;
+
+// 1 if aNormal.xy holds an octahedral encoded normal. Set by the vertex array for all vertices.
+layout (location = 3) in float aNormalEncoding;
 
 out vec3 vPosition;
 out vec3 vNormal;
 out vec2 vTextureCoordinate;
 out vec4 vPositionLightSpace;
+flat out vec3 vColor;
+flat out float vSpecularExponent;
 
 layout (std140) uniform ProjectionViewUB {
    mat4 projection_view;
@@ -17,14 +22,35 @@ layout (std140) uniform LightSpaceUB {
    mat4 lightSpace;
 };
 
-uniform mat4 model;
-uniform mat3 normal;
+struct Object {
+   highp mat4 model;
+   highp mat3 normal;
+   highp vec3 color;
+   highp float specularExponent;
+};
+
+// Instances of a draw are consecutive objects
+layout (std140) uniform ObjectUB {
+   Object objects[64];
+};
+
+vec3 decodeOctahedral(vec2 encoding) {
+   vec3 n = vec3(encoding, 1.0 - abs(encoding.x) - abs(encoding.y));
+   float t = max(-n.z, 0.0);
+   n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+   return n;
+}
 
 void main() {
-   vec4 worldPosition = model * vec4(aPosition, 1.0);
+   Object object = objects[gl_InstanceID];
+
+   vec4 worldPosition = object.model * vec4(aPosition, 1.0);
    gl_Position = projection_view * worldPosition;
    vPosition = vec3(worldPosition);
-   vNormal = normalize(vec3(normal * aNormal));
+   vec3 normal = aNormalEncoding > 0.5 ? decodeOctahedral(aNormal.xy) : aNormal;
+   vNormal = normalize(vec3(object.normal * normal));
    vTextureCoordinate = aTextureCoordinate;
    vPositionLightSpace = lightSpace * worldPosition;
+   vColor = object.color;
+   vSpecularExponent = object.specularExponent;
 }
\ No newline at end of file
@@ -1,13 +1,23 @@
 #version 320 es
 
-in vec3 aPosition;
+layout (location = 0) in vec3 aPosition;
 
 layout (std140) uniform LightSpaceUB {
     mat4 lightSpace;
 };
 
-uniform mat4 model;
+struct Object {
+    highp mat4 model;
+    highp mat3 normal;
+    highp vec3 color;
+    highp float specularExponent;
+};
+
+// Instances of a draw are consecutive objects
+layout (std140) uniform ObjectUB {
+    Object objects[64];
+};
 
 void main() {
-    gl_Position = lightSpace * model * vec4(aPosition, 1.0);
+    gl_Position = lightSpace * objects[gl_InstanceID].model * vec4(aPosition, 1.0);
 }
@@ -0,0 +1,90 @@
+// Measures the speedup of updating game objects through JobSystem::parallelFor over a serial
+// loop. Objects are stand-ins with a comparable per-object workload to GameObject::onUpdate
+// since the real GameObject requires the Android build.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <android_game_engine/JobSystem.h>
+
+namespace {
+
+struct BenchmarkObject {
+    float position[3] = {0.0f, 0.0f, 0.0f};
+    float velocity[3] = {1.0f, 0.5f, 0.25f};
+    float orientation[9] = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+
+    void onUpdate(float updateDuration) {
+        // Steer towards the origin and integrate the pose a few times to approximate the
+        // game logic, physics sync and matrix work of a typical object
+        for (auto step = 0; step < 32; ++step) {
+            for (auto i = 0; i < 3; ++i) {
+                this->velocity[i] -= this->position[i] * 0.01f;
+                this->position[i] += this->velocity[i] * updateDuration;
+            }
+
+            const auto angle = std::sqrt(this->velocity[0] * this->velocity[0] +
+                                         this->velocity[1] * this->velocity[1]) * updateDuration;
+            const auto c = std::cos(angle);
+            const auto s = std::sin(angle);
+            for (auto row = 0; row < 3; ++row) {
+                const auto x = this->orientation[row * 3];
+                const auto y = this->orientation[row * 3 + 1];
+                this->orientation[row * 3] = c * x - s * y;
+                this->orientation[row * 3 + 1] = s * x + c * y;
+            }
+        }
+    }
+};
+
+template <typename Function>
+double measure_ms(unsigned int iterations, Function function) {
+    std::vector<double> times;
+    times.reserve(iterations);
+    for (auto i = 0u; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        times.push_back(std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count());
+    }
+
+    // Median to filter out scheduling noise
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const auto numObjects = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000ul;
+    const auto iterations = 100u;
+    const auto updateDuration = 1.0f / 60.0f;
+
+    std::vector<BenchmarkObject> objects(numObjects);
+
+    const auto serial_ms = measure_ms(iterations, [&objects, updateDuration]{
+        for (auto &object : objects) {
+            object.onUpdate(updateDuration);
+        }
+    });
+
+    age::JobSystem::init();
+    const auto parallel_ms = measure_ms(iterations, [&objects, updateDuration]{
+        age::JobSystem::parallelFor(0u, objects.size(), [&objects, updateDuration](auto i){
+            objects[i].onUpdate(updateDuration);
+        });
+    });
+    const auto numThreads = age::JobSystem::getNumThreads();
+    age::JobSystem::shutdown();
+
+    std::cout << "Objects:  " << numObjects << "\n"
+              << "Threads:  " << numThreads << "\n"
+              << "Serial:   " << serial_ms << " ms\n"
+              << "Parallel: " << parallel_ms << " ms\n"
+              << "Speedup:  " << serial_ms / parallel_ms << "x" << std::endl;
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include <android_game_engine/AABBTree.h>
+
+#include <cassert>
+#include <utility>
+
+namespace age {
+
+AABBTree::AABBTree(float margin) : root(NULL_PROXY), freeList(NULL_PROXY), margin(margin) {}
+
+AABBTree::Proxy AABBTree::insert(const AABB &bounds, GameObject *gameObject) {
+    const auto leaf = this->allocateNode();
+    this->nodes[leaf].bounds = bounds.expand(this->margin);
+    this->nodes[leaf].gameObject = gameObject;
+    this->nodes[leaf].height = 0;
+
+    this->insertLeaf(leaf);
+    return leaf;
+}
+
+void AABBTree::remove(Proxy proxy) {
+    assert(this->nodes[proxy].isLeaf());
+
+    this->removeLeaf(proxy);
+    this->freeNode(proxy);
+}
+
+bool AABBTree::move(Proxy proxy, const AABB &bounds) {
+    assert(this->nodes[proxy].isLeaf());
+
+    if (this->nodes[proxy].bounds.contains(bounds)) return false;
+
+    this->removeLeaf(proxy);
+    this->nodes[proxy].bounds = bounds.expand(this->margin);
+    this->insertLeaf(proxy);
+    return true;
+}
+
+void AABBTree::clear() {
+    this->nodes.clear();
+    this->root = NULL_PROXY;
+    this->freeList = NULL_PROXY;
+}
+
+bool AABBTree::intersectsRay(const AABB &bounds, const glm::vec3 &origin,
+                             const glm::vec3 &inverseDirection, float maxDistance) {
+    // Slab test
+    const auto t1 = (bounds.getMin() - origin) * inverseDirection;
+    const auto t2 = (bounds.getMax() - origin) * inverseDirection;
+    const auto tNear = glm::min(t1, t2);
+    const auto tFar = glm::max(t1, t2);
+
+    const auto tEnter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    const auto tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return tEnter <= tExit;
+}
+
+AABBTree::Proxy AABBTree::allocateNode() {
+    if (this->freeList == NULL_PROXY) {
+        this->nodes.emplace_back();
+        return static_cast<Proxy>(this->nodes.size() - 1u);
+    }
+
+    const auto node = this->freeList;
+    this->freeList = this->nodes[node].parent;
+    this->nodes[node] = Node();
+    return node;
+}
+
+void AABBTree::freeNode(Proxy node) {
+    this->nodes[node] = Node();
+    this->nodes[node].parent = this->freeList;
+    this->freeList = node;
+}
+
+void AABBTree::insertLeaf(Proxy leaf) {
+    if (this->root == NULL_PROXY) {
+        this->root = leaf;
+        this->nodes[leaf].parent = NULL_PROXY;
+        return;
+    }
+
+    // Descend to the sibling with the lowest cost, which is the surface area that is added to the
+    // tree by pairing the leaf with it
+    const auto leafBounds = this->nodes[leaf].bounds;
+    auto index = this->root;
+    while (!this->nodes[index].isLeaf()) {
+        const auto &node = this->nodes[index];
+
+        const auto area = node.bounds.getSurfaceArea();
+        const auto combinedArea = AABB::merge(node.bounds, leafBounds).getSurfaceArea();
+
+        // Cost of creating a new parent for this node and the new leaf
+        const auto cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        const auto inheritanceCost = 2.0f * (combinedArea - area);
+
+        const auto getDescendCost = [this, &leafBounds, inheritanceCost](Proxy child) {
+            const auto &childBounds = this->nodes[child].bounds;
+            const auto mergedArea = AABB::merge(childBounds, leafBounds).getSurfaceArea();
+            return this->nodes[child].isLeaf() ?
+                   mergedArea + inheritanceCost :
+                   mergedArea - childBounds.getSurfaceArea() + inheritanceCost;
+        };
+
+        const auto cost1 = getDescendCost(node.child1);
+        const auto cost2 = getDescendCost(node.child2);
+        if (cost < cost1 && cost < cost2) break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    // Replace the sibling with a new parent of the sibling and the leaf
+    const auto sibling = index;
+    const auto oldParent = this->nodes[sibling].parent;
+    const auto newParent = this->allocateNode();
+
+    auto &parent = this->nodes[newParent];
+    parent.parent = oldParent;
+    parent.bounds = AABB::merge(leafBounds, this->nodes[sibling].bounds);
+    parent.height = this->nodes[sibling].height + 1;
+    parent.child1 = sibling;
+    parent.child2 = leaf;
+
+    if (oldParent == NULL_PROXY) {
+        this->root = newParent;
+    } else if (this->nodes[oldParent].child1 == sibling) {
+        this->nodes[oldParent].child1 = newParent;
+    } else {
+        this->nodes[oldParent].child2 = newParent;
+    }
+
+    this->nodes[sibling].parent = newParent;
+    this->nodes[leaf].parent = newParent;
+
+    this->refit(this->nodes[leaf].parent);
+}
+
+void AABBTree::removeLeaf(Proxy leaf) {
+    if (leaf == this->root) {
+        this->root = NULL_PROXY;
+        return;
+    }
+
+    // Replace the leaf's parent with the leaf's sibling
+    const auto parent = this->nodes[leaf].parent;
+    const auto grandParent = this->nodes[parent].parent;
+    const auto sibling = this->nodes[parent].child1 == leaf ?
+                         this->nodes[parent].child2 : this->nodes[parent].child1;
+
+    this->nodes[sibling].parent = grandParent;
+    this->freeNode(parent);
+
+    if (grandParent == NULL_PROXY) {
+        this->root = sibling;
+        return;
+    }
+
+    if (this->nodes[grandParent].child1 == parent) {
+        this->nodes[grandParent].child1 = sibling;
+    } else {
+        this->nodes[grandParent].child2 = sibling;
+    }
+
+    this->refit(grandParent);
+}
+
+void AABBTree::refit(Proxy node) {
+    while (node != NULL_PROXY) {
+        node = this->balance(node);
+
+        auto &refitted = this->nodes[node];
+        const auto &child1 = this->nodes[refitted.child1];
+        const auto &child2 = this->nodes[refitted.child2];
+        refitted.height = 1 + std::max(child1.height, child2.height);
+        refitted.bounds = AABB::merge(child1.bounds, child2.bounds);
+
+        node = refitted.parent;
+    }
+}
+
+AABBTree::Proxy AABBTree::balance(Proxy iA) {
+    // Rotates the higher child of A up into A's place if A's children differ in height by more
+    // than 1. A then adopts the lower grandchild of the rotated child.
+    auto &a = this->nodes[iA];
+    if (a.isLeaf() || a.height < 2) return iA;
+
+    const auto iB = a.child1;
+    const auto iC = a.child2;
+    auto &b = this->nodes[iB];
+    auto &c = this->nodes[iC];
+
+    const auto replaceChild = [this, iA](Proxy parent, Proxy newChild) {
+        if (parent == NULL_PROXY) {
+            this->root = newChild;
+        } else if (this->nodes[parent].child1 == iA) {
+            this->nodes[parent].child1 = newChild;
+        } else {
+            this->nodes[parent].child2 = newChild;
+        }
+    };
+
+    const auto heightDifference = c.height - b.height;
+
+    // Rotate C up
+    if (heightDifference > 1) {
+        const auto iF = c.child1;
+        const auto iG = c.child2;
+        auto &f = this->nodes[iF];
+        auto &g = this->nodes[iG];
+
+        c.child1 = iA;
+        c.parent = a.parent;
+        a.parent = iC;
+        replaceChild(c.parent, iC);
+
+        // Keep the higher grandchild under C
+        auto &higher = f.height > g.height ? f : g;
+        auto &lower = f.height > g.height ? g : f;
+        c.child2 = f.height > g.height ? iF : iG;
+        a.child2 = f.height > g.height ? iG : iF;
+        lower.parent = iA;
+
+        a.bounds = AABB::merge(b.bounds, lower.bounds);
+        c.bounds = AABB::merge(a.bounds, higher.bounds);
+        a.height = 1 + std::max(b.height, lower.height);
+        c.height = 1 + std::max(a.height, higher.height);
+        return iC;
+    }
+
+    // Rotate B up
+    if (heightDifference < -1) {
+        const auto iD = b.child1;
+        const auto iE = b.child2;
+        auto &d = this->nodes[iD];
+        auto &e = this->nodes[iE];
+
+        b.child1 = iA;
+        b.parent = a.parent;
+        a.parent = iB;
+        replaceChild(b.parent, iB);
+
+        // Keep the higher grandchild under B
+        auto &higher = d.height > e.height ? d : e;
+        auto &lower = d.height > e.height ? e : d;
+        b.child2 = d.height > e.height ? iD : iE;
+        a.child1 = d.height > e.height ? iE : iD;
+        lower.parent = iA;
+
+        a.bounds = AABB::merge(c.bounds, lower.bounds);
+        b.bounds = AABB::merge(a.bounds, higher.bounds);
+        a.height = 1 + std::max(c.height, lower.height);
+        b.height = 1 + std::max(a.height, higher.height);
+        return iB;
+    }
+
+    return iA;
+}
+
+} // namespace age
@@ -1,9 +1,23 @@
 #include <android_game_engine/Asset.h>
 
+#include <utility>
+
 namespace age {
 
 Asset::Asset(AAsset *asset) : asset(asset), length(AAsset_getLength(asset)) {}
 
-Asset::~Asset() {AAsset_close(this->asset);}
+Asset::Asset(Asset &&other) noexcept : asset(other.asset), length(other.length) {
+    other.asset = nullptr;
+}
+
+Asset& Asset::operator=(Asset &&other) noexcept {
+    std::swap(this->asset, other.asset);
+    std::swap(this->length, other.length);
+    return *this;
+}
+
+Asset::~Asset() {
+    if (this->asset) AAsset_close(this->asset);
+}
 
-} // namespace age
\ No newline at end of file
+} // namespace age
@@ -1,7 +1,9 @@
 #include <android_game_engine/Box.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <utility>
 
 #include <BulletCollision/CollisionShapes/btBoxShape.h>
 #include <LinearMath/btVector3.h>
@@ -134,6 +136,36 @@ const std::vector<glm::uvec3> indices {
     {21u, 20u, 23u}
 };
 
+// Boxes with the same texture repeat share their vertex array so that they can be drawn
+// instanced
+std::map<std::pair<float, float>, std::weak_ptr<age::VertexArray>> vertexArrays;
+
+std::shared_ptr<age::VertexArray> getVertexArray(const glm::vec2 &numTextureRepeat);
+
+std::shared_ptr<age::VertexArray> getVertexArray(const glm::vec2 &numTextureRepeat) {
+    const std::pair<float, float> key(numTextureRepeat.x, numTextureRepeat.y);
+    auto &cachedVao = vertexArrays[key];
+    auto vao = cachedVao.lock();
+    if (vao) return vao;
+
+    std::vector<glm::vec2> repeatTextureCoords(textureCoordinates);
+    std::transform(repeatTextureCoords.begin(), repeatTextureCoords.end(),
+                   repeatTextureCoords.begin(),
+                   [numTextureRepeat](const auto &tc){
+                       return glm::vec2(tc.x * numTextureRepeat.x, tc.y * numTextureRepeat.y);
+                   });
+    auto vaoDeleter = [key](auto vao) {
+        vertexArrays.erase(key);
+        delete vao;
+    };
+    vao = std::shared_ptr<age::VertexArray>(
+            new age::VertexArray(positions, normals, repeatTextureCoords, indices,
+                                 age::VertexLayout::compact()),
+            vaoDeleter);
+    cachedVao = vao;
+    return vao;
+}
+
 } // namespace
 
 namespace age {
@@ -164,15 +196,7 @@ void Box::init(const std::vector<age::Texture2D> &diffuseTextures,
                const std::vector<age::Texture2D> &specularTextures,
                const glm::vec2 &numTextureRepeat) {
     // Create mesh
-    std::vector<glm::vec2> repeatTextureCoords(textureCoordinates);
-    std::transform(repeatTextureCoords.begin(), repeatTextureCoords.end(),
-                   repeatTextureCoords.begin(),
-                   [numTextureRepeat](const auto &tc){
-                       return glm::vec2(tc.x * numTextureRepeat.x, tc.y * numTextureRepeat.y);
-                   });
-    auto vao = std::make_shared<VertexArray>(positions, normals, repeatTextureCoords, indices);
-
-    std::shared_ptr<Meshes> meshes(new Meshes{Mesh(std::move(vao),
+    std::shared_ptr<Meshes> meshes(new Meshes{Mesh(getVertexArray(numTextureRepeat),
                                                    diffuseTextures,
                                                    specularTextures)});
     this->setMesh(std::move(meshes));
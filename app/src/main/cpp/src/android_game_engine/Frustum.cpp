@@ -0,0 +1,71 @@
+#include <android_game_engine/Frustum.h>
+
+#include <cmath>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+namespace age {
+
+Frustum::Frustum(const glm::mat4 &projectionView) {
+    // Clip planes are combinations of the rows of the projection view matrix (Gribb & Hartmann).
+    // The planes are not normalized as only the sign of the distance to them is tested.
+    const auto row = [&projectionView](int i) {
+        return glm::vec4(projectionView[0][i], projectionView[1][i],
+                         projectionView[2][i], projectionView[3][i]);
+    };
+
+    const glm::vec4 planes[NUM_PLANES] = {
+        row(3) + row(0), // Left
+        row(3) - row(0), // Right
+        row(3) + row(1), // Bottom
+        row(3) - row(1), // Top
+        row(3) + row(2), // Near
+        row(3) - row(2), // Far
+        {0.0f, 0.0f, 0.0f, 1.0f},
+        {0.0f, 0.0f, 0.0f, 1.0f}
+    };
+
+    for (auto i = 0u; i < NUM_PLANES; ++i) {
+        this->normalX[i] = planes[i].x;
+        this->normalY[i] = planes[i].y;
+        this->normalZ[i] = planes[i].z;
+        this->distance[i] = planes[i].w;
+    }
+}
+
+bool Frustum::intersects(const AABB &box) const {
+    // A box is outside of a plane if its corner that is furthest along the plane's normal is
+    // behind it. All planes are tested without branching so that the loop vectorizes.
+    auto outside = 0;
+    for (auto i = 0u; i < NUM_PLANES; ++i) {
+        const auto centerDistance = this->normalX[i] * box.center.x +
+                                    this->normalY[i] * box.center.y +
+                                    this->normalZ[i] * box.center.z +
+                                    this->distance[i];
+        const auto radius = std::abs(this->normalX[i]) * box.halfExtents.x +
+                            std::abs(this->normalY[i]) * box.halfExtents.y +
+                            std::abs(this->normalZ[i]) * box.halfExtents.z;
+        outside |= centerDistance + radius < 0.0f;
+    }
+    return outside == 0;
+}
+
+bool Frustum::contains(const AABB &box) const {
+    // A box is inside of a plane if its corner that is furthest against the plane's normal is in
+    // front of it
+    auto outside = 0;
+    for (auto i = 0u; i < NUM_PLANES; ++i) {
+        const auto centerDistance = this->normalX[i] * box.center.x +
+                                    this->normalY[i] * box.center.y +
+                                    this->normalZ[i] * box.center.z +
+                                    this->distance[i];
+        const auto radius = std::abs(this->normalX[i]) * box.halfExtents.x +
+                            std::abs(this->normalY[i]) * box.halfExtents.y +
+                            std::abs(this->normalZ[i]) * box.halfExtents.z;
+        outside |= centerDistance - radius < 0.0f;
+    }
+    return outside == 0;
+}
+
+} // namespace age
@@ -0,0 +1,378 @@
+#include <android_game_engine/GLState.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <GLES2/gl2ext.h>
+
+namespace {
+
+// Cached values that are unknown never match a requested value
+constexpr auto UNKNOWN = std::numeric_limits<GLuint>::max();
+
+constexpr std::array<GLenum, 5> BUFFER_TARGETS {
+    GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_PIXEL_UNPACK_BUFFER,
+    GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER
+};
+constexpr std::array<GLenum, 4> TEXTURE_TARGETS {
+    GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_EXTERNAL_OES
+};
+constexpr std::array<GLenum, 6> CAPABILITIES {
+    GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_POLYGON_OFFSET_FILL, GL_SCISSOR_TEST, GL_STENCIL_TEST
+};
+
+using TextureBindings = std::array<GLuint, TEXTURE_TARGETS.size()>;
+
+// Buffer range bound to an indexed target. Whole buffers are bound with a size of -1.
+struct IndexedBinding {
+    GLuint buffer;
+    GLintptr offset;
+    GLsizeiptr size;
+
+    bool operator==(const IndexedBinding &binding) const {
+        return this->buffer == binding.buffer && this->offset == binding.offset &&
+               this->size == binding.size;
+    }
+};
+
+struct State {
+    GLuint program;
+    GLuint vertexArray;
+    std::array<GLuint, BUFFER_TARGETS.size()> buffers;
+    std::vector<IndexedBinding> uniformBufferBindings;
+
+    GLuint activeTexture;
+    std::vector<TextureBindings> textureUnits;
+
+    GLuint drawFramebuffer;
+    GLuint readFramebuffer;
+    std::array<GLint, 4> viewport;
+
+    std::array<GLuint, CAPABILITIES.size()> capabilities;
+    GLuint cullFace;
+    GLuint depthFunc;
+    GLuint depthMask;
+    std::array<GLuint, 2> blendFunc;
+};
+
+State state;
+bool contextLost = false;
+std::thread::id contextThread;
+age::GLState::Stats frameStats;
+age::GLState::Stats lastFrameStats;
+
+template <typename Container>
+int indexOf(const Container &container, GLenum value);
+
+// Returns true if the call must be issued and updates the cached value
+template <typename T>
+bool change(T *cached, T value);
+
+template <typename Container>
+void forgetName(Container *bindings, GLuint name);
+
+template <typename Container>
+int indexOf(const Container &container, GLenum value) {
+    const auto it = std::find(container.cbegin(), container.cend(), value);
+    return it == container.cend() ? -1 : static_cast<int>(it - container.cbegin());
+}
+
+template <typename T>
+bool change(T *cached, T value) {
+    // GL objects must only be created and bound on the thread whose context is current
+    assert(age::GLState::isContextThread());
+
+    if (*cached == value) {
+        ++frameStats.numFiltered;
+        return false;
+    }
+
+    *cached = value;
+    ++frameStats.numIssued;
+    return true;
+}
+
+template <typename Container>
+void forgetName(Container *bindings, GLuint name) {
+    std::replace(bindings->begin(), bindings->end(), name, static_cast<GLuint>(0u));
+}
+
+} // namespace
+
+namespace age {
+namespace GLState {
+
+void init() {
+    GLint numTextureUnits = 0;
+    glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &numTextureUnits);
+    state.textureUnits.resize(static_cast<std::size_t>(numTextureUnits));
+
+    GLint numUniformBufferBindings = 0;
+    glGetIntegerv(GL_MAX_UNIFORM_BUFFER_BINDINGS, &numUniformBufferBindings);
+    state.uniformBufferBindings.resize(static_cast<std::size_t>(numUniformBufferBindings));
+
+    contextLost = false;
+    contextThread = std::this_thread::get_id();
+    invalidate();
+}
+
+void onContextLost() {
+    contextLost = true;
+}
+
+bool isContextLost() {
+    return contextLost;
+}
+
+bool isContextThread() {
+    return std::this_thread::get_id() == contextThread;
+}
+
+bool hasExtension(const char *extension) {
+    GLint numExtensions = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+    for (auto i = 0; i < numExtensions; ++i) {
+        const auto name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (std::strcmp(name, extension) == 0) return true;
+    }
+    return false;
+}
+
+void invalidate() {
+    state.program = UNKNOWN;
+    state.vertexArray = UNKNOWN;
+    state.buffers.fill(UNKNOWN);
+    std::fill(state.uniformBufferBindings.begin(), state.uniformBufferBindings.end(),
+              IndexedBinding{UNKNOWN, 0, -1});
+
+    state.activeTexture = UNKNOWN;
+    for (auto &textureUnit : state.textureUnits) {
+        textureUnit.fill(UNKNOWN);
+    }
+
+    state.drawFramebuffer = UNKNOWN;
+    state.readFramebuffer = UNKNOWN;
+    state.viewport.fill(-1);
+
+    state.capabilities.fill(UNKNOWN);
+    state.cullFace = UNKNOWN;
+    state.depthFunc = UNKNOWN;
+    state.depthMask = UNKNOWN;
+    state.blendFunc.fill(UNKNOWN);
+}
+
+void onFrameEnd() {
+    lastFrameStats = frameStats;
+    frameStats = Stats();
+}
+
+const Stats& getLastFrameStats() {
+    return lastFrameStats;
+}
+
+void useProgram(GLuint program) {
+    if (change(&state.program, program)) {
+        glUseProgram(program);
+    }
+}
+
+void bindVertexArray(GLuint vertexArray) {
+    if (change(&state.vertexArray, vertexArray)) {
+        glBindVertexArray(vertexArray);
+    }
+}
+
+void bindBuffer(GLenum target, GLuint buffer) {
+    const auto i = indexOf(BUFFER_TARGETS, target);
+    if (i < 0) {
+        ++frameStats.numIssued;
+        glBindBuffer(target, buffer);
+    } else if (change(&state.buffers[i], buffer)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+    // Binding an indexed target also binds its generic target
+    const auto i = indexOf(BUFFER_TARGETS, target);
+    if (target == GL_UNIFORM_BUFFER && index < state.uniformBufferBindings.size()) {
+        if (change(&state.uniformBufferBindings[index], IndexedBinding{buffer, 0, -1})) {
+            glBindBufferBase(target, index, buffer);
+            state.buffers[i] = buffer;
+        }
+        return;
+    }
+
+    ++frameStats.numIssued;
+    glBindBufferBase(target, index, buffer);
+    if (i >= 0) {
+        state.buffers[i] = buffer;
+    }
+}
+
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    const auto i = indexOf(BUFFER_TARGETS, target);
+    if (target == GL_UNIFORM_BUFFER && index < state.uniformBufferBindings.size()) {
+        if (change(&state.uniformBufferBindings[index], IndexedBinding{buffer, offset, size})) {
+            glBindBufferRange(target, index, buffer, offset, size);
+            state.buffers[i] = buffer;
+        }
+        return;
+    }
+
+    ++frameStats.numIssued;
+    glBindBufferRange(target, index, buffer, offset, size);
+    if (i >= 0) {
+        state.buffers[i] = buffer;
+    }
+}
+
+void activeTexture(GLenum textureUnit) {
+    if (change(&state.activeTexture, textureUnit)) {
+        glActiveTexture(textureUnit);
+    }
+}
+
+void bindTexture(GLenum target, GLuint texture) {
+    const auto i = indexOf(TEXTURE_TARGETS, target);
+    const auto unit = state.activeTexture - GL_TEXTURE0;
+    if (i < 0 || state.activeTexture == UNKNOWN || unit >= state.textureUnits.size()) {
+        ++frameStats.numIssued;
+        glBindTexture(target, texture);
+    } else if (change(&state.textureUnits[unit][i], texture)) {
+        glBindTexture(target, texture);
+    }
+}
+
+void bindFramebuffer(GLenum target, GLuint framebuffer) {
+    const auto bindDraw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    const auto bindRead = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((bindDraw && state.drawFramebuffer != framebuffer) ||
+            (bindRead && state.readFramebuffer != framebuffer)) {
+        ++frameStats.numIssued;
+        glBindFramebuffer(target, framebuffer);
+        if (bindDraw) state.drawFramebuffer = framebuffer;
+        if (bindRead) state.readFramebuffer = framebuffer;
+    } else {
+        ++frameStats.numFiltered;
+    }
+}
+
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (change(&state.viewport, {x, y, width, height})) {
+        glViewport(x, y, width, height);
+    }
+}
+
+void enable(GLenum capability) {
+    const auto i = indexOf(CAPABILITIES, capability);
+    if (i < 0) {
+        ++frameStats.numIssued;
+        glEnable(capability);
+    } else if (change(&state.capabilities[i], static_cast<GLuint>(GL_TRUE))) {
+        glEnable(capability);
+    }
+}
+
+void disable(GLenum capability) {
+    const auto i = indexOf(CAPABILITIES, capability);
+    if (i < 0) {
+        ++frameStats.numIssued;
+        glDisable(capability);
+    } else if (change(&state.capabilities[i], static_cast<GLuint>(GL_FALSE))) {
+        glDisable(capability);
+    }
+}
+
+void cullFace(GLenum mode) {
+    if (change(&state.cullFace, mode)) {
+        glCullFace(mode);
+    }
+}
+
+void depthFunc(GLenum func) {
+    if (change(&state.depthFunc, func)) {
+        glDepthFunc(func);
+    }
+}
+
+void depthMask(GLboolean flag) {
+    if (change(&state.depthMask, static_cast<GLuint>(flag))) {
+        glDepthMask(flag);
+    }
+}
+
+void blendFunc(GLenum sourceFactor, GLenum destinationFactor) {
+    if (change(&state.blendFunc, {sourceFactor, destinationFactor})) {
+        glBlendFunc(sourceFactor, destinationFactor);
+    }
+}
+
+void deleteProgram(GLuint program) {
+    if (contextLost) return;
+
+    // A program in use is only deleted once it is no longer in use
+    glDeleteProgram(program);
+}
+
+void deleteVertexArrays(GLsizei n, const GLuint *vertexArrays) {
+    if (contextLost) return;
+
+    glDeleteVertexArrays(n, vertexArrays);
+    if (std::find(vertexArrays, vertexArrays + n, state.vertexArray) != vertexArrays + n) {
+        state.vertexArray = 0u;
+    }
+}
+
+void deleteBuffers(GLsizei n, const GLuint *buffers) {
+    if (contextLost) return;
+
+    glDeleteBuffers(n, buffers);
+    std::for_each(buffers, buffers + n, [](auto buffer) {
+        forgetName(&state.buffers, buffer);
+        for (auto &binding : state.uniformBufferBindings) {
+            if (binding.buffer == buffer) binding = {0u, 0, -1};
+        }
+    });
+}
+
+void deleteTextures(GLsizei n, const GLuint *textures) {
+    if (contextLost) return;
+
+    glDeleteTextures(n, textures);
+    std::for_each(textures, textures + n, [](auto texture) {
+        for (auto &textureUnit : state.textureUnits) {
+            forgetName(&textureUnit, texture);
+        }
+    });
+}
+
+void deleteFramebuffers(GLsizei n, const GLuint *framebuffers) {
+    if (contextLost) return;
+
+    glDeleteFramebuffers(n, framebuffers);
+    std::for_each(framebuffers, framebuffers + n, [](auto framebuffer) {
+        if (state.drawFramebuffer == framebuffer) state.drawFramebuffer = 0u;
+        if (state.readFramebuffer == framebuffer) state.readFramebuffer = 0u;
+    });
+}
+
+void deleteShader(GLuint shader) {
+    if (contextLost) return;
+
+    glDeleteShader(shader);
+}
+
+void deleteSync(GLsync sync) {
+    if (contextLost) return;
+
+    glDeleteSync(sync);
+}
+
+} // namespace GLState
+} // namespace age
@@ -1,11 +1,106 @@
 #include <android_game_engine/Game.h>
 
+#include <algorithm>
+#include <iterator>
+
 #include <GLES3/gl32.h>
+#include <glm/geometric.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <android_game_engine/GameObject.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/Frustum.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/JobSystem.h>
 #include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/Profiler.h>
+
+namespace {
+
+// Number of published snapshots whose changes are logged for the triple buffer's snapshots
+constexpr unsigned long NUM_LOGGED_SNAPSHOTS = 8ul;
+
+template <typename T>
+void copyInto(std::unique_ptr<T> *dst, const T &src);
+float getScreenSize(const age::AABB &bounds, const age::Camera &cam);
+void writeGameObject(age::WorldSnapshot *snapshot, unsigned int index,
+                     age::GameObject *gameObject);
+void clearSnapshot(age::WorldSnapshot *snapshot);
+bool isSupersededTouchMove(const std::vector<age::InputEvent> &events, std::size_t index);
+
+template <typename T>
+void copyInto(std::unique_ptr<T> *dst, const T &src) {
+    if (*dst) {
+        **dst = src;
+    } else {
+        *dst = std::make_unique<T>(src);
+    }
+}
+
+///
+/// \brief getScreenSize Estimates the height on the screen of the sphere enclosing a box.
+///
+float getScreenSize(const age::AABB &bounds, const age::Camera &cam) {
+    const auto radius = glm::length(bounds.halfExtents);
+    const auto distance = std::max(glm::distance(bounds.center, cam.getPosition()) - radius,
+                                   cam.getNearPlane());
+    const auto viewportHeight = static_cast<float>(age::ManagerWindowing::getWindowHeight());
+    return radius / distance * cam.getProjectionMatrix()[1][1] * viewportHeight;
+}
+
+///
+/// \brief writeGameObject Copies the pose, render state and bounds of the game object at index of
+///                        the world list into a snapshot.
+///
+void writeGameObject(age::WorldSnapshot *snapshot, unsigned int index,
+                     age::GameObject *gameObject) {
+    if (index >= snapshot->gameObjects.size()) {
+        snapshot->gameObjects.resize(index + 1u);
+        snapshot->proxies.resize(index + 1u, age::AABBTree::NULL_PROXY);
+    }
+
+    auto &pose = snapshot->gameObjects[index];
+    const auto added = pose.gameObject == nullptr;
+    pose = {gameObject, gameObject->getPreviousModel(), gameObject->getModel(),
+            gameObject->captureRenderState()};
+
+    // Game objects whose dimensions are set after they were added are indexed from then on
+    auto &proxy = snapshot->proxies[index];
+    auto &unboundedGameObjects = snapshot->unboundedGameObjects;
+    if (proxy != age::AABBTree::NULL_PROXY) {
+        snapshot->spatialIndex.move(proxy, gameObject->getSweptBounds());
+    } else if (gameObject->hasBounds()) {
+        proxy = snapshot->spatialIndex.insert(gameObject->getSweptBounds(), gameObject);
+        if (!added) {
+            unboundedGameObjects.erase(std::remove(unboundedGameObjects.begin(),
+                                                   unboundedGameObjects.end(), gameObject),
+                                       unboundedGameObjects.end());
+        }
+    } else if (added) {
+        unboundedGameObjects.push_back(gameObject);
+    }
+}
+
+void clearSnapshot(age::WorldSnapshot *snapshot) {
+    snapshot->gameObjects.clear();
+    snapshot->spatialIndex.clear();
+    snapshot->proxies.clear();
+    snapshot->unboundedGameObjects.clear();
+}
+
+bool isSupersededTouchMove(const std::vector<age::InputEvent> &events, std::size_t index) {
+    if (events[index].type != age::InputEvent::Type::TOUCH_MOVE) return false;
+
+    for (auto i = index + 1u; i < events.size(); ++i) {
+        if (events[i].type != age::InputEvent::Type::JOYSTICK &&
+                events[i].source == events[index].source) {
+            return events[i].type == age::InputEvent::Type::TOUCH_MOVE;
+        }
+    }
+    return false;
+}
+
+} // namespace
 
 namespace age {
 
@@ -16,9 +111,12 @@ Game::Game() :
     physicsDebugShader("shaders/PhysicsDebug.vert", "shaders/PhysicsDebug.frag"),
     projectionViewUbo("ProjectionViewUB", sizeof(glm::mat4)),
     lightSpaceUbo("LightSpaceUB", sizeof(glm::mat4)),
+    objectUboRing("ObjectUB", sizeof(ObjectUniformBlock), RenderQueue::MAX_INSTANCES),
     skybox(nullptr), cam(nullptr), directionalLight(nullptr), shadowMap(nullptr),
     physics(new PhysicsEngine(&this->physicsDebugShader)),
-    drawDebugPhysics(false) {
+    drawDebugPhysics(false), parallelUpdate(false), frustumCulling(true),
+    snapshotsPublished(false), renderSnapshot(nullptr), nextSnapshotId(1ul),
+    changeLogStartId(0ul) {
 
     // Link shaders to necessary UBOs
     this->defaultShader.setUniformBlockBinding(this->projectionViewUbo);
@@ -27,13 +125,17 @@ Game::Game() :
     this->defaultShader.setUniformBlockBinding(this->lightSpaceUbo);
     this->shadowMapShader.setUniformBlockBinding(this->lightSpaceUbo);
 
-    // Shadow depth map texture
+    this->defaultShader.setUniformBlockBinding(this->objectUboRing);
+    this->shadowMapShader.setUniformBlockBinding(this->objectUboRing);
+
+    // Material textures and the shadow depth map are bound to fixed texture units
+    Mesh::setTextureUnits(&this->defaultShader);
     glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &this->shadowMapTextureUnit);
     this->shadowMapTextureUnit -= 1;
 
     // OpenGL settings
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    GLState::enable(GL_DEPTH_TEST);
+    GLState::enable(GL_CULL_FACE);
 }
 
 void Game::onCreate() {
@@ -67,19 +169,72 @@ void Game::onWindowChanged(int width, int height, int displayRotation) {
 
 void Game::onUpdate(std::chrono::duration<float> updateDuration) {
     this->cam->onUpdate(updateDuration);
-    
-    for (auto &gameObject : this->worldList) {
+
+    this->forEachInWorldList([updateDuration](GameObject *gameObject){
+        gameObject->storePreviousTransform();
         gameObject->onUpdate(updateDuration);
-    }
+    });
 
     this->physics->onUpdate(updateDuration);
-    for (auto &gameObject : this->worldList) {
-        gameObject->updateFromPhysics();
+    this->forEachInWorldList([](GameObject *gameObject){ gameObject->updateFromPhysics(); });
+}
+
+template <typename Function>
+void Game::forEachInWorldList(const Function &function) {
+    if (this->parallelUpdate) {
+        JobSystem::parallelFor(0u, this->worldList.size(),
+                               [this, &function](auto i){ function(this->worldList[i].get()); });
+    } else {
+        for (auto &gameObject : this->worldList) {
+            function(gameObject.get());
+        }
     }
 }
 
-void Game::render() {
+template <typename Function>
+void Game::forEachVisibleInSnapshot(const Frustum &frustum, CullingStats *stats,
+                                    const Function &function) {
+    const auto &snapshot = *this->renderSnapshot;
+    const auto numGameObjects = static_cast<unsigned int>(snapshot.gameObjects.size());
+
+    auto numVisible = 0u;
+    if (!this->frustumCulling) {
+        for (const auto &pose : snapshot.gameObjects) {
+            if (pose.renderState.visible) {
+                ++numVisible;
+                function(pose.gameObject);
+            }
+        }
+        *stats = {numVisible, numGameObjects - numVisible};
+        return;
+    }
+
+    // The spatial index bounds the game objects in all of their blended poses so the bounds of
+    // the rendered pose are tested again
+    snapshot.spatialIndex.query(frustum, [&frustum, &function, &numVisible](GameObject *gameObject) {
+        if (gameObject->getRenderState()->visible &&
+                frustum.intersects(gameObject->getRenderBounds())) {
+            ++numVisible;
+            function(gameObject);
+        }
+    });
+
+    for (auto gameObject : snapshot.unboundedGameObjects) {
+        if (gameObject->getRenderState()->visible) {
+            ++numVisible;
+            function(gameObject);
+        }
+    }
+
+    *stats = {numVisible, numGameObjects - numVisible};
+}
+
+void Game::render(float interpolation) {
+    PROFILE_ZONE("Game::render");
+
+    this->acquireSnapshot(interpolation);
     this->updateUBOs();
+    this->prepareRenderQueues();
 
     this->renderShadowMapSetup();
     this->renderShadowMap();
@@ -88,74 +243,244 @@ void Game::render() {
     this->renderWorld();
 }
 
+void Game::updateSnapshot() {
+    PROFILE_ZONE("Update snapshot");
+
+    this->snapshotsPublished = false;
+    this->simulationSnapshot.id = this->nextSnapshotId++;
+    this->worldListChanges.take([this](unsigned int index) {
+        writeGameObject(&this->simulationSnapshot, index, this->worldList[index].get());
+    });
+
+    copyInto(&this->simulationSnapshot.cam, *this->cam);
+    copyInto(&this->simulationSnapshot.directionalLight, *this->directionalLight);
+    this->drawPhysicsDebug(&this->simulationSnapshot);
+
+    // Snapshots of the triple buffer are rebuilt should the simulation be threaded again
+    this->changeLog.clear();
+    this->changeLogStartId = this->simulationSnapshot.id;
+}
+
+void Game::publishSnapshot() {
+    PROFILE_ZONE("Publish snapshot");
+
+    this->snapshotsPublished = true;
+    const auto id = this->nextSnapshotId++;
+    this->simulationSnapshot.id = id;
+    this->worldListChanges.take([this, id](unsigned int index) {
+        writeGameObject(&this->simulationSnapshot, index, this->worldList[index].get());
+        this->changeLog.emplace_back(id, index);
+    });
+
+    // Snapshots of the triple buffer are brought up to date with the game objects that changed
+    // since they were last written
+    auto snapshot = this->snapshots.getWriteBuffer();
+    if (snapshot->id < this->changeLogStartId) {
+        clearSnapshot(snapshot);
+        for (auto i = 0u; i < this->worldList.size(); ++i) {
+            writeGameObject(snapshot, i, this->worldList[i].get());
+        }
+    } else {
+        for (auto change = this->changeLog.rbegin();
+             change != this->changeLog.rend() && change->first > snapshot->id; ++change) {
+            writeGameObject(snapshot, change->second, this->worldList[change->second].get());
+        }
+    }
+    snapshot->id = id;
+
+    copyInto(&snapshot->cam, *this->cam);
+    copyInto(&snapshot->directionalLight, *this->directionalLight);
+    this->drawPhysicsDebug(snapshot);
+
+    this->snapshots.publish();
+
+    while (!this->changeLog.empty() && this->changeLog.front().first + NUM_LOGGED_SNAPSHOTS <= id) {
+        this->changeLogStartId = this->changeLog.front().first;
+        this->changeLog.pop_front();
+    }
+}
+
+void Game::drawPhysicsDebug(WorldSnapshot *snapshot) {
+    if (this->drawDebugPhysics) {
+        this->physics->drawDebug(&snapshot->physicsDebugLines);
+    } else {
+        snapshot->physicsDebugLines.clear();
+    }
+}
+
+void Game::acquireSnapshot(float interpolation) {
+    this->renderSnapshot = this->snapshotsPublished ? this->snapshots.getReadBuffer() :
+                                                      &this->simulationSnapshot;
+
+    for (auto &pose : this->renderSnapshot->gameObjects) {
+        pose.renderState.model = Model::interpolate(pose.previousModel, pose.model, interpolation);
+        pose.gameObject->setRenderState(&pose.renderState);
+    }
+
+    // Destroy removed game objects once no snapshot in use references them. This also
+    // guarantees that their GL resources are released on the rendering thread.
+    std::vector<std::shared_ptr<GameObject>> expiredGameObjects;
+    {
+        std::lock_guard<std::mutex> lock(this->removedGameObjectsMutex);
+        const auto id = this->renderSnapshot->id;
+        const auto expired = std::partition(this->removedGameObjects.begin(), this->removedGameObjects.end(),
+                                            [id](const auto &removed){ return removed.first > id; });
+        std::transform(expired, this->removedGameObjects.end(),
+                       std::back_inserter(expiredGameObjects),
+                       [](auto &removed){ return std::move(removed.second); });
+        this->removedGameObjects.erase(expired, this->removedGameObjects.end());
+    }
+}
+
+void Game::updateSnapshotView() {
+    copyInto(&this->renderSnapshot->cam, *this->cam);
+    copyInto(&this->renderSnapshot->directionalLight, *this->directionalLight);
+}
+
 void Game::updateUBOs() {
-    const auto projectionView = this->cam->getProjectionMatrix() * this->cam->getViewMatrix();
+    const auto &cam = *this->renderSnapshot->cam;
+    const auto projectionView = cam.getProjectionMatrix() * cam.getViewMatrix();
     this->projectionViewUbo.bufferSubData(0, sizeof(glm::mat4), glm::value_ptr(projectionView));
 
-    const auto lightSpace = this->directionalLight->getProjectionMatrix() *
-            this->directionalLight->getViewMatrix();
+    const auto &directionalLight = *this->renderSnapshot->directionalLight;
+    const auto lightSpace = directionalLight.getProjectionMatrix() *
+            directionalLight.getViewMatrix();
     this->lightSpaceUbo.bufferSubData(0, sizeof(glm::mat4), glm::value_ptr(lightSpace));
 }
 
+void Game::prepareRenderQueues() {
+    PROFILE_ZONE("Prepare render queues");
+
+    const auto &directionalLight = *this->renderSnapshot->directionalLight;
+    const Frustum lightFrustum(directionalLight.getProjectionMatrix() *
+                               directionalLight.getViewMatrix());
+
+    this->shadowPassQueue.begin(directionalLight.getPosition(), directionalLight.getFarPlane());
+    this->forEachVisibleInSnapshot(lightFrustum, &this->shadowPassCullingStats,
+                                   [this](GameObject *gameObject) {
+        gameObject->submitShadowItems(&this->shadowPassQueue, &this->shadowMapShader);
+    });
+
+    const auto &cam = *this->renderSnapshot->cam;
+    const Frustum frustum(cam.getProjectionMatrix() * cam.getViewMatrix());
+
+    this->worldPassQueue.begin(cam.getPosition(), cam.getFarPlane());
+    this->forEachVisibleInSnapshot(frustum, &this->worldPassCullingStats,
+                                   [this, &cam](GameObject *gameObject) {
+        gameObject->submitRenderItems(&this->worldPassQueue, &this->defaultShader);
+
+        // Game objects without bounds may cover the whole screen
+        gameObject->requestTextureSize(gameObject->hasRenderBounds() ?
+                getScreenSize(gameObject->getRenderBounds(), cam) :
+                static_cast<float>(ManagerWindowing::getWindowHeight()));
+    });
+    this->submitRenderItems(&this->worldPassQueue);
+
+    this->worldPassQueue.writeObjectUniforms({&this->shadowPassQueue, &this->worldPassQueue},
+                                             &this->objectUboRing);
+}
+
 void Game::renderShadowMapSetup() {
-    glViewport(0, 0, this->shadowMap->getWidth(), this->shadowMap->getHeight());
+    GLState::viewport(0, 0, this->shadowMap->getWidth(), this->shadowMap->getHeight());
     this->shadowMap->bindFramebuffer();
 
-    glCullFace(GL_FRONT);
+    GLState::cullFace(GL_FRONT);
     glClear(GL_DEPTH_BUFFER_BIT);
 }
 
 void Game::renderShadowMap() {
-    this->shadowMapShader.use();
-    for (auto &gameObject : this->worldList) {
-        gameObject->renderShadow(&this->shadowMapShader);
-    }
+    PROFILE_ZONE("Shadow pass");
+    PROFILE_GPU_ZONE("Shadow pass");
+
+    this->shadowPassQueue.render();
 }
 
 void Game::renderWorldSetup() {
-    glViewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::viewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    glCullFace(GL_BACK);
+    GLState::cullFace(GL_BACK);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
 void Game::renderWorld() {
-    this->defaultShader.use();
-    this->defaultShader.setUniform("viewPosition", this->cam->getPosition());
+    const auto &cam = *this->renderSnapshot->cam;
 
-    // Set shadow properties
-    this->bindShadowMap(&this->defaultShader);
-    this->directionalLight->render(&this->defaultShader);
+    {
+        PROFILE_ZONE("World pass");
+        PROFILE_GPU_ZONE("World pass");
 
-    for (auto &gameObject : this->worldList) {
-        gameObject->render(&this->defaultShader);
+        // Items of programs that are still being built were not queued
+        if (this->defaultShader.isReady()) {
+            this->defaultShader.use();
+            this->defaultShader.setUniform("viewPosition", cam.getPosition());
+
+            // Set shadow properties
+            this->bindShadowMap(&this->defaultShader);
+            this->renderSnapshot->directionalLight->render(&this->defaultShader);
+        }
+
+        this->worldPassQueue.render();
     }
 
-    // Render physics debugging attributes
-    if (this->drawDebugPhysics) {
+    // Render physics debugging attributes recorded by the simulation
+    const auto &physicsDebugLines = this->renderSnapshot->physicsDebugLines;
+    if (!physicsDebugLines.empty() && this->physicsDebugShader.isReady()) {
+        PROFILE_ZONE("Physics debug");
+        PROFILE_GPU_ZONE("Physics debug");
+
         this->physicsDebugShader.use();
-        this->physics->renderDebug();
+        this->physics->renderDebug(physicsDebugLines);
     }
 
     // Render skybox
-    if (this->skybox != nullptr) {
-        glDepthFunc(GL_LEQUAL);
-        auto view = this->cam->getViewMatrix();
+    if (this->skybox != nullptr && this->skyboxShader.isReady()) {
+        PROFILE_ZONE("Skybox");
+        PROFILE_GPU_ZONE("Skybox");
+
+        GLState::depthFunc(GL_LEQUAL);
+        auto view = cam.getViewMatrix();
         view[3] = glm::vec4(0.0f);
         this->skyboxShader.use();
-        this->skyboxShader.setUniform("projection_view", this->cam->getProjectionMatrix() * view);
+        this->skyboxShader.setUniform("projection_view", cam.getProjectionMatrix() * view);
         this->skybox->render(&this->defaultShader);
-        glDepthFunc(GL_LESS);
+        GLState::depthFunc(GL_LESS);
     }
 }
 
+void Game::submitRenderItems(RenderQueue *queue) {}
+
 void Game::bindShadowMap(age::ShaderProgram *shaderProgram) {
-    glActiveTexture(GL_TEXTURE0 + this->shadowMapTextureUnit);
+    GLState::activeTexture(GL_TEXTURE0 + this->shadowMapTextureUnit);
     this->shadowMap->bindDepthMap();
     shaderProgram->setUniform("shadowMap", this->shadowMapTextureUnit);
 }
 
+void Game::onInput(const std::vector<InputEvent> &events) {
+    for (auto i = 0u; i < events.size(); ++i) {
+        // Only the first pointer is forwarded and only its latest position before it is lifted
+        const auto &event = events[i];
+        if (event.source != 0 || isSupersededTouchMove(events, i)) continue;
+
+        switch (event.type) {
+            case InputEvent::Type::TOUCH_DOWN:
+                this->onTouchDownEvent(event.x, event.y);
+                break;
+
+            case InputEvent::Type::TOUCH_MOVE:
+                this->onTouchMoveEvent(event.x, event.y);
+                break;
+
+            case InputEvent::Type::TOUCH_UP:
+                this->onTouchUpEvent(event.x, event.y);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
 bool Game::onTouchDownEvent(float x, float y) {
     this->raycastTouch({x, y}, 1000.0f);
     return true;
@@ -166,6 +491,10 @@ bool Game::onTouchUpEvent(float x, float y) {return true;}
 
 void Game::enablePhysicsDebugDrawer(bool enable) {this->drawDebugPhysics = enable;}
 
+void Game::enableParallelUpdate(bool enable) {this->parallelUpdate = enable;}
+
+void Game::enableFrustumCulling(bool enable) {this->frustumCulling = enable;}
+
 void Game::setGravity(const glm::vec3 &gravity) {this->physics->setGravity(gravity);}
 
 void Game::setSkybox(std::unique_ptr<age::Skybox> skybox) {this->skybox = std::move(skybox);}
@@ -173,21 +502,40 @@ void Game::setSkybox(std::unique_ptr<age::Skybox> skybox) {this->skybox = std::m
 void Game::addToWorldList(std::shared_ptr<age::GameObject> gameObject) {
     this->registerPhysics(gameObject.get());
 
+    const auto index = static_cast<unsigned int>(this->worldList.size());
+    this->worldListChanges.resize(index + 1u);
+    this->worldListChanges.add(index);
+    gameObject->trackChanges(&this->worldListChanges, index);
     this->worldList.push_back(std::move(gameObject));
 }
 
 void Game::clearWorldList() {
+    std::lock_guard<std::mutex> lock(this->removedGameObjectsMutex);
     for (auto& gameObject : this->worldList) {
         this->unregisterPhysics(gameObject.get());
+        gameObject->trackChanges(nullptr, 0u);
+
+        // Already published snapshots may still reference the game object
+        this->removedGameObjects.emplace_back(this->nextSnapshotId, std::move(gameObject));
     }
 
     this->worldList.clear();
+    this->worldListChanges.clear();
+    clearSnapshot(&this->simulationSnapshot);
+
+    // Snapshots published before can't be brought up to date with the changes
+    this->changeLog.clear();
+    this->changeLogStartId = this->nextSnapshotId;
 }
 
 void Game::bindToProjectionViewUBO(age::ShaderProgram *shaderProgram) {
     shaderProgram->setUniformBlockBinding(this->projectionViewUbo);
 }
 
+void Game::bindToObjectUBO(age::ShaderProgram *shaderProgram) {
+    shaderProgram->setUniformBlockBinding(this->objectUboRing);
+}
+
 void Game::bindToLightSpaceUBO(age::ShaderProgram *shaderProgram) {
     shaderProgram->setUniformBlockBinding(this->lightSpaceUbo);
 }
@@ -199,7 +547,9 @@ void Game::registerPhysics(age::GameObject *gameObject) {
 }
 
 void Game::unregisterPhysics(age::GameObject *gameObject) {
-    this->physics->removeRigidBody(gameObject->getPhysicsBody());
+    if (gameObject->getPhysicsBody()) {
+        this->physics->removeRigidBody(gameObject->getPhysicsBody());
+    }
 }
 
 void Game::onGameObjectTouched(age::GameObject *gameObject, const glm::vec3 &touchPoint,
@@ -5,8 +5,10 @@
 #include <android_game_engine/ARPlane.h>
 #include <android_game_engine/Exception.h>
 #include <android_game_engine/GameEngine.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/LightDirectional.h>
 #include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/Profiler.h>
 
 namespace {
 const auto T_game_android = glm::rotate(glm::mat4(1.0f),
@@ -37,8 +39,8 @@ GameAR::GameAR() : Game(),
     this->bindToLightSpaceUBO(&this->arPlaneShadowedShader);
 
     // Enable blending for transparent plane indicators
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    GLState::enable(GL_BLEND);
+    GLState::blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
 GameAR::~GameAR() {
@@ -116,15 +118,14 @@ void GameAR::onWindowChanged(int width, int height, int displayRotation) {
     }
 }
 
-void GameAR::onUpdate(std::chrono::duration<float> updateDuration) {
-    Game::onUpdate(updateDuration);
-
-    if (this->arSession == nullptr) return;
-
+void GameAR::updateARFrame() {
     // Update AR session to get current frame
     ArSession_setCameraTextureName(this->arSession, this->arCameraBackground.getTexture());
     ArSession_update(this->arSession, this->arFrame);
 
+    // ARCore binds the camera texture when it updates it
+    GLState::invalidate();
+
     this->updateCamera();
 
     this->arCameraBackground.onUpdate(this->arSession, this->arFrame);
@@ -230,7 +231,7 @@ void GameAR::updatePlanes() {
             this->floor = std::make_shared<ARPlane>(Texture2D("images/trigrid.png"));
             this->registerPhysics(this->floor.get());
 
-            GameEngine::callJavaActivityVoidMethod("arPlaneInitialized", "()V");
+            GameEngine::postJavaActivityEvent(AR_PLANE_INITIALIZED_EVENT);
         }
 
         this->floor->setDimensions({floorLength, floorWidth});
@@ -271,44 +272,64 @@ void GameAR::updateDirectionalLight() {
     ArLightEstimate_destroy(lightEstimate);
 }
 
-void GameAR::render() {
+void GameAR::render(float interpolation) {
     if (this->arSession == nullptr) return;
 
+    this->acquireSnapshot(interpolation);
+
+    // The AR frame follows the camera feed rather than the simulation tick rate so it is
+    // acquired once per rendered frame
+    {
+        PROFILE_ZONE("AR update");
+        auto lock = GameEngine::lockSimulation();
+        this->updateARFrame();
+        this->updateSnapshotView();
+    }
+
     this->updateUBOs();
 
     // Render camera image in background
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    {
+        PROFILE_ZONE("AR background");
+        PROFILE_GPU_ZONE("AR background");
 
-    this->arCameraBackgroundShader.use();
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-    int64_t arFrameTimestamp;
-    ArFrame_getTimestamp(this->arSession, this->arFrame, &arFrameTimestamp);
+        if (this->arCameraBackgroundShader.isReady()) {
+            this->arCameraBackgroundShader.use();
 
-    this->arCameraBackground.render(&this->arCameraBackgroundShader, arFrameTimestamp);
+            int64_t arFrameTimestamp;
+            ArFrame_getTimestamp(this->arSession, this->arFrame, &arFrameTimestamp);
+
+            this->arCameraBackground.render(&this->arCameraBackgroundShader, arFrameTimestamp);
+        }
+    }
 
     // Don't render world scene if camera is not tracking
     if (this->arCameraTrackingState != AR_TRACKING_STATE_TRACKING) return;
 
     // Render world scene
+    this->prepareRenderQueues();
     this->renderShadowMapSetup();
     this->renderShadowMap();
 
-    glViewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
-    glCullFace(GL_BACK);
+    GLState::viewport(0, 0, ManagerWindowing::getWindowWidth(), ManagerWindowing::getWindowHeight());
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::cullFace(GL_BACK);
     this->renderWorld();
 
     // Render planes
-    if (this->floor != nullptr) {
+    if (this->floor != nullptr && this->arPlaneShader.isReady() &&
+            this->arPlaneShadowedShader.isReady()) {
         auto floorShader = (this->state == State::TRACK_PLANES) ?
                 &this->arPlaneShader : &this->arPlaneShadowedShader;
 
-        glDepthMask(GL_FALSE);
+        GLState::depthMask(GL_FALSE);
         floorShader->use();
         this->bindShadowMap(floorShader);
         this->floor->render(floorShader);
 
-        glDepthMask(GL_TRUE);
+        GLState::depthMask(GL_TRUE);
     }
 }
 
@@ -1,121 +1,165 @@
 #include <android_game_engine/GameEngine.h>
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <thread>
 #include <utility>
+#include <vector>
 
-#include <android_game_engine/Exception.h>
 #include <android_game_engine/Game.h>
-#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/InputEvent.h>
+#include <android_game_engine/JobSystem.h>
 #include <android_game_engine/ManagerWindowing.h>
+#include <android_game_engine/Profiler.h>
+#include <android_game_engine/ProgramBuilder.h>
+#include <android_game_engine/ResourceCache.h>
+#include <android_game_engine/RingBuffer.h>
+#include <android_game_engine/TextureLoader.h>
+#include <android_game_engine/TextureStreamer.h>
 
 namespace {
 
 std::unique_ptr<age::Game> game = nullptr;
 
-// JNI variables/methods
-constexpr auto JNI_VERSION = JNI_VERSION_1_6;
-JavaVM *javaVM = nullptr;
-jclass jActivityClassRef;
-jobject jActivityRef;
-jobject jContextRef;
-jobject jAssetManagerRef;
-
-void onCreateJNI(JNIEnv *env, jobject activity, jobject context, jobject assetManager);
-void onStartJNI(JNIEnv *env, jobject activity);
-void onResumeJNI(JNIEnv *env, jobject activity);
-void onPauseJNI(JNIEnv *env, jobject activity);
-void onStopJNI(JNIEnv *env, jobject activity);
-void onDestroyJNI(JNIEnv *env, jobject activity);
-void onSurfaceChangedJNI(JNIEnv *env, jobject activity, int width, int height, int displayRotation);
-void updateJNI(JNIEnv *env, jobject activity);
-void onTouchDownEventJNI(JNIEnv *env, jobject activity, float x, float y);
-void onTouchMoveEventJNI(JNIEnv *env, jobject activity, float x, float y);
-void onTouchUpEventJNI(JNIEnv *env, jobject activity, float x, float y);
-
-void onCreateJNI(JNIEnv *env, jobject activity, jobject context, jobject assetManager) {
-    jActivityRef = env->NewGlobalRef(activity);
-    jContextRef = env->NewGlobalRef(context);
-    jAssetManagerRef = env->NewGlobalRef(assetManager);
-    age::ManagerAssets::init(env, jAssetManagerRef);
-}
-
-void onStartJNI(JNIEnv *env, jobject activity) { if (game) game->onStart(); }
-void onResumeJNI(JNIEnv *env, jobject activity) { if (game) game->onResume(); }
-void onPauseJNI(JNIEnv *env, jobject activity) { game->onPause(); }
-
-void onStopJNI(JNIEnv *env, jobject activity) {
-    game->onStop();
-    age::ManagerWindowing::shutdown();
-}
+// Fixed timestep simulation
+using Clock = std::chrono::steady_clock;
+std::chrono::duration<float> tickDuration(1.0f / 60.0f);
+unsigned int maxTicksPerFrame = 5u;
+Clock::time_point lastUpdateTime;
+std::chrono::duration<float> accumulatedTime(0.0f);
+bool resetUpdateClock = true;
 
-void onDestroyJNI(JNIEnv *env, jobject activity) {
-    game->onDestroy();
-    game = nullptr;
+// Simulation thread
+bool simulationThreaded = false;
+std::thread simulationThread;
+std::atomic<bool> simulationRunning(false);
+std::mutex simulationMutex;
+std::atomic<Clock::rep> lastTickTime(0);
 
-    age::ManagerAssets::shutdown();
-    env->DeleteGlobalRef(jAssetManagerRef);
-    env->DeleteGlobalRef(jContextRef);
-    env->DeleteGlobalRef(jActivityRef);
-}
+// Input events are pushed by the UI thread as they arrive and drained by the renderer per frame
+age::RingBuffer<age::InputEvent, 1024> inputEvents;
+std::vector<age::InputEvent> inputEventBatch;
 
-void onSurfaceChangedJNI(JNIEnv *env, jobject activity,
-                         int width, int height, int displayRotation) {
-    age::ManagerWindowing::init(width, height, displayRotation);
-    game->onWindowChanged(width, height, displayRotation);
-}
+void drainInputEvents();
+void runFrame(std::chrono::duration<float> frameDuration);
 
-void updateJNI(JNIEnv *env, jobject activity) {
-    static std::chrono::system_clock::time_point lastUpdateTime = std::chrono::system_clock::now();
+void startSimulationThread();
+void stopSimulationThread();
+void runSimulation();
 
-    auto currentUpdateTime = std::chrono::system_clock::now();
-    auto updateDuration = currentUpdateTime - lastUpdateTime;
-    lastUpdateTime = currentUpdateTime;
+void drainInputEvents() {
+    inputEventBatch.clear();
 
-    game->onUpdate(updateDuration);
-    game->render();
+    age::InputEvent event;
+    while (inputEvents.pop(&event)) {
+        // Only the latest joystick position is of interest within a frame. Touch samples are all
+        // kept for gestures that need the path of a pointer.
+        if (event.type == age::InputEvent::Type::JOYSTICK && !inputEventBatch.empty() &&
+                inputEventBatch.back().type == event.type &&
+                inputEventBatch.back().source == event.source) {
+            inputEventBatch.back() = event;
+        } else {
+            inputEventBatch.push_back(event);
+        }
+    }
+
+    if (!inputEventBatch.empty()) {
+        auto lock = age::GameEngine::lockSimulation();
+        game->onInput(inputEventBatch);
+    }
 }
 
-void onTouchDownEventJNI(JNIEnv *env, jobject activity, float x, float y) {
-    game->onTouchDownEvent(x, y);
+void startSimulationThread() {
+    if (!simulationThreaded || !game || simulationRunning) return;
+
+    // Give the renderer a snapshot to start with
+    game->publishSnapshot();
+    lastTickTime = Clock::now().time_since_epoch().count();
+
+    simulationRunning = true;
+    simulationThread = std::thread(runSimulation);
 }
 
-void onTouchMoveEventJNI(JNIEnv *env, jobject activity, float x, float y) {
-    game->onTouchMoveEvent(x, y);
+void stopSimulationThread() {
+    if (!simulationRunning) return;
+
+    simulationRunning = false;
+    simulationThread.join();
 }
 
-void onTouchUpEventJNI(JNIEnv *env, jobject activity, float x, float y) {
-    game->onTouchUpEvent(x, y);
+void runSimulation() {
+    const auto tick = std::chrono::duration_cast<Clock::duration>(tickDuration);
+    auto nextTickTime = Clock::now() + tick;
+
+    while (simulationRunning) {
+        std::this_thread::sleep_until(nextTickTime);
+
+        {
+            PROFILE_ZONE("Simulation tick");
+            std::lock_guard<std::mutex> lock(simulationMutex);
+            game->onUpdate(tickDuration);
+            game->publishSnapshot();
+        }
+        lastTickTime = Clock::now().time_since_epoch().count();
+
+        // Drop the time that could not be caught up on to avoid a spiral of death
+        nextTickTime += tick;
+        const auto currentTime = Clock::now();
+        if (currentTime - nextTickTime > tick * maxTicksPerFrame) {
+            nextTickTime = currentTime;
+        }
+    }
 }
 
-} // namespace
+void runFrame(std::chrono::duration<float> frameDuration) {
+    drainInputEvents();
+
+    {
+        PROFILE_ZONE("Texture uploads");
+        age::TextureStreamer::update();
+        age::TextureLoader::update();
+    }
+    {
+        PROFILE_ZONE("Program builds");
+        age::ProgramBuilder::update();
+    }
+    age::ResourceCache::trim();
+
+    if (simulationRunning) {
+        const auto timeSinceTick = Clock::now() - Clock::time_point(Clock::duration(lastTickTime));
+        game->render(std::min(std::chrono::duration<float>(timeSinceTick) / tickDuration, 1.0f));
+        age::Profiler::onFrameEnd();
+        age::GLState::onFrameEnd();
+        return;
+    }
 
-// Register native methods
-jint JNI_OnLoad(JavaVM *vm, void *reserved) {
-    javaVM = vm;
-    auto env = age::GameEngine::getJNIEnv();
-
-    auto activityClass = env->FindClass(JNI_ENV_CLASS_PATH);
-    if (activityClass == nullptr) return JNI_ERR;
-    jActivityClassRef = reinterpret_cast<jclass>(env->NewGlobalRef(activityClass));
-
-    const std::vector<JNINativeMethod> methods = {
-        {"onCreateJNI", "(Landroid/content/Context;Landroid/content/res/AssetManager;)V",
-                                          reinterpret_cast<void *>(onCreateJNI)},
-        {"onStartJNI", "()V", reinterpret_cast<void *>(onStartJNI)},
-        {"onResumeJNI", "()V", reinterpret_cast<void *>(onResumeJNI)},
-        {"onPauseJNI", "()V", reinterpret_cast<void *>(onPauseJNI)},
-        {"onStopJNI", "()V", reinterpret_cast<void *>(onStopJNI)},
-        {"onDestroyJNI", "()V", reinterpret_cast<void *>(onDestroyJNI)},
-        {"onSurfaceChangedJNI", "(III)V", reinterpret_cast<void *>(onSurfaceChangedJNI)},
-        {"updateJNI", "()V", reinterpret_cast<void *>(updateJNI)},
-        {"onTouchDownEventJNI", "(FF)V", reinterpret_cast<void *>(onTouchDownEventJNI)},
-        {"onTouchMoveEventJNI", "(FF)V", reinterpret_cast<void *>(onTouchMoveEventJNI)},
-        {"onTouchUpEventJNI", "(FF)V", reinterpret_cast<void *>(onTouchUpEventJNI)}
-    };
-    auto result = env->RegisterNatives(jActivityClassRef, methods.data(), methods.size());
-    return result == JNI_OK ? JNI_VERSION : result;
+    accumulatedTime += frameDuration;
+
+    auto numTicks = 0u;
+    while (accumulatedTime >= tickDuration && numTicks < maxTicksPerFrame) {
+        PROFILE_ZONE("Simulation tick");
+        game->onUpdate(tickDuration);
+        accumulatedTime -= tickDuration;
+        ++numTicks;
+    }
+
+    // Drop the time that could not be caught up on to avoid a spiral of death
+    if (accumulatedTime >= tickDuration) {
+        accumulatedTime = std::chrono::duration<float>(std::fmod(accumulatedTime.count(),
+                                                                 tickDuration.count()));
+    }
+
+    game->updateSnapshot();
+    game->render(accumulatedTime / tickDuration);
+    age::Profiler::onFrameEnd();
+    age::GLState::onFrameEnd();
 }
 
+} // namespace
+
 namespace age {
 namespace GameEngine {
 
@@ -123,31 +167,106 @@ Game *getGame() {
     return game.get();
 }
 
+void onContextCreated() {
+    // Objects of a previous GL context are gone with it. They are released before the new game
+    // creates any objects, without deleting their names that the new context may reuse.
+    stopSimulationThread();
+    GLState::onContextLost();
+    game = nullptr;
+    TextureLoader::shutdown();
+    ResourceCache::clear();
+
+    // Bindings cached in a previous GL context are no longer valid
+    GLState::init();
+}
+
 void onSurfaceCreated(int width, int height, int displayRotation, std::unique_ptr<Game> &&g) {
     ManagerWindowing::init(width, height, displayRotation);
+    Profiler::init();
+    JobSystem::init();
     game = std::move(g);
+    resetUpdateClock = true;
 
     game->onCreate();
     game->onStart();
     game->onResume();
+    startSimulationThread();
+}
+
+void setTickRate(float ticksPerSecond) {
+    tickDuration = std::chrono::duration<float>(1.0f / ticksPerSecond);
+}
+
+void setMaxTicksPerFrame(unsigned int maxTicks) {
+    maxTicksPerFrame = maxTicks;
+}
+
+void setSimulationThreaded(bool threaded) {
+    simulationThreaded = threaded;
+}
+
+std::unique_lock<std::mutex> lockSimulation() {
+    return std::unique_lock<std::mutex>(simulationMutex);
+}
+
+bool areShadersReady() {
+    return ProgramBuilder::areAllReady();
+}
+
+void onStart() { if (game) game->onStart(); }
+
+void onResume() {
+    resetUpdateClock = true;
+    if (game) game->onResume();
+    startSimulationThread();
 }
 
-JNIEnv *getJNIEnv() {
-    JNIEnv *env;
-    if (javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION) != JNI_OK) {
-        throw age::JNIError("Failed to obtain JNIEnv from javaVM");
+void onPause() {
+    stopSimulationThread();
+    game->onPause();
+}
+
+void onStop() {
+    game->onStop();
+    ManagerWindowing::shutdown();
+}
+
+void onDestroy() {
+    stopSimulationThread();
+    game->onDestroy();
+    game = nullptr;
+    JobSystem::shutdown();
+    TextureLoader::shutdown();
+    ResourceCache::clear();
+}
+
+void onWindowChanged(int width, int height, int displayRotation) {
+    auto lock = lockSimulation();
+    ManagerWindowing::init(width, height, displayRotation);
+    game->onWindowChanged(width, height, displayRotation);
+}
+
+void update() {
+    const auto currentUpdateTime = Clock::now();
+    if (resetUpdateClock) {
+        lastUpdateTime = currentUpdateTime;
+        accumulatedTime = std::chrono::duration<float>::zero();
+        resetUpdateClock = false;
     }
-    return env;
+
+    const auto frameDuration = currentUpdateTime - lastUpdateTime;
+    lastUpdateTime = currentUpdateTime;
+    runFrame(frameDuration);
 }
 
-jobject getJavaActivity() { return jActivityRef; }
-jobject getJavaAppContext() { return jContextRef; }
+void update(std::chrono::duration<float> frameDuration) {
+    resetUpdateClock = true;
+    runFrame(frameDuration);
+}
 
-void callJavaActivityVoidMethod(const std::string &methodName, const std::string &signature) {
-    auto env = getJNIEnv();
-    auto method = env->GetMethodID(jActivityClassRef, methodName.c_str(), signature.c_str());
-    env->CallVoidMethod(jActivityRef, method);
+bool pushInputEvent(const InputEvent &event) {
+    return inputEvents.push(event);
 }
 
 } // namespace GameEngine
-} // namespace age
\ No newline at end of file
+} // namespace age
@@ -0,0 +1,249 @@
+#include <android_game_engine/GameEngine.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/InputEvent.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/ProgramBinaryCache.h>
+
+namespace {
+
+// JNI variables/methods
+constexpr auto JNI_VERSION = JNI_VERSION_1_6;
+JavaVM *javaVM = nullptr;
+jclass jActivityClassRef;
+jobject jActivityRef;
+jobject jContextRef;
+jobject jAssetManagerRef;
+
+// Events posted to the Java Activity are batched and delivered once per frame
+struct JavaEvent {
+    std::int32_t id;
+    float values[3];
+};
+static_assert(sizeof(JavaEvent) == 16, "JavaEvent layout is documented in GameEngine.h");
+
+constexpr auto MAX_JAVA_EVENTS_PER_FRAME = 256u;
+std::mutex javaEventsMutex;
+std::vector<JavaEvent> javaEvents;
+std::array<JavaEvent, MAX_JAVA_EVENTS_PER_FRAME> javaEventBuffer;
+jobject jJavaEventBufferRef = nullptr;
+const age::GameEngine::JavaActivityMethod onNativeEventsMethod("onNativeEvents",
+                                                               "(Ljava/nio/ByteBuffer;I)V");
+
+jobject jInputEventBufferRef = nullptr; ///< Replaced by every newly created Activity
+const age::InputEvent *inputEventBuffer = nullptr;
+
+// Native threads, e.g. the simulation thread, are attached to the VM on their first call to
+// getJNIEnv() and detached when they exit
+struct JavaThreadAttachment {
+    ~JavaThreadAttachment() {
+        if (this->attached) javaVM->DetachCurrentThread();
+    }
+
+    bool attached = false;
+};
+
+///
+/// \brief getJavaActivityMethods Returns the methods to resolve in JNI_OnLoad. The list is
+///                               constructed on first use since methods register themselves
+///                               during static initialization.
+///
+std::vector<age::GameEngine::JavaActivityMethod*>& getJavaActivityMethods();
+
+void flushJavaEvents();
+
+///
+/// \brief getCodeCacheDirectory Returns the app-private directory for cached compiled code,
+///                              which Android clears when the app is updated.
+///
+std::string getCodeCacheDirectory(JNIEnv *env, jobject context);
+
+void onCreateJNI(JNIEnv *env, jobject activity, jobject context, jobject assetManager);
+void onStartJNI(JNIEnv *env, jobject activity);
+void onResumeJNI(JNIEnv *env, jobject activity);
+void onPauseJNI(JNIEnv *env, jobject activity);
+void onStopJNI(JNIEnv *env, jobject activity);
+void onDestroyJNI(JNIEnv *env, jobject activity);
+void onSurfaceChangedJNI(JNIEnv *env, jobject activity, int width, int height, int displayRotation);
+void updateJNI(JNIEnv *env, jobject activity);
+void setInputEventBufferJNI(JNIEnv *env, jobject activity, jobject buffer);
+void onInputEventsJNI(JNIEnv *env, jobject activity, int numEvents);
+
+std::vector<age::GameEngine::JavaActivityMethod*>& getJavaActivityMethods() {
+    static std::vector<age::GameEngine::JavaActivityMethod*> methods;
+    return methods;
+}
+
+void flushJavaEvents() {
+    std::size_t numEvents;
+    {
+        std::lock_guard<std::mutex> lock(javaEventsMutex);
+        if (javaEvents.empty()) return;
+
+        numEvents = std::min<std::size_t>(javaEvents.size(), javaEventBuffer.size());
+        std::copy(javaEvents.cbegin(), javaEvents.cbegin() + numEvents, javaEventBuffer.begin());
+        javaEvents.clear();
+    }
+
+    age::GameEngine::callJavaActivityVoidMethod(onNativeEventsMethod, jJavaEventBufferRef,
+                                                static_cast<jint>(numEvents));
+}
+
+std::string getCodeCacheDirectory(JNIEnv *env, jobject context) {
+    auto getCodeCacheDir = env->GetMethodID(env->GetObjectClass(context), "getCodeCacheDir",
+                                            "()Ljava/io/File;");
+    auto directory = env->CallObjectMethod(context, getCodeCacheDir);
+    auto getAbsolutePath = env->GetMethodID(env->GetObjectClass(directory), "getAbsolutePath",
+                                            "()Ljava/lang/String;");
+    auto jPath = static_cast<jstring>(env->CallObjectMethod(directory, getAbsolutePath));
+
+    const auto chars = env->GetStringUTFChars(jPath, nullptr);
+    std::string path(chars);
+    env->ReleaseStringUTFChars(jPath, chars);
+    return path;
+}
+
+void onCreateJNI(JNIEnv *env, jobject activity, jobject context, jobject assetManager) {
+    jActivityRef = env->NewGlobalRef(activity);
+    jContextRef = env->NewGlobalRef(context);
+    jAssetManagerRef = env->NewGlobalRef(assetManager);
+    age::ManagerAssets::init(env, jAssetManagerRef);
+    age::ProgramBinaryCache::init(getCodeCacheDirectory(env, context));
+}
+
+void onStartJNI(JNIEnv *env, jobject activity) { age::GameEngine::onStart(); }
+void onResumeJNI(JNIEnv *env, jobject activity) { age::GameEngine::onResume(); }
+void onPauseJNI(JNIEnv *env, jobject activity) { age::GameEngine::onPause(); }
+void onStopJNI(JNIEnv *env, jobject activity) { age::GameEngine::onStop(); }
+
+void onDestroyJNI(JNIEnv *env, jobject activity) {
+    age::GameEngine::onDestroy();
+
+    age::ManagerAssets::shutdown();
+    env->DeleteGlobalRef(jAssetManagerRef);
+    env->DeleteGlobalRef(jContextRef);
+    env->DeleteGlobalRef(jActivityRef);
+}
+
+void onSurfaceChangedJNI(JNIEnv *env, jobject activity,
+                         int width, int height, int displayRotation) {
+    age::GameEngine::onWindowChanged(width, height, displayRotation);
+}
+
+void updateJNI(JNIEnv *env, jobject activity) {
+    age::GameEngine::update();
+    flushJavaEvents();
+}
+
+void setInputEventBufferJNI(JNIEnv *env, jobject activity, jobject buffer) {
+    if (jInputEventBufferRef) {
+        env->DeleteGlobalRef(jInputEventBufferRef);
+    }
+    jInputEventBufferRef = env->NewGlobalRef(buffer);
+    inputEventBuffer = static_cast<const age::InputEvent*>(env->GetDirectBufferAddress(jInputEventBufferRef));
+}
+
+void onInputEventsJNI(JNIEnv *env, jobject activity, int numEvents) {
+    // Called on the UI thread, which is the only producer of the input ring
+    for (auto i = 0; i < numEvents; ++i) {
+        if (!age::GameEngine::pushInputEvent(inputEventBuffer[i])) {
+            age::Log::warn("Input event ring buffer is full, dropping input events");
+            return;
+        }
+    }
+}
+
+} // namespace
+
+// Register native methods
+jint JNI_OnLoad(JavaVM *vm, void *reserved) {
+    javaVM = vm;
+    auto env = age::GameEngine::getJNIEnv();
+
+    auto activityClass = env->FindClass(JNI_ENV_CLASS_PATH);
+    if (activityClass == nullptr) return JNI_ERR;
+    jActivityClassRef = reinterpret_cast<jclass>(env->NewGlobalRef(activityClass));
+
+    for (auto method : getJavaActivityMethods()) {
+        method->resolve(env, jActivityClassRef);
+    }
+
+    // Batched events are only delivered if the Activity implements the receiving method
+    if (onNativeEventsMethod.getId() != nullptr) {
+        auto buffer = env->NewDirectByteBuffer(javaEventBuffer.data(),
+                                               sizeof(JavaEvent) * javaEventBuffer.size());
+        jJavaEventBufferRef = env->NewGlobalRef(buffer);
+    }
+
+    const std::vector<JNINativeMethod> methods = {
+        {"onCreateJNI", "(Landroid/content/Context;Landroid/content/res/AssetManager;)V",
+                                          reinterpret_cast<void *>(onCreateJNI)},
+        {"onStartJNI", "()V", reinterpret_cast<void *>(onStartJNI)},
+        {"onResumeJNI", "()V", reinterpret_cast<void *>(onResumeJNI)},
+        {"onPauseJNI", "()V", reinterpret_cast<void *>(onPauseJNI)},
+        {"onStopJNI", "()V", reinterpret_cast<void *>(onStopJNI)},
+        {"onDestroyJNI", "()V", reinterpret_cast<void *>(onDestroyJNI)},
+        {"onSurfaceChangedJNI", "(III)V", reinterpret_cast<void *>(onSurfaceChangedJNI)},
+        {"updateJNI", "()V", reinterpret_cast<void *>(updateJNI)},
+        {"setInputEventBufferJNI", "(Ljava/nio/ByteBuffer;)V", reinterpret_cast<void *>(setInputEventBufferJNI)},
+        {"onInputEventsJNI", "(I)V", reinterpret_cast<void *>(onInputEventsJNI)}
+    };
+    auto result = env->RegisterNatives(jActivityClassRef, methods.data(), methods.size());
+    return result == JNI_OK ? JNI_VERSION : result;
+}
+
+namespace age {
+namespace GameEngine {
+
+JNIEnv *getJNIEnv() {
+    // The JNIEnv is valid for as long as the thread is attached to the VM
+    thread_local JNIEnv *env = nullptr;
+    thread_local JavaThreadAttachment attachment;
+    if (env != nullptr) return env;
+
+    auto result = javaVM->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION);
+    if (result == JNI_EDETACHED) {
+        result = javaVM->AttachCurrentThread(&env, nullptr);
+        attachment.attached = result == JNI_OK;
+    }
+
+    if (result != JNI_OK) {
+        env = nullptr;
+        throw age::JNIError("Failed to obtain JNIEnv from javaVM");
+    }
+    return env;
+}
+
+jobject getJavaActivity() { return jActivityRef; }
+jobject getJavaAppContext() { return jContextRef; }
+
+JavaActivityMethod::JavaActivityMethod(const char *name, const char *signature) :
+    name(name), signature(signature), id(nullptr) {
+    getJavaActivityMethods().push_back(this);
+}
+
+void JavaActivityMethod::resolve(JNIEnv *env, jclass activityClass) {
+    this->id = env->GetMethodID(activityClass, this->name, this->signature);
+    if (this->id == nullptr) {
+        env->ExceptionClear();
+        Log::info(std::string("Java Activity does not implement ") + this->name + this->signature);
+    }
+}
+
+void postJavaActivityEvent(int id, float value0, float value1, float value2) {
+    if (onNativeEventsMethod.getId() == nullptr) return;
+
+    std::lock_guard<std::mutex> lock(javaEventsMutex);
+    if (javaEvents.size() < MAX_JAVA_EVENTS_PER_FRAME) {
+        javaEvents.push_back({id, {value0, value1, value2}});
+    }
+}
+
+} // namespace GameEngine
+} // namespace age
\ No newline at end of file
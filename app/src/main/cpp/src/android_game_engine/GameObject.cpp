@@ -2,38 +2,99 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <iterator>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <tuple>
+#include <utility>
 
 #include <BulletCollision/CollisionShapes/btBoxShape.h>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
 #include <glm/mat3x3.hpp>
 #include <glm/vec3.hpp>
 
 #include <android_game_engine/AssimpIOSystem.h>
 #include <android_game_engine/Exception.h>
-#include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/MeshOptimizer.h>
+#include <android_game_engine/RenderQueue.h>
+#include <android_game_engine/ResourceCache.h>
 #include <android_game_engine/Vertex.h>
 #include <android_game_engine/VertexArray.h>
 
 namespace {
 
-unsigned int getNumMeshes(const aiNode *node);
-age::Mesh processMesh(const aiMesh *mesh, const aiScene *scene, const std::string &dir);
+// Merged geometry of the meshes of a model that share their diffuse and specular textures
+struct MaterialGeometry {
+    std::vector<age::Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+using MaterialTextures = std::pair<std::vector<std::string>, std::vector<std::string>>;
+using ModelGeometry = std::map<MaterialTextures, MaterialGeometry>;
+
+// Meshes of a model file that game objects of the same model share through the ResourceCache
+struct CachedModel {
+    age::GameObject::Meshes meshes;
+    glm::vec3 halfExtents;
+};
+
+///
+/// \brief loadModel Imports the meshes of a model file and optimizes them.
+/// \exception age::LoadError Failed to load the model or its textures.
+///
+std::shared_ptr<CachedModel> loadModel(const std::string &modelFilepath);
+
+///
+/// \brief getSize Returns the GPU memory of the geometry of a model. Textures are cached on
+///                their own.
+///
+std::size_t getSize(const CachedModel &model);
+
+void processNode(const aiNode *node, const aiScene *scene, const std::string &dir,
+                 ModelGeometry *geometry);
+void processMesh(const aiMesh *mesh, const aiScene *scene, const std::string &dir,
+                 ModelGeometry *geometry);
 std::vector<std::string> loadMaterialTextures(const aiMaterial *material, aiTextureType type);
+age::AABB getBounds(const age::Model &model, const glm::vec3 &unscaledDimensions);
 
-unsigned int getNumMeshes(const aiNode *node) {
-    return node->mNumMeshes + std::accumulate(node->mChildren, node->mChildren + node->mNumChildren, 0u,
-                                              [](const auto sum, const auto child){ return sum + getNumMeshes(child); });
+void processNode(const aiNode *node, const aiScene *scene, const std::string &dir,
+                 ModelGeometry *geometry) {
+    std::for_each(node->mMeshes, node->mMeshes + node->mNumMeshes,
+                  [scene, &dir, geometry](const auto i){ processMesh(scene->mMeshes[i], scene, dir, geometry); });
+    std::for_each(node->mChildren, node->mChildren + node->mNumChildren,
+                  [scene, &dir, geometry](const auto child){ processNode(child, scene, dir, geometry); });
 }
 
-age::Mesh processMesh(const aiMesh *mesh, const aiScene *scene, const std::string &dir) {
+void processMesh(const aiMesh *mesh, const aiScene *scene, const std::string &dir,
+                 ModelGeometry *geometry) {
+    // Load textures
+    std::vector<std::string> diffuseTextures, specularTextures;
+    if (mesh->mMaterialIndex >= 0) {
+        const auto material = scene->mMaterials[mesh->mMaterialIndex];
+        diffuseTextures = loadMaterialTextures(material, aiTextureType_DIFFUSE);
+        specularTextures = loadMaterialTextures(material, aiTextureType_SPECULAR);
+
+        const auto prependDir = [&dir](const std::string &filename){ return dir + "/" + filename; };
+        std::transform(diffuseTextures.begin(), diffuseTextures.end(),
+                       diffuseTextures.begin(), prependDir);
+        std::transform(specularTextures.begin(), specularTextures.end(),
+                       specularTextures.begin(), prependDir);
+    }
+
+    // Meshes with the same textures are appended to the same geometry to be drawn together
+    auto &materialGeometry = (*geometry)[{diffuseTextures, specularTextures}];
+    auto &vertices = materialGeometry.vertices;
+    auto &indices = materialGeometry.indices;
+    const auto baseVertex = static_cast<unsigned int>(vertices.size());
+
     // Copy vertex data
-    std::vector<age::Vertex> vertices;
-    vertices.reserve(mesh->mNumVertices);
+    vertices.reserve(vertices.size() + mesh->mNumVertices);
     for (auto i = 0u; i < mesh->mNumVertices; ++i) {
         const auto &vertex = mesh->mVertices[i];
         const auto &normal = mesh->mNormals[i];
@@ -45,31 +106,15 @@ age::Mesh processMesh(const aiMesh *mesh, const aiScene *scene, const std::strin
     }
 
     // Copy index data
-    std::vector<unsigned int> indices;
     const auto numIndices = std::accumulate(mesh->mFaces, mesh->mFaces + mesh->mNumFaces, 0u,
                                             [](const auto sum, const auto &face){ return sum + face.mNumIndices; });
-    indices.reserve(numIndices);
+    indices.reserve(indices.size() + numIndices);
     std::for_each(mesh->mFaces, mesh->mFaces + mesh->mNumFaces,
-                  [&indices](const auto &face){ indices.insert(indices.cend(),
-                                                               face.mIndices,
-                                                               face.mIndices + face.mNumIndices); });
-
-    // Load textures
-    std::vector<std::string> diffuseTextures, specularTextures;
-    if (mesh->mMaterialIndex >= 0) {
-        const auto material = scene->mMaterials[mesh->mMaterialIndex];
-        diffuseTextures = loadMaterialTextures(material, aiTextureType_DIFFUSE);
-        specularTextures = loadMaterialTextures(material, aiTextureType_SPECULAR);
-
-        const auto prependDir = [&dir](const std::string &filename){ return dir + "/" + filename; };
-        std::transform(diffuseTextures.begin(), diffuseTextures.end(),
-                       diffuseTextures.begin(), prependDir);
-        std::transform(specularTextures.begin(), specularTextures.end(),
-                       specularTextures.begin(), prependDir);
-    }
-
-    return age::Mesh(std::make_shared<age::VertexArray>(vertices, indices),
-            diffuseTextures, specularTextures);
+                  [&indices, baseVertex](const auto &face){
+                      std::transform(face.mIndices, face.mIndices + face.mNumIndices,
+                                     std::back_inserter(indices),
+                                     [baseVertex](const auto i){ return baseVertex + i; });
+                  });
 }
 
 std::vector<std::string> loadMaterialTextures(const aiMaterial *material, aiTextureType type) {
@@ -113,42 +158,85 @@ glm::vec3 getHalfExtents(const aiNode *node, const aiScene *scene) {
     return getBound(bounds.cbegin(), bounds.cend());
 }
 
-} // namespace
-
-namespace age {
-
-GameObject::GameObject() : meshes(std::make_shared<Meshes>()) {}
-
-GameObject::GameObject(const std::string &modelFilepath) : meshes(std::make_shared<Meshes>()) {
+std::shared_ptr<CachedModel> loadModel(const std::string &modelFilepath) {
     Assimp::Importer importer;
-    importer.SetIOHandler(new AssimpIOSystem);
+    importer.SetIOHandler(new age::AssimpIOSystem);
 
     const auto scene = importer.ReadFile(modelFilepath, aiProcess_Triangulate);
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        throw LoadError("Failed to load model from: " + modelFilepath);
+        throw age::LoadError("Failed to load model from: " + modelFilepath);
     }
 
     // Load meshes
-    this->meshes->reserve(getNumMeshes(scene->mRootNode));
+    ModelGeometry geometry;
     const auto dir = modelFilepath.substr(0, modelFilepath.find_last_of("/\\"));
-    this->processNode(scene->mRootNode, scene, dir);
+    processNode(scene->mRootNode, scene, dir, &geometry);
+
+    std::shared_ptr<CachedModel> model(new CachedModel);
+    age::MeshOptimizer::Stats optimizationStats;
+    model->meshes.reserve(geometry.size());
+    for (auto &material : geometry) {
+        optimizationStats += age::MeshOptimizer::optimize(&material.second.vertices,
+                                                          &material.second.indices);
+        model->meshes.emplace_back(std::make_shared<age::VertexArray>(material.second.vertices,
+                                                                      material.second.indices,
+                                                                      age::VertexLayout::compact()),
+                                   material.first.first, material.first.second);
+    }
+
+    age::Log::info("Optimized meshes of " + modelFilepath + ": " +
+                   std::to_string(optimizationStats.numVerticesBefore) + " -> " +
+                   std::to_string(optimizationStats.numVerticesAfter) + " vertices, ACMR " +
+                   std::to_string(optimizationStats.getACMRBefore()) + " -> " +
+                   std::to_string(optimizationStats.getACMRAfter()));
+
+    model->halfExtents = getHalfExtents(scene->mRootNode, scene);
+    return model;
+}
+
+std::size_t getSize(const CachedModel &model) {
+    std::size_t size_bytes = 0u;
+    for (const auto &mesh : model.meshes) {
+        size_bytes += mesh.getVertexArray()->getSize();
+    }
+    return size_bytes;
+}
+
+age::AABB getBounds(const age::Model &model, const glm::vec3 &unscaledDimensions) {
+    // Meshes are centered on the game object's origin. The half extents of the rotated box
+    // along each world axis are the sums of its rotated local half extents.
+    const auto orientation = model.getOrientation();
+    const glm::mat3 absOrientation(glm::abs(orientation[0]),
+                                   glm::abs(orientation[1]),
+                                   glm::abs(orientation[2]));
+    return {model.getPosition(), absOrientation * (unscaledDimensions * model.getScale() * 0.5f)};
+}
+
+} // namespace
+
+namespace age {
+
+GameObject::GameObject() : meshes(std::make_shared<Meshes>()) {}
+
+GameObject::GameObject(const std::string &modelFilepath) {
+    const ResourceCache::Key key{modelFilepath, ResourceCache::hashAsset(modelFilepath)};
+
+    // Check cache to avoid reimporting
+    auto model = ResourceCache::find<CachedModel>(key);
+    if (!model) {
+        model = loadModel(modelFilepath);
+        ResourceCache::insert(key, model, getSize(*model));
+    }
+    this->meshes = std::shared_ptr<Meshes>(model, &model->meshes);
 
     // Create collision box
-    const auto halfExtents = getHalfExtents(scene->mRootNode, scene);
+    const auto &halfExtents = model->halfExtents;
     this->unscaledDimensions = halfExtents * 2.0f;
     this->setCollisionShape(std::make_unique<btBoxShape>(btVector3{halfExtents.x,
                                                                    halfExtents.y,
                                                                    halfExtents.z}));
 }
 
-void GameObject::processNode(const aiNode *node, const aiScene *scene, const std::string &dir) {
-    std::transform(node->mMeshes, node->mMeshes + node->mNumMeshes,
-                   std::back_inserter(*this->meshes),
-                   [scene, &dir](const auto i){ return processMesh(scene->mMeshes[i], scene, dir); });
-    std::for_each(node->mChildren, node->mChildren + node->mNumChildren,
-                  [this, scene, &dir](const auto child){ this->processNode(child, scene, dir); });
-}
-
 void GameObject::onUpdate(std::chrono::duration<float> updateDuration) {}
 
 void GameObject::updateFromPhysics() {
@@ -156,35 +244,93 @@ void GameObject::updateFromPhysics() {
         auto transform = this->physicsBody->getTransform();
         this->model.setOrientation(std::get<0>(transform));
         this->model.setPosition(std::get<1>(transform));
+        this->markMoved();
     }
 }
 
-void GameObject::renderShadow(ShaderProgram *shader) {
-    shader->setUniform("model", this->model.getModelMatrix());
+void GameObject::storePreviousTransform() {
+    this->previousModel = this->model;
+    this->hasPreviousModel = true;
 
-    std::for_each(this->meshes->begin(), this->meshes->end(),
-                  [shader](auto &mesh){ mesh.renderVAO(shader); });
+    // The previous pose only changes if the game object moved since it was last stored
+    if (this->moved) {
+        this->reportChange();
+        this->moved = false;
+    }
 }
 
-void GameObject::render(ShaderProgram *shader) {
-    shader->setUniform("model", this->model.getModelMatrix());
-    shader->setUniform("normal", this->model.getNormalMatrix());
+AABB GameObject::getWorldBounds() const {
+    return getBounds(this->model, this->unscaledDimensions);
+}
 
-    shader->setUniform("material.specularExponent", this->specularExponent);
+GameObject::RenderState GameObject::captureRenderState() const {
+    RenderState state;
+    state.model = this->model;
+    state.meshes = this->meshes;
+    state.unscaledDimensions = this->unscaledDimensions;
+    state.color = this->color;
+    state.specularExponent = this->specularExponent;
+    state.visible = this->visible;
+    return state;
+}
 
-    std::for_each(this->meshes->begin(), this->meshes->end(),
-                  [shader](auto &mesh){
-                      mesh.bindTextures(shader);
-                      mesh.renderVAO(shader);
-                  });
+AABB GameObject::getRenderBounds() const {
+    return getBounds(this->renderState->model, this->renderState->unscaledDimensions);
+}
+
+AABB GameObject::getSweptBounds() const {
+    // Bounding the sphere around the game object keeps the bounds valid for any orientation
+    // blended between the two poses
+    const auto getSphereBounds = [this](const Model &model) {
+        const auto radius = glm::length(this->unscaledDimensions * model.getScale()) * 0.5f;
+        return AABB{model.getPosition(), glm::vec3(radius)};
+    };
+
+    return AABB::merge(getSphereBounds(this->getPreviousModel()), getSphereBounds(this->model));
+}
+
+void GameObject::trackChanges(ChangeList *changes, unsigned int index) {
+    this->changes = changes;
+    this->changeIndex = index;
+}
+
+void GameObject::submitShadowItems(RenderQueue *queue, ShaderProgram *shader) {
+    for (auto &mesh : *this->renderState->meshes) {
+        RenderItem item;
+        item.shader = shader;
+        item.vertexArray = mesh.getVertexArray();
+        item.model = &this->renderState->model;
+        queue->submit(item);
+    }
+}
+
+void GameObject::submitRenderItems(RenderQueue *queue, ShaderProgram *shader) {
+    for (auto &mesh : *this->renderState->meshes) {
+        RenderItem item;
+        item.shader = shader;
+        item.vertexArray = mesh.getVertexArray();
+        item.material = &mesh;
+        item.color = this->renderState->color;
+        item.specularExponent = this->renderState->specularExponent;
+        item.model = &this->renderState->model;
+        queue->submit(item);
+    }
+}
+
+void GameObject::requestTextureSize(float screenSize_pixels) {
+    for (auto &mesh : *this->renderState->meshes) {
+        mesh.requestTextureSize(screenSize_pixels);
+    }
 }
 
 void GameObject::setMesh(std::shared_ptr<Meshes> mesh) {
     this->meshes = std::move(mesh);
+    this->reportChange();
 }
 
 void GameObject::setPosition(const glm::vec3 &position) {
     this->model.setPosition(position);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setPosition(position);
@@ -193,6 +339,7 @@ void GameObject::setPosition(const glm::vec3 &position) {
 
 void GameObject::setOrientation(const glm::mat3& orientation) {
     this->model.setOrientation(orientation);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(orientation);
@@ -203,6 +350,7 @@ void GameObject::setOrientation(const glm::vec3 &orientationX,
                                 const glm::vec3 &orientationY,
                                 const glm::vec3 &orientationZ) {
     this->model.setOrientation(orientationX, orientationY, orientationZ);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(this->model.getOrientation());
@@ -211,6 +359,7 @@ void GameObject::setOrientation(const glm::vec3 &orientationX,
 
 void GameObject::setLookAtPoint(const glm::vec3 &lookAtPoint) {
     this->model.setLookAtPoint(lookAtPoint);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(this->model.getOrientation());
@@ -219,6 +368,7 @@ void GameObject::setLookAtPoint(const glm::vec3 &lookAtPoint) {
 
 void GameObject::setLookAtDirection(const glm::vec3 &lookAtDirection) {
     this->model.setLookAtDirection(lookAtDirection);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(this->model.getOrientation());
@@ -227,6 +377,7 @@ void GameObject::setLookAtDirection(const glm::vec3 &lookAtDirection) {
 
 void GameObject::setNormalDirection(const glm::vec3 &normalDirection) {
     this->model.setNormalDirection(normalDirection);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(this->model.getOrientation());
@@ -235,6 +386,7 @@ void GameObject::setNormalDirection(const glm::vec3 &normalDirection) {
 
 void GameObject::rotate(float angle_rad, const glm::vec3 &axis) {
     this->model.rotate(angle_rad, axis);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setOrientation(this->model.getOrientation());
@@ -243,6 +395,7 @@ void GameObject::rotate(float angle_rad, const glm::vec3 &axis) {
 
 void GameObject::translate(const glm::vec3 &translation) {
     this->model.translate(translation);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setPosition(this->model.getPosition());
@@ -251,6 +404,7 @@ void GameObject::translate(const glm::vec3 &translation) {
 
 void GameObject::translateInLocalFrame(const glm::vec3 &translation) {
     this->model.translateInLocalFrame(translation);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setPosition(this->model.getPosition());
@@ -259,6 +413,7 @@ void GameObject::translateInLocalFrame(const glm::vec3 &translation) {
 
 void GameObject::setScale(const glm::vec3& scale) {
     this->model.setScale(scale);
+    this->markMoved();
     
     if (this->physicsBody) {
         this->physicsBody->setScale(scale);
@@ -275,6 +430,7 @@ void GameObject::setDamping(float linearDamping, float angularDamping) {
 
 void GameObject::setSpecularExponent(float specularExponent) {
     this->specularExponent = specularExponent;
+    this->reportChange();
 }
 
 PhysicsRigidBody* GameObject::getPhysicsBody() {
@@ -297,6 +453,7 @@ void GameObject::setCollisionShape(std::unique_ptr<btCollisionShape> collisionSh
 
 void GameObject::setUnscaledDimensions(const glm::vec3 &dimensions) {
     this->unscaledDimensions = dimensions;
+    this->reportChange();
 }
 
 } // namespace age
@@ -0,0 +1,280 @@
+#include <android_game_engine/GeometryArena.h>
+
+#include <algorithm>
+#include <iterator>
+
+#include <GLES3/gl32.h>
+
+#include <android_game_engine/GLState.h>
+
+namespace {
+
+constexpr std::size_t INITIAL_NUM_VERTICES = 16384u;
+constexpr std::size_t INITIAL_INDEX_CAPACITY_bytes = 256u * 1024u;
+
+// Index ranges may hold 16 or 32 bit indices and start at offsets that suit both
+constexpr std::size_t INDEX_ALIGNMENT_bytes = 4u;
+
+// Arenas of the layouts that currently have vertex arrays
+std::map<age::VertexLayout, std::weak_ptr<age::GeometryArena>> arenas;
+
+std::size_t alignUp(std::size_t value, std::size_t alignment);
+float getFragmentation(std::size_t capacity, std::size_t used, std::size_t largestFree);
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1u) / alignment * alignment;
+}
+
+float getFragmentation(std::size_t capacity, std::size_t used, std::size_t largestFree) {
+    const auto free = capacity - used;
+    return free == 0u ? 0.0f : 1.0f - static_cast<float>(largestFree) / static_cast<float>(free);
+}
+
+} // namespace
+
+namespace age {
+
+float GeometryArena::Stats::getVertexFragmentation() const {
+    return getFragmentation(this->vertexCapacity_bytes, this->vertexUsed_bytes,
+                            this->vertexLargestFree_bytes);
+}
+
+float GeometryArena::Stats::getIndexFragmentation() const {
+    return getFragmentation(this->indexCapacity_bytes, this->indexUsed_bytes,
+                            this->indexLargestFree_bytes);
+}
+
+std::shared_ptr<GeometryArena> GeometryArena::get(const VertexLayout &layout) {
+    auto &cachedArena = arenas[layout];
+    auto arena = cachedArena.lock();
+    if (!arena) {
+        arena = std::shared_ptr<GeometryArena>(new GeometryArena(layout));
+        cachedArena = arena;
+    }
+    return arena;
+}
+
+std::vector<std::shared_ptr<GeometryArena>> GeometryArena::getArenas() {
+    std::vector<std::shared_ptr<GeometryArena>> liveArenas;
+    for (const auto &arena : arenas) {
+        if (auto liveArena = arena.second.lock()) {
+            liveArenas.push_back(std::move(liveArena));
+        }
+    }
+    return liveArenas;
+}
+
+GeometryArena::GeometryArena(const VertexLayout &layout) :
+        layout(layout), vertexStride(layout.getStride()), vbo(0u), ebo(0u) {
+    glGenVertexArrays(1, &this->vao);
+    this->reallocate(INITIAL_NUM_VERTICES, INITIAL_INDEX_CAPACITY_bytes);
+}
+
+GeometryArena::~GeometryArena() {
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
+    GLState::deleteBuffers(1, &this->ebo);
+}
+
+GeometryArena::Allocation* GeometryArena::allocate(const void *vertexData, unsigned int numVertices,
+                                                   const void *indexData, std::size_t indexSize_bytes) {
+    const auto indexCapacity_bytes = alignUp(indexSize_bytes, INDEX_ALIGNMENT_bytes);
+
+    // Compacting the allocations is enough if the free memory is only fragmented. Otherwise the
+    // buffers grow.
+    if (this->vertexRanges.getLargestFree() < numVertices ||
+            this->indexRanges.getLargestFree() < indexCapacity_bytes) {
+        auto vertexCapacity = this->vertexRanges.getCapacity();
+        while (vertexCapacity - this->vertexRanges.getUsed() < numVertices) {
+            vertexCapacity *= 2u;
+        }
+
+        auto indexBufferCapacity_bytes = this->indexRanges.getCapacity();
+        while (indexBufferCapacity_bytes - this->indexRanges.getUsed() < indexCapacity_bytes) {
+            indexBufferCapacity_bytes *= 2u;
+        }
+
+        this->reallocate(vertexCapacity, indexBufferCapacity_bytes);
+    }
+
+    std::size_t baseVertex, indexOffset_bytes;
+    this->vertexRanges.allocate(numVertices, &baseVertex);
+    this->indexRanges.allocate(indexCapacity_bytes, &indexOffset_bytes);
+
+    // The copy targets leave the bindings of the vertex array object untouched
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, this->vbo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, baseVertex * this->vertexStride,
+                    numVertices * this->vertexStride, vertexData);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, this->ebo);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset_bytes, indexSize_bytes, indexData);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+
+    std::unique_ptr<Allocation> allocation(new Allocation);
+    allocation->baseVertex = static_cast<unsigned int>(baseVertex);
+    allocation->numVertices = numVertices;
+    allocation->indexOffset_bytes = indexOffset_bytes;
+    allocation->indexSize_bytes = indexCapacity_bytes;
+    allocation->slot = this->allocations.size();
+
+    this->allocations.push_back(std::move(allocation));
+    return this->allocations.back().get();
+}
+
+void GeometryArena::free(Allocation *allocation) {
+    this->vertexRanges.free(allocation->baseVertex, allocation->numVertices);
+    this->indexRanges.free(allocation->indexOffset_bytes, allocation->indexSize_bytes);
+
+    // Moves the last allocation into the slot of the freed one
+    const auto slot = allocation->slot;
+    std::swap(this->allocations[slot], this->allocations.back());
+    this->allocations[slot]->slot = slot;
+    this->allocations.pop_back();
+}
+
+void GeometryArena::defragment() {
+    this->reallocate(this->vertexRanges.getCapacity(), this->indexRanges.getCapacity());
+}
+
+void GeometryArena::bind() {
+    GLState::bindVertexArray(this->vao);
+    this->layout.setNormalEncoding();
+}
+
+GeometryArena::Stats GeometryArena::getStats() const {
+    Stats stats;
+    stats.numAllocations = static_cast<unsigned int>(this->allocations.size());
+
+    stats.vertexCapacity_bytes = this->vertexRanges.getCapacity() * this->vertexStride;
+    stats.vertexUsed_bytes = this->vertexRanges.getUsed() * this->vertexStride;
+    stats.vertexLargestFree_bytes = this->vertexRanges.getLargestFree() * this->vertexStride;
+    stats.numVertexFreeRanges = static_cast<unsigned int>(this->vertexRanges.getNumFreeRanges());
+
+    stats.indexCapacity_bytes = this->indexRanges.getCapacity();
+    stats.indexUsed_bytes = this->indexRanges.getUsed();
+    stats.indexLargestFree_bytes = this->indexRanges.getLargestFree();
+    stats.numIndexFreeRanges = static_cast<unsigned int>(this->indexRanges.getNumFreeRanges());
+
+    stats.numCompactions = this->numCompactions;
+    return stats;
+}
+
+void GeometryArena::reallocate(std::size_t vertexCapacity, std::size_t indexCapacity_bytes) {
+    GLuint buffers[2];
+    glGenBuffers(2, buffers);
+
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[0]);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * this->vertexStride, nullptr, GL_STATIC_DRAW);
+
+    // Packs the allocations at the start of the new buffers
+    std::size_t numVertices = 0u;
+    if (!this->allocations.empty()) {
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, this->vbo);
+        for (auto &allocation : this->allocations) {
+            if (allocation->numVertices > 0u) {
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                    allocation->baseVertex * this->vertexStride,
+                                    numVertices * this->vertexStride,
+                                    allocation->numVertices * this->vertexStride);
+            }
+            allocation->baseVertex = static_cast<unsigned int>(numVertices);
+            numVertices += allocation->numVertices;
+        }
+    }
+
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, buffers[1]);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity_bytes, nullptr, GL_STATIC_DRAW);
+
+    std::size_t indexSize_bytes = 0u;
+    if (!this->allocations.empty()) {
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, this->ebo);
+        for (auto &allocation : this->allocations) {
+            if (allocation->indexSize_bytes > 0u) {
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                    allocation->indexOffset_bytes, indexSize_bytes,
+                                    allocation->indexSize_bytes);
+            }
+            allocation->indexOffset_bytes = indexSize_bytes;
+            indexSize_bytes += allocation->indexSize_bytes;
+        }
+        ++this->numCompactions;
+    }
+
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, 0u);
+    GLState::bindBuffer(GL_COPY_WRITE_BUFFER, 0u);
+    GLState::deleteBuffers(1, &this->vbo);
+    GLState::deleteBuffers(1, &this->ebo);
+    this->vbo = buffers[0];
+    this->ebo = buffers[1];
+
+    this->vertexRanges.reset(vertexCapacity, numVertices);
+    this->indexRanges.reset(indexCapacity_bytes, indexSize_bytes);
+
+    // Point the vertex array object at the new buffers
+    GLState::bindVertexArray(this->vao);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    this->layout.setAttributePointers();
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0u);
+    GLState::bindVertexArray(0u);
+}
+
+void GeometryArena::FreeList::reset(std::size_t capacity, std::size_t used) {
+    this->freeRanges.clear();
+    this->capacity = capacity;
+    this->used = used;
+    if (used < capacity) {
+        this->freeRanges.emplace(used, capacity - used);
+    }
+}
+
+bool GeometryArena::FreeList::allocate(std::size_t size, std::size_t *offset) {
+    if (size == 0u) {
+        *offset = 0u;
+        return true;
+    }
+
+    const auto range = std::find_if(this->freeRanges.begin(), this->freeRanges.end(),
+                                    [size](const auto &range){ return range.second >= size; });
+    if (range == this->freeRanges.end()) return false;
+
+    *offset = range->first;
+    if (range->second > size) {
+        this->freeRanges.emplace_hint(std::next(range), range->first + size, range->second - size);
+    }
+    this->freeRanges.erase(range);
+    this->used += size;
+    return true;
+}
+
+void GeometryArena::FreeList::free(std::size_t offset, std::size_t size) {
+    if (size == 0u) return;
+    this->used -= size;
+
+    // Merges the range with the free ranges that it touches
+    auto next = this->freeRanges.lower_bound(offset);
+    if (next != this->freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = this->freeRanges.erase(next);
+    }
+
+    if (next != this->freeRanges.begin()) {
+        const auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+
+    this->freeRanges.emplace_hint(next, offset, size);
+}
+
+std::size_t GeometryArena::FreeList::getLargestFree() const {
+    std::size_t largestFree = 0u;
+    for (const auto &range : this->freeRanges) {
+        largestFree = std::max(largestFree, range.second);
+    }
+    return largestFree;
+}
+
+} // namespace age
@@ -0,0 +1,79 @@
+#include <android_game_engine/InstancedGameObject.h>
+
+#include <utility>
+
+#include <android_game_engine/RenderQueue.h>
+
+namespace age {
+
+InstancedGameObject::InstancedGameObject(std::shared_ptr<Meshes> meshes) : GameObject() {
+    this->setMesh(std::move(meshes));
+}
+
+std::size_t InstancedGameObject::addInstance(const Model &model, const glm::vec3 &color) {
+    std::lock_guard<std::mutex> lock(this->instancesMutex);
+    this->instances.push_back({model, color});
+    this->instancesChanged = true;
+    return this->instances.size() - 1u;
+}
+
+void InstancedGameObject::setInstance(std::size_t i, const Model &model, const glm::vec3 &color) {
+    std::lock_guard<std::mutex> lock(this->instancesMutex);
+    this->instances.at(i) = {model, color};
+    this->instancesChanged = true;
+}
+
+void InstancedGameObject::clearInstances() {
+    std::lock_guard<std::mutex> lock(this->instancesMutex);
+    this->instances.clear();
+    this->instancesChanged = true;
+}
+
+std::size_t InstancedGameObject::getNumInstances() const {
+    std::lock_guard<std::mutex> lock(this->instancesMutex);
+    return this->instances.size();
+}
+
+void InstancedGameObject::setRenderState(const RenderState *state) {
+    GameObject::setRenderState(state);
+
+    // The render queues reference the instances until the frame is rendered so they are only
+    // updated before any of them is submitted
+    std::lock_guard<std::mutex> lock(this->instancesMutex);
+    if (this->instancesChanged) {
+        this->renderInstances = this->instances;
+        this->instancesChanged = false;
+    }
+}
+
+void InstancedGameObject::submitShadowItems(RenderQueue *queue, ShaderProgram *shader) {
+    for (auto &mesh : *this->getRenderState()->meshes) {
+        RenderItem item;
+        item.shader = shader;
+        item.vertexArray = mesh.getVertexArray();
+
+        for (const auto &instance : this->renderInstances) {
+            item.model = &instance.model;
+            queue->submit(item);
+        }
+    }
+}
+
+void InstancedGameObject::submitRenderItems(RenderQueue *queue, ShaderProgram *shader) {
+    const auto &state = *this->getRenderState();
+    for (auto &mesh : *state.meshes) {
+        RenderItem item;
+        item.shader = shader;
+        item.vertexArray = mesh.getVertexArray();
+        item.material = &mesh;
+        item.specularExponent = state.specularExponent;
+
+        for (const auto &instance : this->renderInstances) {
+            item.color = instance.color * state.color;
+            item.model = &instance.model;
+            queue->submit(item);
+        }
+    }
+}
+
+} // namespace age
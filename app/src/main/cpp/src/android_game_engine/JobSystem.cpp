@@ -0,0 +1,241 @@
+#include <android_game_engine/JobSystem.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace age {
+
+void incrementJobCounter(JobCounter *counter);
+void decrementJobCounter(JobCounter *counter);
+bool addJobCounterDependent(JobCounter *counter, JobSystem::Job *job);
+
+} // namespace age
+
+namespace {
+
+struct QueuedJob {
+    age::JobSystem::Job job;
+    age::JobCounter *counter;
+};
+
+struct JobQueue {
+    std::mutex mutex;
+    std::deque<QueuedJob> jobs;
+};
+
+std::vector<std::unique_ptr<JobQueue>> queues;
+std::vector<std::thread> workers;
+std::atomic<bool> running(false);
+
+// Idle workers sleep until jobs are scheduled
+std::mutex wakeMutex;
+std::condition_variable wakeCondition;
+std::atomic<unsigned int> numQueuedJobs(0u);
+
+// Index of the calling thread's own queue. Non-worker threads share queue 0.
+thread_local unsigned int queueIndex = 0u;
+
+void push(QueuedJob job);
+bool tryPop(QueuedJob *job);
+bool tryExecuteJob();
+void execute(QueuedJob &job);
+void runWorker(unsigned int index);
+
+void push(QueuedJob job) {
+    auto &queue = *queues[queueIndex];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        ++numQueuedJobs;
+    }
+    wakeCondition.notify_one();
+}
+
+bool tryPop(QueuedJob *job) {
+    // Newest job of the own queue first as its data is most likely still in cache
+    {
+        auto &queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            *job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest job of another queue
+    for (auto i = 1u; i < queues.size(); ++i) {
+        auto &queue = *queues[(queueIndex + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            *job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool tryExecuteJob() {
+    QueuedJob job;
+    if (!tryPop(&job)) return false;
+
+    --numQueuedJobs;
+    execute(job);
+    return true;
+}
+
+void execute(QueuedJob &job) {
+    job.job();
+    if (job.counter) {
+        age::decrementJobCounter(job.counter);
+    }
+}
+
+void runWorker(unsigned int index) {
+    queueIndex = index;
+
+    while (running) {
+        if (tryExecuteJob()) continue;
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, []{ return numQueuedJobs > 0u || !running; });
+    }
+}
+
+} // namespace
+
+namespace age {
+
+void incrementJobCounter(JobCounter *counter) {
+    counter->count.fetch_add(1u, std::memory_order_relaxed);
+}
+
+void decrementJobCounter(JobCounter *counter) {
+    // The counter may be destroyed as soon as it is observed to be done so it is only released
+    // while holding its mutex, which JobCounter::isDone() synchronizes with.
+    std::vector<JobSystem::Job> dependents;
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        if (counter->count.fetch_sub(1u, std::memory_order_acq_rel) != 1u) return;
+        dependents.swap(counter->dependents);
+    }
+
+    // Schedule the jobs that were waiting on the counter
+    for (auto &dependent : dependents) {
+        dependent();
+    }
+}
+
+bool addJobCounterDependent(JobCounter *counter, JobSystem::Job *job) {
+    std::lock_guard<std::mutex> lock(counter->mutex);
+    if (counter->count.load(std::memory_order_acquire) == 0u) return false;
+
+    counter->dependents.push_back(std::move(*job));
+    return true;
+}
+
+bool JobCounter::isDone() const {
+    if (this->count.load(std::memory_order_acquire) != 0u) return false;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return true;
+}
+
+namespace JobSystem {
+
+void init(unsigned int numWorkerThreads) {
+    if (running) return;
+
+    queues.reserve(numWorkerThreads + 1u);
+    for (auto i = 0u; i <= numWorkerThreads; ++i) {
+        queues.push_back(std::make_unique<JobQueue>());
+    }
+
+    running = true;
+    workers.reserve(numWorkerThreads);
+    for (auto i = 1u; i <= numWorkerThreads; ++i) {
+        workers.emplace_back(runWorker, i);
+    }
+}
+
+void init() {
+    const auto numHardwareThreads = std::thread::hardware_concurrency();
+    init(numHardwareThreads > 1u ? numHardwareThreads - 1u : 0u);
+}
+
+void shutdown() {
+    if (!running) return;
+
+    // Finish the remaining jobs
+    while (tryExecuteJob()) {}
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        running = false;
+    }
+    wakeCondition.notify_all();
+
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    workers.clear();
+    queues.clear();
+}
+
+unsigned int getNumThreads() {
+    return running ? static_cast<unsigned int>(queues.size()) : 1u;
+}
+
+void run(Job job, JobCounter *counter) {
+    if (counter) {
+        incrementJobCounter(counter);
+    }
+
+    QueuedJob queuedJob {std::move(job), counter};
+    if (running) {
+        push(std::move(queuedJob));
+    } else {
+        execute(queuedJob);
+    }
+}
+
+void runAfter(JobCounter *dependency, Job job, JobCounter *counter) {
+    if (counter) {
+        incrementJobCounter(counter);
+    }
+
+    // The counter has already been incremented so the scheduled job must not increment it again
+    Job dependent = [job = std::move(job), counter]() mutable {
+        QueuedJob queuedJob {std::move(job), counter};
+        if (running) {
+            push(std::move(queuedJob));
+        } else {
+            execute(queuedJob);
+        }
+    };
+
+    if (!addJobCounterDependent(dependency, &dependent)) {
+        dependent();
+    }
+}
+
+void wait(JobCounter *counter) {
+    while (!counter->isDone()) {
+        if (!tryExecuteJob()) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+} // namespace JobSystem
+} // namespace age
@@ -0,0 +1,207 @@
+#include <android_game_engine/KTX2.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <GLES3/gl32.h>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/ManagerAssets.h>
+
+namespace {
+
+struct BlockFormat {
+    GLenum internalFormat;
+    unsigned int blockWidth;
+    unsigned int blockHeight;
+    unsigned int blockSize_bytes;
+};
+
+constexpr unsigned int NUM_ASTC_BLOCK_SIZES = 14u;
+
+// Block sizes of the ASTC formats in the order of the Vulkan and OpenGL format enums
+constexpr unsigned int ASTC_BLOCK_SIZES[NUM_ASTC_BLOCK_SIZES][2] {
+    {4u, 4u}, {5u, 4u}, {5u, 5u}, {6u, 5u}, {6u, 6u}, {8u, 5u}, {8u, 6u},
+    {8u, 8u}, {10u, 5u}, {10u, 6u}, {10u, 8u}, {10u, 10u}, {12u, 10u}, {12u, 12u}
+};
+
+// Returns false if the format is not a supported block compression
+bool getBlockFormat(std::uint32_t vkFormat, BlockFormat *format);
+
+template <typename T>
+T readLittleEndian(const unsigned char *data);
+
+bool getBlockFormat(std::uint32_t vkFormat, BlockFormat *format) {
+    using namespace age::KTX2;
+
+    switch (vkFormat) {
+        case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            *format = {GL_COMPRESSED_RGB8_ETC2, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            *format = {GL_COMPRESSED_SRGB8_ETC2, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            *format = {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            *format = {GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            *format = {GL_COMPRESSED_RGBA8_ETC2_EAC, 4u, 4u, 16u};
+            return true;
+
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            *format = {GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, 4u, 4u, 16u};
+            return true;
+
+        case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+            *format = {GL_COMPRESSED_R11_EAC, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+            *format = {GL_COMPRESSED_SIGNED_R11_EAC, 4u, 4u, 8u};
+            return true;
+
+        case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+            *format = {GL_COMPRESSED_RG11_EAC, 4u, 4u, 16u};
+            return true;
+
+        case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+            *format = {GL_COMPRESSED_SIGNED_RG11_EAC, 4u, 4u, 16u};
+            return true;
+
+        default:
+            break;
+    }
+
+    if (vkFormat >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && vkFormat <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+        const auto blockSize = (vkFormat - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2u;
+        const auto srgb = (vkFormat - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) % 2u == 1u;
+        *format = {(srgb ? GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4 : GL_COMPRESSED_RGBA_ASTC_4x4) + blockSize,
+                   ASTC_BLOCK_SIZES[blockSize][0], ASTC_BLOCK_SIZES[blockSize][1], 16u};
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+T readLittleEndian(const unsigned char *data) {
+    T value = 0u;
+    for (auto i = sizeof(T); i > 0u; --i) {
+        value = static_cast<T>(value << 8u) | data[i - 1u];
+    }
+    return value;
+}
+
+} // namespace
+
+namespace age {
+namespace KTX2 {
+
+const unsigned char IDENTIFIER[IDENTIFIER_SIZE] {
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+bool isKTX2File(const std::string &filepath) {
+    const std::string extension = ".ktx2";
+    return filepath.size() >= extension.size() &&
+           filepath.compare(filepath.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+Image load(const std::string &filepath) {
+    return parse(ManagerAssets::readAsset(filepath), filepath);
+}
+
+Image parse(std::vector<unsigned char> data, const std::string &filepath) {
+    if (data.size() < HEADER_SIZE_bytes ||
+            std::memcmp(data.data(), IDENTIFIER, IDENTIFIER_SIZE) != 0) {
+        throw LoadError("Not a KTX2 file: " + filepath);
+    }
+
+    const auto header = data.data() + IDENTIFIER_SIZE;
+    Image image;
+    image.vkFormat = readLittleEndian<std::uint32_t>(header);
+    image.width = static_cast<int>(readLittleEndian<std::uint32_t>(header + 8u));
+    image.height = static_cast<int>(readLittleEndian<std::uint32_t>(header + 12u));
+    const auto depth = readLittleEndian<std::uint32_t>(header + 16u);
+    const auto numLayers = readLittleEndian<std::uint32_t>(header + 20u);
+    image.numFaces = readLittleEndian<std::uint32_t>(header + 24u);
+    const auto numLevels = std::max(readLittleEndian<std::uint32_t>(header + 28u), 1u);
+    const auto supercompressionScheme = readLittleEndian<std::uint32_t>(header + 32u);
+
+    BlockFormat format;
+    if (!getBlockFormat(image.vkFormat, &format)) {
+        throw LoadError("Unsupported KTX2 format " + std::to_string(image.vkFormat) + ": " + filepath);
+    }
+    image.internalFormat = format.internalFormat;
+
+    if (supercompressionScheme != 0u) {
+        throw LoadError("Supercompressed KTX2 files are not supported: " + filepath);
+    }
+    if (image.width <= 0 || image.height <= 0 || depth > 0u || numLayers > 1u ||
+            (image.numFaces != 1u && image.numFaces != 6u)) {
+        throw LoadError("Only 2D textures and cubemaps are supported in KTX2 files: " + filepath);
+    }
+    if (image.numFaces == 6u && image.width != image.height) {
+        throw LoadError("Faces of KTX2 cubemaps must be square: " + filepath);
+    }
+
+    // A level after the 1x1 one would shift the dimensions by their full width
+    auto maxNumLevels = 1u;
+    while ((std::max(image.width, image.height) >> maxNumLevels) > 0) {
+        ++maxNumLevels;
+    }
+    if (numLevels > maxNumLevels) {
+        throw LoadError("KTX2 file has " + std::to_string(numLevels) + " mip levels, at most " +
+                        std::to_string(maxNumLevels) + " fit its size: " + filepath);
+    }
+    if (data.size() < HEADER_SIZE_bytes + numLevels * LEVEL_INDEX_ENTRY_SIZE_bytes) {
+        throw LoadError("Truncated KTX2 level index: " + filepath);
+    }
+
+    image.levels.resize(numLevels);
+    for (auto i = 0u; i < numLevels; ++i) {
+        const auto entry = data.data() + HEADER_SIZE_bytes + i * LEVEL_INDEX_ENTRY_SIZE_bytes;
+        const auto offset_bytes = readLittleEndian<std::uint64_t>(entry);
+        const auto size_bytes = readLittleEndian<std::uint64_t>(entry + 8u);
+
+        if (size_bytes != getFaceSize(image, i) * image.numFaces || offset_bytes > data.size() ||
+                size_bytes > data.size() - offset_bytes) {
+            throw LoadError("Invalid KTX2 mip level " + std::to_string(i) + ": " + filepath);
+        }
+        image.levels[i] = {static_cast<std::size_t>(offset_bytes), static_cast<std::size_t>(size_bytes)};
+    }
+
+    image.data = std::move(data);
+    return image;
+}
+
+std::size_t getFaceSize(const Image &image, unsigned int level) {
+    BlockFormat format;
+    getBlockFormat(image.vkFormat, &format);
+
+    const auto width = std::max(static_cast<unsigned int>(image.width) >> level, 1u);
+    const auto height = std::max(static_cast<unsigned int>(image.height) >> level, 1u);
+    return static_cast<std::size_t>((width + format.blockWidth - 1u) / format.blockWidth) *
+           ((height + format.blockHeight - 1u) / format.blockHeight) * format.blockSize_bytes;
+}
+
+void upload(const Image &image, unsigned int target, unsigned int face, unsigned int firstLevel) {
+    for (auto i = firstLevel; i < image.levels.size(); ++i) {
+        const auto faceSize_bytes = getFaceSize(image, i);
+        glCompressedTexImage2D(target, static_cast<GLint>(i - firstLevel), image.internalFormat,
+                               std::max(image.width >> i, 1), std::max(image.height >> i, 1), 0,
+                               static_cast<GLsizei>(faceSize_bytes),
+                               image.data.data() + image.levels[i].offset_bytes + face * faceSize_bytes);
+    }
+}
+
+} // namespace KTX2
+} // namespace age
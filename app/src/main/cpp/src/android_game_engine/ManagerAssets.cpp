@@ -28,5 +28,14 @@ Asset openAsset(const std::string &filepath) {
     return Asset(asset);
 }
 
+std::vector<unsigned char> readAsset(const std::string &filepath) {
+    auto asset = openAsset(filepath);
+    std::vector<unsigned char> contents(asset.getLength());
+    if (asset.read(contents.data(), contents.size()) != static_cast<int>(contents.size())) {
+        throw LoadError("Failed to read asset: " + filepath);
+    }
+    return contents;
+}
+
 } // namespace ManagerAssets
 } // namespace age
\ No newline at end of file
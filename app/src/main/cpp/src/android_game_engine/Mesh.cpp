@@ -1,13 +1,20 @@
 #include <android_game_engine/Mesh.h>
 
+#include <algorithm>
+
 #include <GLES3/gl32.h>
 #include <glm/vec3.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ShaderProgram.h>
 #include <android_game_engine/VertexArray.h>
 
 namespace age {
 
+constexpr int Mesh::MAX_TEXTURES;
+constexpr int Mesh::DIFFUSE_TEXTURE_UNIT;
+constexpr int Mesh::SPECULAR_TEXTURE_UNIT;
+
 Mesh::Mesh(std::shared_ptr<age::VertexArray> vao,
            const std::vector<std::string> &diffuseTextureFilepaths,
            const std::vector<std::string> &specularTextureFilepaths)
@@ -26,6 +33,7 @@ Mesh::Mesh(std::shared_ptr<VertexArray> vao,
 }
 
 void Mesh::init() {
+    // Meshes without textures share the interned white texture
     if (this->diffuseTextures.empty()) {
         this->diffuseTextures.emplace_back(glm::vec3(1.0f));
     }
@@ -35,26 +43,62 @@ void Mesh::init() {
     }
 }
 
-void Mesh::bindTextures(ShaderProgram *shader) {
-    int textureUnit = 0;
-    
-    for (size_t i = 0; i < this->diffuseTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
-        shader->setUniform("material.diffuseTexture" + std::to_string(i), textureUnit);
+void Mesh::setTextureUnits(ShaderProgram *shader) {
+    for (auto i = 0; i < MAX_TEXTURES; ++i) {
+        shader->setTextureUnit("material.diffuseTexture" + std::to_string(i),
+                               DIFFUSE_TEXTURE_UNIT + i);
+        shader->setTextureUnit("material.specularTexture" + std::to_string(i),
+                               SPECULAR_TEXTURE_UNIT + i);
+    }
+}
+
+void Mesh::bindTextures() {
+    const auto numDiffuseTextures = std::min<size_t>(this->diffuseTextures.size(), MAX_TEXTURES);
+    for (size_t i = 0; i < numDiffuseTextures; ++i) {
+        GLState::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(DIFFUSE_TEXTURE_UNIT + i));
         this->diffuseTextures[i].bind();
     }
-    
-    for (size_t i = 0; i < this->specularTextures.size(); ++i, ++textureUnit) {
-        glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(textureUnit));
-        shader->setUniform("material.specularTexture" + std::to_string(i), textureUnit);
+
+    const auto numSpecularTextures = std::min<size_t>(this->specularTextures.size(), MAX_TEXTURES);
+    for (size_t i = 0; i < numSpecularTextures; ++i) {
+        GLState::activeTexture(GL_TEXTURE0 + static_cast<GLenum>(SPECULAR_TEXTURE_UNIT + i));
         this->specularTextures[i].bind();
     }
-    
-    glActiveTexture(GL_TEXTURE0);
 }
 
 void Mesh::renderVAO(ShaderProgram *shader) {
     this->vao->render();
 }
 
+void Mesh::requestTextureSize(float screenSize_pixels) {
+    for (auto &texture : this->diffuseTextures) {
+        texture.requestSize(screenSize_pixels);
+    }
+    for (auto &texture : this->specularTextures) {
+        texture.requestSize(screenSize_pixels);
+    }
+}
+
+bool Mesh::hasSameTextures(const Mesh &mesh) const {
+    auto sameIds = [](const auto &textures1, const auto &textures2) {
+        return std::equal(textures1.cbegin(), textures1.cend(),
+                          textures2.cbegin(), textures2.cend(),
+                          [](const auto &t1, const auto &t2){ return t1.getId() == t2.getId(); });
+    };
+
+    return sameIds(this->diffuseTextures, mesh.diffuseTextures) &&
+           sameIds(this->specularTextures, mesh.specularTextures);
+}
+
+unsigned int Mesh::getTextureHash() const {
+    unsigned int hash = 17u;
+    for (const auto &texture : this->diffuseTextures) {
+        hash = hash * 31u + texture.getId();
+    }
+    for (const auto &texture : this->specularTextures) {
+        hash = hash * 31u + texture.getId();
+    }
+    return hash;
+}
+
 } // namespace ge
@@ -0,0 +1,355 @@
+#include <android_game_engine/MeshOptimizer.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#include <glm/geometric.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/Vertex.h>
+
+namespace {
+
+constexpr auto NO_VERTEX = std::numeric_limits<unsigned int>::max();
+
+static_assert(sizeof(age::Vertex) == 8u * sizeof(float),
+              "Vertices are compared and hashed by their bytes so they must not have padding");
+
+// Identifies vertices by their attributes
+struct VertexHash {
+    std::size_t operator()(const age::Vertex *vertex) const;
+};
+
+struct VertexEqual {
+    bool operator()(const age::Vertex *vertex1, const age::Vertex *vertex2) const;
+};
+
+// Triangles of a mesh that are drawn together when reordering it for overdraw
+struct Cluster {
+    std::size_t firstTriangle;
+    std::size_t endTriangle;
+
+    // Clusters that face further outward from the center of the mesh are drawn first
+    float outwardness;
+};
+
+std::vector<std::size_t> mergeClusters(const std::vector<unsigned int> &indices,
+                                       std::size_t numVertices,
+                                       const std::vector<std::size_t> &clusters, float maxACMR);
+
+std::size_t VertexHash::operator()(const age::Vertex *vertex) const {
+    // FNV-1a
+    std::uint32_t words[sizeof(age::Vertex) / sizeof(std::uint32_t)];
+    std::memcpy(words, vertex, sizeof(words));
+
+    std::size_t hash = 2166136261u;
+    for (auto word : words) {
+        hash = (hash ^ word) * 16777619u;
+    }
+    return hash;
+}
+
+bool VertexEqual::operator()(const age::Vertex *vertex1, const age::Vertex *vertex2) const {
+    return std::memcmp(vertex1, vertex2, sizeof(age::Vertex)) == 0;
+}
+
+std::vector<std::size_t> mergeClusters(const std::vector<unsigned int> &indices,
+                                       std::size_t numVertices,
+                                       const std::vector<std::size_t> &clusters, float maxACMR) {
+    // Simulates drawing every cluster from an empty FIFO cache
+    const auto cacheSize = age::MeshOptimizer::CACHE_SIZE;
+    std::vector<std::size_t> cacheTimes(numVertices, 0u);
+    std::size_t time = cacheSize;
+
+    std::vector<std::size_t> mergedClusters;
+    std::size_t firstTriangle = 0u;
+    std::size_t numCacheMisses = 0u;
+
+    auto cluster = clusters.cbegin();
+    const auto numTriangles = indices.size() / 3u;
+    for (std::size_t t = 0u; t < numTriangles; ++t) {
+        // A cluster only ends where it is not much worse than the mesh at reusing vertices
+        if (cluster != clusters.cend() && *cluster <= t) {
+            ++cluster;
+            if (t > firstTriangle &&
+                    static_cast<float>(numCacheMisses) <= maxACMR * static_cast<float>(t - firstTriangle)) {
+                mergedClusters.push_back(firstTriangle);
+                firstTriangle = t;
+                numCacheMisses = 0u;
+                time += cacheSize;
+            }
+        }
+
+        for (auto k = 0u; k < 3u; ++k) {
+            const auto v = indices[t * 3u + k];
+            if (time - cacheTimes[v] >= cacheSize) {
+                cacheTimes[v] = time++;
+                ++numCacheMisses;
+            }
+        }
+    }
+    mergedClusters.push_back(firstTriangle);
+
+    return mergedClusters;
+}
+
+} // namespace
+
+namespace age {
+namespace MeshOptimizer {
+
+Stats& Stats::operator+=(const Stats &stats) {
+    this->numTriangles += stats.numTriangles;
+    this->numVerticesBefore += stats.numVerticesBefore;
+    this->numVerticesAfter += stats.numVerticesAfter;
+    this->numCacheMissesBefore += stats.numCacheMissesBefore;
+    this->numCacheMissesAfter += stats.numCacheMissesAfter;
+    return *this;
+}
+
+float Stats::getACMRBefore() const {
+    return this->numTriangles == 0u ? 0.0f :
+           static_cast<float>(this->numCacheMissesBefore) / static_cast<float>(this->numTriangles);
+}
+
+float Stats::getACMRAfter() const {
+    return this->numTriangles == 0u ? 0.0f :
+           static_cast<float>(this->numCacheMissesAfter) / static_cast<float>(this->numTriangles);
+}
+
+Stats optimize(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices) {
+    Stats stats;
+    stats.numTriangles = indices->size() / 3u;
+    stats.numVerticesBefore = vertices->size();
+    stats.numCacheMissesBefore = countCacheMisses(*indices, vertices->size());
+
+    if (indices->size() % 3u == 0u) {
+        deduplicateVertices(vertices, indices);
+        const auto clusters = optimizeVertexCache(indices, vertices->size());
+        optimizeOverdraw(*vertices, indices, clusters);
+        optimizeVertexFetch(vertices, indices);
+    }
+
+    stats.numVerticesAfter = vertices->size();
+    stats.numCacheMissesAfter = countCacheMisses(*indices, vertices->size());
+    return stats;
+}
+
+void deduplicateVertices(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices) {
+    std::unordered_map<const Vertex*, unsigned int, VertexHash, VertexEqual> uniqueIndices;
+    uniqueIndices.reserve(vertices->size());
+
+    std::vector<Vertex> uniqueVertices;
+    std::vector<unsigned int> remap(vertices->size());
+    for (std::size_t i = 0u; i < vertices->size(); ++i) {
+        const auto &vertex = (*vertices)[i];
+        const auto unique = uniqueIndices.emplace(&vertex, static_cast<unsigned int>(uniqueVertices.size()));
+        if (unique.second) {
+            uniqueVertices.push_back(vertex);
+        }
+        remap[i] = unique.first->second;
+    }
+
+    for (auto &i : *indices) {
+        i = remap[i];
+    }
+    vertices->swap(uniqueVertices);
+}
+
+std::vector<std::size_t> optimizeVertexCache(std::vector<unsigned int> *indices,
+                                             std::size_t numVertices) {
+    const auto numTriangles = indices->size() / 3u;
+
+    // Triangles that use each vertex
+    std::vector<unsigned int> numLiveTriangles(numVertices, 0u);
+    for (auto i : *indices) {
+        ++numLiveTriangles[i];
+    }
+
+    std::vector<std::size_t> adjacencyOffsets(numVertices + 1u, 0u);
+    for (std::size_t v = 0u; v < numVertices; ++v) {
+        adjacencyOffsets[v + 1u] = adjacencyOffsets[v] + numLiveTriangles[v];
+    }
+
+    std::vector<unsigned int> adjacency(indices->size());
+    std::vector<std::size_t> adjacencyEnds(adjacencyOffsets.cbegin(), adjacencyOffsets.cend() - 1);
+    for (std::size_t t = 0u; t < numTriangles; ++t) {
+        for (auto k = 0u; k < 3u; ++k) {
+            adjacency[adjacencyEnds[(*indices)[t * 3u + k]]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    // Fans around vertices and continues with the oldest vertex of the fan that will still be
+    // in the cache after its own fan. Dead ends continue with recently used vertices.
+    std::vector<std::size_t> cacheTimes(numVertices, 0u);
+    std::size_t time = CACHE_SIZE + 1u;
+
+    std::vector<bool> emitted(numTriangles, false);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> optimizedIndices;
+    optimizedIndices.reserve(indices->size());
+
+    std::vector<std::size_t> clusters;
+    std::size_t cursor = 0u;
+    auto fanningVertex = numVertices == 0u ? NO_VERTEX : 0u;
+
+    while (fanningVertex != NO_VERTEX) {
+        candidates.clear();
+        for (auto a = adjacencyOffsets[fanningVertex]; a < adjacencyOffsets[fanningVertex + 1u]; ++a) {
+            const auto t = adjacency[a];
+            if (emitted[t]) continue;
+
+            for (auto k = 0u; k < 3u; ++k) {
+                const auto v = (*indices)[t * 3u + k];
+                optimizedIndices.push_back(v);
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                --numLiveTriangles[v];
+
+                if (time - cacheTimes[v] > CACHE_SIZE) {
+                    cacheTimes[v] = time++;
+                }
+            }
+            emitted[t] = true;
+        }
+
+        auto nextVertex = NO_VERTEX;
+        std::size_t maxPriority = 0u;
+        for (auto v : candidates) {
+            if (numLiveTriangles[v] == 0u) continue;
+
+            const auto age = time - cacheTimes[v];
+            const auto priority = age + 2u * numLiveTriangles[v] <= CACHE_SIZE ? age : 0u;
+            if (nextVertex == NO_VERTEX || priority > maxPriority) {
+                nextVertex = v;
+                maxPriority = priority;
+            }
+        }
+
+        if (nextVertex == NO_VERTEX) {
+            while (!deadEnds.empty() && nextVertex == NO_VERTEX) {
+                if (numLiveTriangles[deadEnds.back()] > 0u) {
+                    nextVertex = deadEnds.back();
+                }
+                deadEnds.pop_back();
+            }
+
+            for (; cursor < numVertices && nextVertex == NO_VERTEX; ++cursor) {
+                if (numLiveTriangles[cursor] > 0u) {
+                    nextVertex = static_cast<unsigned int>(cursor);
+                }
+            }
+
+            if (nextVertex != NO_VERTEX) {
+                clusters.push_back(optimizedIndices.size() / 3u);
+            }
+        }
+
+        fanningVertex = nextVertex;
+    }
+
+    indices->swap(optimizedIndices);
+    return clusters;
+}
+
+void optimizeOverdraw(const std::vector<Vertex> &vertices, std::vector<unsigned int> *indices,
+                      const std::vector<std::size_t> &clusters, float threshold) {
+    const auto numTriangles = indices->size() / 3u;
+    if (numTriangles == 0u) return;
+
+    const auto maxACMR = threshold * static_cast<float>(countCacheMisses(*indices, vertices.size())) /
+                         static_cast<float>(numTriangles);
+    const auto firstTriangles = mergeClusters(*indices, vertices.size(), clusters, maxACMR);
+    if (firstTriangles.size() < 2u) return;
+
+    // Centroids and normals of the triangles weighted by their area
+    std::vector<Cluster> sortedClusters;
+    sortedClusters.reserve(firstTriangles.size());
+    std::vector<glm::vec3> centroids, normals;
+    centroids.reserve(firstTriangles.size());
+    normals.reserve(firstTriangles.size());
+
+    glm::vec3 meshCentroid(0.0f);
+    auto meshArea = 0.0f;
+    for (std::size_t c = 0u; c < firstTriangles.size(); ++c) {
+        const auto endTriangle = c + 1u < firstTriangles.size() ? firstTriangles[c + 1u] : numTriangles;
+        sortedClusters.push_back({firstTriangles[c], endTriangle, 0.0f});
+
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        auto area = 0.0f;
+        for (auto t = firstTriangles[c]; t < endTriangle; ++t) {
+            const auto &p0 = vertices[(*indices)[t * 3u]].position;
+            const auto &p1 = vertices[(*indices)[t * 3u + 1u]].position;
+            const auto &p2 = vertices[(*indices)[t * 3u + 2u]].position;
+
+            const auto triangleNormal = glm::cross(p1 - p0, p2 - p0);
+            const auto triangleArea = glm::length(triangleNormal) * 0.5f;
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids.push_back(area > 0.0f ? centroid / area : centroid);
+        normals.push_back(normal);
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid /= meshArea;
+    }
+
+    for (std::size_t c = 0u; c < sortedClusters.size(); ++c) {
+        const auto normalLength = glm::length(normals[c]);
+        sortedClusters[c].outwardness = normalLength > 0.0f ?
+                glm::dot(centroids[c] - meshCentroid, normals[c] / normalLength) : 0.0f;
+    }
+
+    std::stable_sort(sortedClusters.begin(), sortedClusters.end(),
+                     [](const auto &c1, const auto &c2){ return c1.outwardness > c2.outwardness; });
+
+    std::vector<unsigned int> sortedIndices;
+    sortedIndices.reserve(indices->size());
+    for (const auto &cluster : sortedClusters) {
+        sortedIndices.insert(sortedIndices.end(),
+                             indices->cbegin() + cluster.firstTriangle * 3u,
+                             indices->cbegin() + cluster.endTriangle * 3u);
+    }
+    indices->swap(sortedIndices);
+}
+
+void optimizeVertexFetch(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices) {
+    std::vector<unsigned int> remap(vertices->size(), NO_VERTEX);
+    std::vector<Vertex> fetchedVertices;
+    fetchedVertices.reserve(vertices->size());
+
+    for (auto &i : *indices) {
+        if (remap[i] == NO_VERTEX) {
+            remap[i] = static_cast<unsigned int>(fetchedVertices.size());
+            fetchedVertices.push_back((*vertices)[i]);
+        }
+        i = remap[i];
+    }
+    vertices->swap(fetchedVertices);
+}
+
+std::size_t countCacheMisses(const std::vector<unsigned int> &indices, std::size_t numVertices,
+                             unsigned int cacheSize) {
+    std::vector<std::size_t> cacheTimes(numVertices, 0u);
+    std::size_t time = cacheSize;
+    std::size_t numCacheMisses = 0u;
+
+    for (auto i : indices) {
+        if (time - cacheTimes[i] >= cacheSize) {
+            cacheTimes[i] = time++;
+            ++numCacheMisses;
+        }
+    }
+    return numCacheMisses;
+}
+
+} // namespace MeshOptimizer
+} // namespace age
@@ -1,12 +1,24 @@
 #include <android_game_engine/Model.h>
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/mat4x4.hpp>
 
 #include <android_game_engine/ShaderProgram.h>
 
 namespace age {
 
+Model Model::interpolate(const Model &from, const Model &to, float interpolation) {
+    Model result;
+    result.scale = glm::mix(from.scale, to.scale, interpolation);
+    result.position = glm::mix(from.position, to.position, interpolation);
+    result.orientation = glm::mat3_cast(glm::slerp(glm::quat_cast(from.orientation),
+                                                   glm::quat_cast(to.orientation),
+                                                   interpolation));
+    result.normalMatrixIsValid = false;
+    return result;
+}
+
 glm::mat4 Model::getModelMatrix() const {
     glm::mat4 modelMatrix(this->orientation);
     
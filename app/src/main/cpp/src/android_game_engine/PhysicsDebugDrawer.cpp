@@ -1,8 +1,8 @@
 #include <android_game_engine/PhysicsDebugDrawer.h>
 
 #include <GLES3/gl32.h>
-#include <glm/vec3.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/Log.h>
 #include <android_game_engine/ShaderProgram.h>
 
@@ -12,33 +12,28 @@ PhysicsDebugDrawer::PhysicsDebugDrawer(age::ShaderProgram *shader) : shader(shad
     float positions[] = {0.0f, 0.0f, 0.0f,
                          1.0f, 1.0f, 1.0f};
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
     glBufferData(GL_ARRAY_BUFFER, sizeof(positions), positions, GL_STATIC_DRAW);
     glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), reinterpret_cast<GLvoid*>(0));
     glEnableVertexAttribArray(0u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 }
 
 PhysicsDebugDrawer::~PhysicsDebugDrawer() {
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
 }
 
 void PhysicsDebugDrawer::drawLine(const btVector3 &from, const btVector3 &to,
                                   const btVector3 &color) {
-    this->shader->setUniform("origin", glm::vec3 (from.x(), from.y(), from.z()));
-    this->shader->setUniform("basis", glm::vec3 (to.x() - from.x(),
-                                                 to.y() - from.y(),
-                                                 to.z() - from.z()));
-    this->shader->setUniform("color", glm::vec3(color.x(), color.y(), color.z()));
-
-    glBindVertexArray(this->vao);
-    glDrawArrays(GL_LINES, 0, 2);
+    this->lines.push_back({glm::vec3(from.x(), from.y(), from.z()),
+                           glm::vec3(to.x(), to.y(), to.z()),
+                           glm::vec3(color.x(), color.y(), color.z())});
 }
 
 void PhysicsDebugDrawer::drawContactPoint(const btVector3 &PointOnB, const btVector3 &normalOnB,
@@ -53,4 +48,20 @@ void PhysicsDebugDrawer::draw3dText(const btVector3 &location, const char *textS
 
 void PhysicsDebugDrawer::setDebugMode(int debugMode) {this->debugMode = debugMode;}
 
+void PhysicsDebugDrawer::takeLines(std::vector<Line> *lines) {
+    lines->swap(this->lines);
+    this->lines.clear();
+}
+
+void PhysicsDebugDrawer::render(const std::vector<Line> &lines) {
+    GLState::bindVertexArray(this->vao);
+
+    for (const auto &line : lines) {
+        this->shader->setUniform("origin", line.from);
+        this->shader->setUniform("basis", line.to - line.from);
+        this->shader->setUniform("color", line.color);
+        glDrawArrays(GL_LINES, 0, 2);
+    }
+}
+
 } // namespace age
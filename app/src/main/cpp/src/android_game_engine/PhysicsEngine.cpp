@@ -6,6 +6,7 @@
 
 #include <android_game_engine/PhysicsDebugDrawer.h>
 #include <android_game_engine/PhysicsRigidBody.h>
+#include <android_game_engine/Profiler.h>
 
 namespace age {
 
@@ -27,7 +28,10 @@ PhysicsEngine::PhysicsEngine(ShaderProgram *debugShader)
 PhysicsEngine::~PhysicsEngine() = default;
 
 void PhysicsEngine::onUpdate(std::chrono::duration<float> updateDuration) {
-    this->dynamicsWorld->stepSimulation(updateDuration.count(), 10);
+    PROFILE_ZONE("Physics step");
+
+    // The engine already runs at a fixed tick rate so take a single substep of the tick length
+    this->dynamicsWorld->stepSimulation(updateDuration.count(), 1, updateDuration.count());
 }
 
 void PhysicsEngine::setGravity(const glm::vec3 &gravity) {
@@ -58,8 +62,13 @@ RaycastResult PhysicsEngine::raycastClosest(const glm::vec3 &from, const glm::ve
     }
 }
 
-void PhysicsEngine::renderDebug() {
+void PhysicsEngine::drawDebug(std::vector<PhysicsDebugDrawer::Line> *lines) {
     this->dynamicsWorld->debugDrawWorld();
+    this->debugDrawer->takeLines(lines);
+}
+
+void PhysicsEngine::renderDebug(const std::vector<PhysicsDebugDrawer::Line> &lines) {
+    this->debugDrawer->render(lines);
 }
 
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include <android_game_engine/Profiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <EGL/egl.h>
+#include <GLES2/gl2ext.h>
+
+#include <android_game_engine/GLState.h>
+
+#ifdef __ANDROID__
+#include <android/trace.h>
+#endif
+
+namespace {
+
+struct ProfileEvent {
+    const char *name;
+    std::int64_t start_ns;
+    std::int64_t duration_ns;
+    std::uint32_t threadId;
+};
+
+// A slot of the ring buffer. The sequence is odd while the event is being written and 2 * (n + 1)
+// once the n-th recorded event is complete, so that the exporter can skip slots that are written
+// concurrently instead of reading torn events.
+struct EventSlot {
+    std::atomic<std::uint64_t> sequence;
+    std::atomic<const char*> name;
+    std::atomic<std::int64_t> start_ns;
+    std::atomic<std::int64_t> duration_ns;
+    std::atomic<std::uint32_t> threadId;
+};
+
+constexpr auto MAX_EVENTS = 1u << 16u;
+constexpr std::uint32_t GPU_THREAD_ID = 0u;
+
+// CPU zones may be recorded from any thread
+std::atomic<bool> enabled(false);
+std::unique_ptr<EventSlot[]> events;
+std::atomic<std::uint64_t> numEventsRecorded(0u);
+
+std::atomic<std::uint32_t> nextThreadId(GPU_THREAD_ID + 1u);
+thread_local std::uint32_t threadId = 0u;
+
+// GPU zones are only recorded on the rendering thread. They are timed with timestamp queries at
+// their beginning and end.
+struct PendingGpuZone {
+    GLuint beginQuery;
+    GLuint endQuery;
+    const char *name;
+};
+
+bool gpuTimingSupported = false;
+PFNGLQUERYCOUNTEREXTPROC glQueryCounterEXT = nullptr;
+PFNGLGETQUERYOBJECTUI64VEXTPROC glGetQueryObjectui64vEXT = nullptr;
+std::vector<GLuint> freeQueries;
+std::deque<PendingGpuZone> pendingGpuZones;
+
+void recordEvent(const char *name, std::int64_t start_ns, std::int64_t duration_ns,
+                 std::uint32_t tid);
+std::vector<ProfileEvent> copyEvents();
+std::uint32_t getThreadId();
+GLuint allocateQuery();
+
+void recordEvent(const char *name, std::int64_t start_ns, std::int64_t duration_ns,
+                 std::uint32_t tid) {
+    const auto n = numEventsRecorded.fetch_add(1u, std::memory_order_relaxed);
+    auto &slot = events[n % MAX_EVENTS];
+
+    slot.sequence.store(2u * n + 1u, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(duration_ns, std::memory_order_relaxed);
+    slot.threadId.store(tid, std::memory_order_relaxed);
+    slot.sequence.store(2u * n + 2u, std::memory_order_release);
+}
+
+std::vector<ProfileEvent> copyEvents() {
+    std::vector<ProfileEvent> copy;
+    if (!events) return copy;
+
+    const auto numRecorded = numEventsRecorded.load();
+    const auto numEvents = std::min<std::uint64_t>(numRecorded, MAX_EVENTS);
+    copy.reserve(numEvents);
+
+    // Oldest event first. Events that are overwritten while they are copied are skipped.
+    for (auto n = numRecorded - numEvents; n < numRecorded; ++n) {
+        const auto &slot = events[n % MAX_EVENTS];
+        const auto sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2u * n + 2u) continue;
+
+        const ProfileEvent event = {slot.name.load(std::memory_order_relaxed),
+                                    slot.start_ns.load(std::memory_order_relaxed),
+                                    slot.duration_ns.load(std::memory_order_relaxed),
+                                    slot.threadId.load(std::memory_order_relaxed)};
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+            copy.push_back(event);
+        }
+    }
+    return copy;
+}
+
+std::uint32_t getThreadId() {
+    if (threadId == 0u) {
+        threadId = nextThreadId.fetch_add(1u, std::memory_order_relaxed);
+    }
+    return threadId;
+}
+
+GLuint allocateQuery() {
+    GLuint query;
+    if (freeQueries.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = freeQueries.back();
+        freeQueries.pop_back();
+    }
+    return query;
+}
+
+} // namespace
+
+namespace age {
+namespace Profiler {
+
+void init() {
+    // Query objects of a previous context are gone
+    freeQueries.clear();
+    pendingGpuZones.clear();
+
+    glQueryCounterEXT = reinterpret_cast<PFNGLQUERYCOUNTEREXTPROC>(
+            eglGetProcAddress("glQueryCounterEXT"));
+    glGetQueryObjectui64vEXT = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(
+            eglGetProcAddress("glGetQueryObjectui64vEXT"));
+    gpuTimingSupported = GLState::hasExtension("GL_EXT_disjoint_timer_query") &&
+            glQueryCounterEXT != nullptr && glGetQueryObjectui64vEXT != nullptr;
+
+    // Some implementations only support elapsed time queries
+    if (gpuTimingSupported) {
+        GLint timestampBits = 0;
+        glGetQueryiv(GL_TIMESTAMP_EXT, GL_QUERY_COUNTER_BITS_EXT, &timestampBits);
+        gpuTimingSupported = timestampBits > 0;
+    }
+}
+
+void setEnabled(bool enable) {
+    // The buffer is allocated before any thread can record into it and is never freed
+    if (enable && !events) {
+        events.reset(new EventSlot[MAX_EVENTS]);
+        for (auto i = 0u; i < MAX_EVENTS; ++i) {
+            events[i].sequence.store(0u, std::memory_order_relaxed);
+        }
+    }
+    enabled = enable;
+}
+
+bool isEnabled() {
+    return enabled;
+}
+
+bool isGpuTimingSupported() {
+    return gpuTimingSupported;
+}
+
+void onFrameEnd() {
+    if (pendingGpuZones.empty()) return;
+
+    // Timer results are meaningless if the GPU was e.g. switched to a different frequency
+    GLint disjoint = GL_FALSE;
+    glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+
+    // GPU timestamps are moved onto the CPU clock to line them up with the CPU zones
+    GLint64 gpuNow_ns = 0;
+    glGetInteger64v(GL_TIMESTAMP_EXT, &gpuNow_ns);
+    const auto gpuToCpuOffset_ns = now_ns() - static_cast<std::int64_t>(gpuNow_ns);
+
+    while (!pendingGpuZones.empty()) {
+        const auto &zone = pendingGpuZones.front();
+
+        // Queries finish in order, so the zone's begin is available once its end is
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(zone.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+
+        GLuint64 begin_ns = 0u;
+        GLuint64 end_ns = 0u;
+        glGetQueryObjectui64vEXT(zone.beginQuery, GL_QUERY_RESULT, &begin_ns);
+        glGetQueryObjectui64vEXT(zone.endQuery, GL_QUERY_RESULT, &end_ns);
+        if (!disjoint && enabled) {
+            recordEvent(zone.name, static_cast<std::int64_t>(begin_ns) + gpuToCpuOffset_ns,
+                        static_cast<std::int64_t>(end_ns - begin_ns), GPU_THREAD_ID);
+        }
+
+        freeQueries.push_back(zone.beginQuery);
+        freeQueries.push_back(zone.endQuery);
+        pendingGpuZones.pop_front();
+    }
+}
+
+bool writeChromeTrace(const std::string &filepath) {
+    std::ofstream file(filepath);
+    file << exportChromeTrace();
+    return static_cast<bool>(file);
+}
+
+std::string exportChromeTrace() {
+    // Zones may be recorded while the trace is exported
+    const auto recordedEvents = copyEvents();
+
+    std::ostringstream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_THREAD_ID
+         << ",\"args\":{\"name\":\"GPU\"}}";
+
+    for (const auto &event : recordedEvents) {
+        json << ",{\"name\":\"" << event.name << "\""
+             << ",\"cat\":\"" << (event.threadId == GPU_THREAD_ID ? "gpu" : "cpu") << "\""
+             << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.threadId
+             << ",\"ts\":" << event.start_ns / 1000 << "." << event.start_ns % 1000 / 100
+             << ",\"dur\":" << event.duration_ns / 1000 << "." << event.duration_ns % 1000 / 100
+             << "}";
+    }
+
+    json << "]}";
+    return json.str();
+}
+
+void clear() {
+    numEventsRecorded = 0u;
+}
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void recordCpuZone(const char *name, std::int64_t start_ns, std::int64_t end_ns) {
+    if (!enabled) return;
+    recordEvent(name, start_ns, end_ns - start_ns, getThreadId());
+}
+
+GLuint beginGpuZone(const char *name) {
+    if (!enabled || !gpuTimingSupported) return 0u;
+
+    const auto beginQuery = allocateQuery();
+    const auto endQuery = allocateQuery();
+    glQueryCounterEXT(beginQuery, GL_TIMESTAMP_EXT);
+    pendingGpuZones.push_back({beginQuery, endQuery, name});
+    return endQuery;
+}
+
+void endGpuZone(GLuint query) {
+    if (query != 0u) {
+        glQueryCounterEXT(query, GL_TIMESTAMP_EXT);
+    }
+}
+
+} // namespace Profiler
+
+ProfileZone::ProfileZone(const char *name) : name(name), start_ns(Profiler::now_ns()) {
+#ifdef __ANDROID__
+    ATrace_beginSection(name);
+#endif
+}
+
+ProfileZone::~ProfileZone() {
+#ifdef __ANDROID__
+    ATrace_endSection();
+#endif
+    Profiler::recordCpuZone(this->name, this->start_ns, Profiler::now_ns());
+}
+
+GpuProfileZone::GpuProfileZone(const char *name) : query(Profiler::beginGpuZone(name)) {}
+
+GpuProfileZone::~GpuProfileZone() {
+    Profiler::endGpuZone(this->query);
+}
+
+} // namespace age
@@ -0,0 +1,176 @@
+#include <android_game_engine/ProgramBinaryCache.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <GLES3/gl32.h>
+
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ResourceCache.h>
+
+namespace {
+
+// Header of a binary file that is followed by the program binary
+struct Header {
+    std::uint32_t magic;
+    std::uint32_t binaryFormat;
+    std::uint32_t binaryLength;
+    std::uint32_t reserved;
+    std::uint64_t sourceHash;
+    std::uint64_t driverHash;
+};
+static_assert(sizeof(Header) == 32u, "Header is stored as is");
+
+constexpr std::uint32_t MAGIC = 0x50454741u; // "AGEP"
+
+std::string directory;
+
+// Hash of the GL vendor, renderer and driver version, 0 until queried in the GL context
+std::uint64_t driverHash = 0u;
+bool supported = false;
+
+age::ProgramBinaryCache::Stats stats;
+
+///
+/// \brief isEnabled Returns whether binaries can be loaded and stored, querying the driver on
+///                  the first call.
+///
+bool isEnabled();
+
+std::string getFilepath(std::uint64_t sourceHash);
+
+bool isEnabled() {
+    if (directory.empty()) return false;
+
+    if (driverHash == 0u) {
+        driverHash = age::ResourceCache::HASH_SEED;
+        for (auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+            const auto string = reinterpret_cast<const char*>(glGetString(name));
+            if (string) {
+                driverHash = age::ResourceCache::hash(string, std::strlen(string), driverHash);
+            }
+        }
+
+        GLint numBinaryFormats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+        supported = numBinaryFormats > 0;
+        if (!supported) {
+            age::Log::info("Program binaries are not supported, shaders are compiled on every launch");
+        }
+    }
+    return supported;
+}
+
+std::string getFilepath(std::uint64_t sourceHash) {
+    char filename[32];
+    std::snprintf(filename, sizeof(filename), "%016" PRIx64 ".bin", sourceHash);
+    return directory + "/" + filename;
+}
+
+} // namespace
+
+namespace age {
+namespace ProgramBinaryCache {
+
+void init(const std::string &dir) {
+    directory = dir;
+    driverHash = 0u;
+}
+
+bool load(unsigned int program, std::uint64_t sourceHash) {
+    if (!isEnabled()) return false;
+
+    const auto filepath = getFilepath(sourceHash);
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+
+    // The stored length is only trusted if the file actually contains that many bytes
+    const auto fileSize = static_cast<std::uint64_t>(file.tellg());
+    file.seekg(0);
+
+    Header header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != MAGIC ||
+            fileSize != sizeof(header) + static_cast<std::uint64_t>(header.binaryLength)) {
+        Log::warn("Program binary is corrupt: " + filepath);
+        ++stats.numRejected;
+        file.close();
+        std::remove(filepath.c_str());
+        return false;
+    }
+
+    std::vector<char> binary(header.binaryLength);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+
+    // Binaries of other drivers are overwritten once the program is compiled from source
+    if (!file || header.sourceHash != sourceHash || header.driverHash != driverHash) {
+        ++stats.numRejected;
+        return false;
+    }
+
+    glProgramBinary(program, header.binaryFormat, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+    return true;
+}
+
+void finishLoad(std::uint64_t sourceHash, bool linked) {
+    if (linked) {
+        ++stats.numLoaded;
+        return;
+    }
+
+    const auto filepath = getFilepath(sourceHash);
+    Log::warn("Program binary was rejected by the driver: " + filepath);
+    ++stats.numRejected;
+    std::remove(filepath.c_str());
+}
+
+void store(unsigned int program, std::uint64_t sourceHash) {
+    if (!isEnabled()) return;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLsizei binaryLength = 0;
+    GLenum binaryFormat = GL_NONE;
+    glGetProgramBinary(program, length, &binaryLength, &binaryFormat, binary.data());
+    if (binaryLength <= 0) return;
+
+    const Header header{MAGIC, binaryFormat, static_cast<std::uint32_t>(binaryLength), 0u,
+                        sourceHash, driverHash};
+
+    // Written to a temporary file first so that an interrupted write never leaves a truncated
+    // binary behind
+    const auto filepath = getFilepath(sourceHash);
+    const auto temporaryFilepath = filepath + ".tmp";
+    {
+        std::ofstream file(temporaryFilepath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), binaryLength);
+        if (!file) {
+            Log::warn("Failed to write program binary: " + temporaryFilepath);
+            file.close();
+            std::remove(temporaryFilepath.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(temporaryFilepath.c_str(), filepath.c_str()) != 0) {
+        Log::warn("Failed to write program binary: " + filepath);
+        std::remove(temporaryFilepath.c_str());
+        return;
+    }
+    ++stats.numStored;
+}
+
+Stats getStats() {
+    return stats;
+}
+
+} // namespace ProgramBinaryCache
+} // namespace age
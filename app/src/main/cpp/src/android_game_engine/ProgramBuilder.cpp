@@ -0,0 +1,326 @@
+#include <android_game_engine/ProgramBuilder.h>
+
+#include <algorithm>
+#include <sstream>
+#include <utility>
+
+#include <EGL/egl.h>
+#include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ProgramBinaryCache.h>
+#include <android_game_engine/Shader.h>
+
+// Older NDK headers do not define the extension
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace age {
+namespace ProgramBuilder {
+
+class Build {
+public:
+    enum class State {
+        LINKING_BINARY,
+        LINKING,
+        READY,
+        FAILED
+    };
+
+    Build() = default;
+    ~Build();
+
+    Build(const Build &) = delete;
+    Build& operator=(const Build &) = delete;
+
+    unsigned int program = 0u;
+    State state = State::LINKING;
+
+    std::string vertexShaderPath;
+    std::string fragmentShaderPath;
+    std::vector<unsigned char> vertexShaderSource;
+    std::vector<unsigned char> fragmentShaderSource;
+    std::uint64_t sourceHash = 0u;
+
+    /// Shaders that are attached while linking from source
+    std::unique_ptr<Shader> vertexShader;
+    std::unique_ptr<Shader> fragmentShader;
+
+    std::string error;
+    std::vector<Callback> callbacks;
+};
+
+} // namespace ProgramBuilder
+} // namespace age
+
+namespace {
+
+using age::ProgramBuilder::Build;
+
+using MaxShaderCompilerThreadsProc = void (GL_APIENTRYP)(GLuint count);
+
+// Builds that are not linked yet
+std::vector<std::weak_ptr<Build>> pendingBuilds;
+unsigned int numBuilt = 0u;
+
+// Queried with the first build since programs are created before GameEngine::onSurfaceCreated
+bool initialized = false;
+bool parallel = false;
+
+void init();
+
+///
+/// \brief compile Submits the compiles of the shaders and the link of the program.
+///
+void compile(Build *build);
+
+///
+/// \brief poll Finishes the build if the driver finished linking it.
+/// \param block Whether to wait for the driver to finish linking.
+/// \return Whether the program is linked.
+/// \exception age::BuildError Failed to compile or link the shaders.
+///
+bool poll(Build *build, bool block);
+
+///
+/// \brief finish Checks the link status of a build whose link finished and starts compiling
+///               from source if the program binary was rejected.
+/// \return Whether the program is linked.
+/// \exception age::BuildError Failed to compile or link the shaders.
+///
+bool finish(Build *build);
+
+void removePending(const Build *build);
+
+void init() {
+    initialized = true;
+
+    auto maxShaderCompilerThreads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+            eglGetProcAddress("glMaxShaderCompilerThreadsKHR"));
+    parallel = age::GLState::hasExtension("GL_KHR_parallel_shader_compile") &&
+            maxShaderCompilerThreads != nullptr;
+
+    // Let the driver choose the number of threads
+    if (parallel) {
+        maxShaderCompilerThreads(0xFFFFFFFFu);
+    }
+}
+
+void compile(Build *build) {
+    build->state = Build::State::LINKING;
+
+    build->vertexShader.reset(new age::Shader(build->vertexShaderPath, build->vertexShaderSource,
+                                              GL_VERTEX_SHADER));
+    build->vertexShader->attachToProgram(build->program);
+
+    build->fragmentShader.reset(new age::Shader(build->fragmentShaderPath,
+                                                build->fragmentShaderSource, GL_FRAGMENT_SHADER));
+    build->fragmentShader->attachToProgram(build->program);
+
+    glProgramParameteri(build->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(build->program);
+}
+
+bool poll(Build *build, bool block) {
+    if (build->state == Build::State::READY) return true;
+    if (build->state == Build::State::FAILED) throw age::BuildError(build->error);
+
+    if (!block) {
+        // Without the extension, checking the link status blocks until the link finished
+        if (!parallel) return false;
+
+        GLint completed = GL_FALSE;
+        glGetProgramiv(build->program, GL_COMPLETION_STATUS_KHR, &completed);
+        if (!completed) return false;
+    }
+
+    return finish(build);
+}
+
+bool finish(Build *build) {
+    GLint linked = GL_FALSE;
+    glGetProgramiv(build->program, GL_LINK_STATUS, &linked);
+
+    if (build->state == Build::State::LINKING_BINARY) {
+        age::ProgramBinaryCache::finishLoad(build->sourceHash, linked);
+        if (!linked) {
+            compile(build);
+            return false;
+        }
+
+        age::Log::info("Successfully loaded program binary of shaders:\n" +
+                       build->vertexShaderPath + "\n" + build->fragmentShaderPath);
+    } else if (!linked) {
+        build->state = Build::State::FAILED;
+        removePending(build);
+
+        // Compile errors explain most link errors
+        try {
+            build->vertexShader->checkCompileStatus();
+            build->fragmentShader->checkCompileStatus();
+        } catch (const age::BuildError &e) {
+            build->error = e.what();
+            throw;
+        }
+
+        // Get error log
+        GLint logLength = 0;
+        glGetProgramiv(build->program, GL_INFO_LOG_LENGTH, &logLength);
+        std::unique_ptr<char[]> linkLog(new char[std::max(logLength, 1)]());
+        glGetProgramInfoLog(build->program, logLength, nullptr, linkLog.get());
+
+        std::stringstream errorMsg;
+        errorMsg << "Failed to link shaders\n" << linkLog.get();
+        build->error = errorMsg.str();
+
+        throw age::BuildError(build->error);
+    } else {
+        build->vertexShader->detachFromProgram(build->program);
+        build->fragmentShader->detachFromProgram(build->program);
+        build->vertexShader = nullptr;
+        build->fragmentShader = nullptr;
+
+        age::Log::info("Successfully compiled and linked shaders:\n" +
+                       build->vertexShaderPath + "\n" + build->fragmentShaderPath);
+        age::ProgramBinaryCache::store(build->program, build->sourceHash);
+    }
+
+    build->state = Build::State::READY;
+    build->vertexShaderSource = {};
+    build->fragmentShaderSource = {};
+    removePending(build);
+    ++numBuilt;
+
+    if (age::ProgramBuilder::areAllReady()) {
+        const auto binaryStats = age::ProgramBinaryCache::getStats();
+        age::Log::info("All programs are built, program binaries loaded: " +
+                       std::to_string(binaryStats.numLoaded) +
+                       ", rejected: " + std::to_string(binaryStats.numRejected) +
+                       ", stored: " + std::to_string(binaryStats.numStored));
+    }
+
+    const auto callbacks = std::move(build->callbacks);
+    for (const auto &callback : callbacks) {
+        callback();
+    }
+    return true;
+}
+
+void removePending(const Build *build) {
+    pendingBuilds.erase(std::remove_if(pendingBuilds.begin(), pendingBuilds.end(),
+                                       [build](const auto &pending){
+                                           const auto pendingBuild = pending.lock();
+                                           return !pendingBuild || pendingBuild.get() == build;
+                                       }),
+                        pendingBuilds.end());
+}
+
+} // namespace
+
+namespace age {
+namespace ProgramBuilder {
+
+Build::~Build() {
+    GLState::deleteProgram(this->program);
+}
+
+std::shared_ptr<Build> build(const std::string &vertexShaderPath,
+                             std::vector<unsigned char> vertexShaderSource,
+                             const std::string &fragmentShaderPath,
+                             std::vector<unsigned char> fragmentShaderSource,
+                             std::uint64_t sourceHash) {
+    if (!initialized) {
+        init();
+    }
+
+    std::shared_ptr<Build> build(new Build);
+    build->program = glCreateProgram();
+    build->vertexShaderPath = vertexShaderPath;
+    build->fragmentShaderPath = fragmentShaderPath;
+    build->vertexShaderSource = std::move(vertexShaderSource);
+    build->fragmentShaderSource = std::move(fragmentShaderSource);
+    build->sourceHash = sourceHash;
+
+    if (ProgramBinaryCache::load(build->program, sourceHash)) {
+        build->state = Build::State::LINKING_BINARY;
+    } else {
+        compile(build.get());
+    }
+
+    pendingBuilds.push_back(build);
+    return build;
+}
+
+unsigned int getId(const Build &build) {
+    return build.program;
+}
+
+bool isReady(Build *build) {
+    return poll(build, false);
+}
+
+void wait(Build *build) {
+    while (!poll(build, true)) {}
+}
+
+void onReady(Build *build, Callback callback) {
+    if (build->state == Build::State::READY) {
+        callback();
+    } else {
+        build->callbacks.push_back(std::move(callback));
+    }
+}
+
+bool update() {
+    std::vector<std::shared_ptr<Build>> builds;
+    for (const auto &pending : pendingBuilds) {
+        if (const auto build = pending.lock()) {
+            builds.push_back(build);
+        }
+    }
+
+    for (const auto &build : builds) {
+        if (parallel) {
+            poll(build.get(), false);
+        } else {
+            // Checking a build without the extension blocks until it is linked, so only one
+            // build is finished per frame
+            poll(build.get(), true);
+            break;
+        }
+    }
+    return areAllReady();
+}
+
+bool areAllReady() {
+    return std::none_of(pendingBuilds.cbegin(), pendingBuilds.cend(),
+                        [](const auto &pending){ return !pending.expired(); });
+}
+
+void waitAll() {
+    while (!pendingBuilds.empty()) {
+        const auto build = pendingBuilds.front().lock();
+        if (build) {
+            wait(build.get());
+        } else {
+            pendingBuilds.erase(pendingBuilds.begin());
+        }
+    }
+}
+
+Stats getStats() {
+    Stats stats;
+    stats.numPending = static_cast<unsigned int>(
+            std::count_if(pendingBuilds.cbegin(), pendingBuilds.cend(),
+                          [](const auto &pending){ return !pending.expired(); }));
+    stats.numBuilt = numBuilt;
+    stats.parallel = parallel;
+    return stats;
+}
+
+} // namespace ProgramBuilder
+} // namespace age
@@ -78,7 +78,8 @@ void Quad::init(const std::vector<age::Texture2D> &diffuseTextures,
                    [numTextureRepeat](const auto &tc){
                        return glm::vec2(tc.x * numTextureRepeat.x, tc.y * numTextureRepeat.y);
                    });
-    auto vao = std::make_shared<VertexArray>(positions, normals, repeatTextureCoordinates, indices);
+    auto vao = std::make_shared<VertexArray>(positions, normals, repeatTextureCoordinates, indices,
+                                             VertexLayout::compact());
     std::shared_ptr<Meshes> meshes(new Meshes{Mesh(std::move(vao),
                                                    diffuseTextures,
                                                    specularTextures)});
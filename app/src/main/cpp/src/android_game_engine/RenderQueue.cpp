@@ -0,0 +1,325 @@
+#include <android_game_engine/RenderQueue.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <android_game_engine/Mesh.h>
+#include <android_game_engine/Model.h>
+#include <android_game_engine/ShaderProgram.h>
+#include <android_game_engine/UniformBuffer.h>
+#include <android_game_engine/VertexArray.h>
+
+namespace {
+
+constexpr auto RADIX_BITS = 8u;
+constexpr auto RADIX_SIZE = 1u << RADIX_BITS;
+constexpr auto NUM_RADIX_PASSES = 64u / RADIX_BITS;
+
+// Sort key layout from the most significant bit
+constexpr auto LAYER_SHIFT = 60u;
+constexpr auto SHADER_SHIFT = 48u;
+constexpr auto TEXTURES_SHIFT = 32u;
+constexpr auto VERTEX_ARRAY_SHIFT = 16u;
+
+constexpr std::uint64_t SHADER_MASK = 0xFFFu;
+constexpr std::uint64_t FIELD_MASK = 0xFFFFu;
+
+// The vertex array field groups items by the vertex array object of their geometry arena and
+// then by their mesh so that items of the same mesh stay adjacent for instancing
+constexpr auto ARENA_SHIFT = 12u;
+constexpr std::uint64_t ARENA_MASK = 0xFu;
+constexpr std::uint64_t MESH_MASK = 0xFFFu;
+
+constexpr auto NO_BLOCK = std::numeric_limits<unsigned int>::max();
+
+static_assert(sizeof(age::ObjectUniformBlock) % 16u == 0u,
+              "Elements of std140 arrays of structures are aligned to 16 bytes");
+
+// Handles of the per item uniforms of the shader that is currently bound
+struct ItemUniforms {
+    age::UniformHandle<glm::mat4> model;
+    age::UniformHandle<glm::mat3> normal;
+    age::UniformHandle<float> specularExponent;
+};
+
+std::uint64_t foldTo16Bits(unsigned int hash);
+std::uint64_t getVertexArrayField(const age::VertexArray &vertexArray);
+
+// Returns the number of blocks of ring that back the shader's uniform block or 0 if the shader
+// does not have it
+unsigned int getNumBoundBlocks(const age::ShaderProgram &shader,
+                               const age::UniformBufferRing *ring);
+
+bool canDrawInstanced(const age::RenderItem &item1, const age::RenderItem &item2);
+
+std::uint64_t foldTo16Bits(unsigned int hash) {
+    return (hash ^ (hash >> 16u)) & FIELD_MASK;
+}
+
+std::uint64_t getVertexArrayField(const age::VertexArray &vertexArray) {
+    const auto mesh = std::hash<const age::VertexArray*>()(&vertexArray);
+    return (vertexArray.getId() & ARENA_MASK) << ARENA_SHIFT |
+           ((mesh ^ (mesh >> 12u) ^ (mesh >> 24u)) & MESH_MASK);
+}
+
+unsigned int getNumBoundBlocks(const age::ShaderProgram &shader,
+                               const age::UniformBufferRing *ring) {
+    if (ring == nullptr) return 0u;
+
+    const auto blockSize_bytes = shader.getUniformBlockSize(ring->getUniformBlockName());
+    if (blockSize_bytes == 0u) return 0u;
+
+    const auto numBlocks = (blockSize_bytes + ring->getBlockStride() - 1u) / ring->getBlockStride();
+    return std::min(std::max(numBlocks, 1u), ring->getMaxBlocksPerBinding());
+}
+
+bool canDrawInstanced(const age::RenderItem &item1, const age::RenderItem &item2) {
+    if (item1.shader != item2.shader || item1.vertexArray != item2.vertexArray ||
+            item1.layer != item2.layer) {
+        return false;
+    }
+
+    if (item1.material == nullptr || item2.material == nullptr) {
+        return item1.material == item2.material;
+    }
+    return item1.material->hasSameTextures(*item2.material);
+}
+
+} // namespace
+
+namespace age {
+
+constexpr unsigned int RenderQueue::MAX_LAYER;
+constexpr unsigned int RenderQueue::MAX_INSTANCES;
+
+std::size_t RenderQueue::ObjectKeyHash::operator()(const ObjectKey &key) const {
+    return std::hash<const void*>()(key.first) * 31u ^ std::hash<const void*>()(key.second);
+}
+
+void RenderQueue::begin(const glm::vec3 &viewPosition, float maxDepth) {
+    this->viewPosition = viewPosition;
+    this->maxDepth = std::max(maxDepth, 1.0e-3f);
+
+    this->items.clear();
+    this->entries.clear();
+    this->draws.clear();
+
+    this->objectUniforms = nullptr;
+}
+
+void RenderQueue::submit(const RenderItem &item) {
+    if (!item.shader->isReady()) return;
+
+    this->entries.push_back({this->getSortKey(item), static_cast<std::uint32_t>(this->items.size())});
+    this->items.push_back(item);
+}
+
+void RenderQueue::writeObjectUniforms(const std::vector<RenderQueue*> &queues,
+                                      UniformBufferRing *ring) {
+    this->objectBlocks.clear();
+    this->blockItems.clear();
+
+    for (auto queue : queues) {
+        queue->objectUniforms = ring;
+        queue->buildDraws(ring);
+
+        for (auto &draw : queue->draws) {
+            if (draw.numBoundBlocks == 0u) continue;
+
+            const auto &item = queue->items[queue->entries[draw.firstEntry].item];
+            const auto firstBlock = ring->alignBlock(
+                    static_cast<unsigned int>(this->blockItems.size()));
+
+            if (draw.numInstances == 1u) {
+                // Items with a material come with the color and specular exponent of their pose
+                const auto block = this->objectBlocks.emplace(
+                        ObjectKey(item.model, item.vertexArray), firstBlock);
+                if (block.second) {
+                    this->blockItems.resize(firstBlock + 1u, nullptr);
+                    this->blockItems[firstBlock] = &item;
+                } else if (item.material != nullptr) {
+                    this->blockItems[block.first->second] = &item;
+                }
+                draw.firstBlock = block.first->second;
+                continue;
+            }
+
+            // Instances read consecutive blocks
+            this->blockItems.resize(firstBlock + draw.numInstances, nullptr);
+            for (auto i = 0u; i < draw.numInstances; ++i) {
+                const auto &instance = queue->items[queue->entries[draw.firstEntry + i].item];
+                this->blockItems[firstBlock + i] = &instance;
+            }
+            draw.firstBlock = firstBlock;
+        }
+    }
+
+    ring->beginFrame(static_cast<unsigned int>(this->blockItems.size()));
+    for (size_t i = 0u; i < this->blockItems.size(); ++i) {
+        if (this->blockItems[i] == nullptr) continue;
+
+        const auto &item = *this->blockItems[i];
+        const auto normal = item.model->getNormalMatrix();
+
+        ObjectUniformBlock block;
+        block.model = item.model->getModelMatrix() * item.vertexArray->getPositionTransform();
+        block.normal[0] = glm::vec4(normal[0], 0.0f);
+        block.normal[1] = glm::vec4(normal[1], 0.0f);
+        block.normal[2] = glm::vec4(normal[2], 0.0f);
+        block.color = item.color;
+        block.specularExponent = item.specularExponent;
+        std::memcpy(ring->getBlock(static_cast<unsigned int>(i)), &block, sizeof(block));
+    }
+    ring->endFrame();
+}
+
+void RenderQueue::render() {
+    if (this->objectUniforms == nullptr) {
+        this->buildDraws(nullptr);
+    }
+
+    this->stats = Stats();
+    this->stats.numItems = static_cast<unsigned int>(this->items.size());
+    this->stats.numDrawCalls = static_cast<unsigned int>(this->draws.size());
+
+    ShaderProgram *shader = nullptr;
+    ItemUniforms uniforms;
+    Mesh *material = nullptr;
+    VertexArray *vertexArray = nullptr;
+    auto vertexArrayId = 0u;
+
+    for (const auto &draw : this->draws) {
+        const auto &item = this->items[this->entries[draw.firstEntry].item];
+
+        if (item.shader != shader) {
+            shader = item.shader;
+            shader->use();
+            ++this->stats.numShaderChanges;
+
+            uniforms.model = shader->getUniformHandle<glm::mat4>("model");
+            uniforms.normal = shader->getUniformHandle<glm::mat3>("normal");
+            uniforms.specularExponent = shader->getUniformHandle<float>("material.specularExponent");
+        }
+
+        if (item.material != nullptr &&
+                (material == nullptr || !material->hasSameTextures(*item.material))) {
+            material = item.material;
+            material->bindTextures();
+            ++this->stats.numTextureChanges;
+        }
+
+        // Vertex arrays of the same layout share the vertex array object of their arena
+        vertexArray = item.vertexArray;
+        if (vertexArray->getId() != vertexArrayId) {
+            vertexArrayId = vertexArray->getId();
+            vertexArray->bind();
+            ++this->stats.numVertexArrayChanges;
+        }
+
+        if (draw.numBoundBlocks > 0u) {
+            this->objectUniforms->bindBlocks(draw.firstBlock, draw.numBoundBlocks);
+        } else {
+            shader->setUniform(uniforms.model,
+                               item.model->getModelMatrix() * vertexArray->getPositionTransform());
+
+            if (item.material != nullptr) {
+                shader->setUniform(uniforms.normal, item.model->getNormalMatrix());
+                shader->setUniform(uniforms.specularExponent, item.specularExponent);
+            }
+        }
+
+        if (draw.numInstances > 1u) {
+            vertexArray->drawInstanced(draw.numInstances);
+        } else {
+            vertexArray->draw();
+        }
+    }
+}
+
+std::uint64_t RenderQueue::getSortKey(const RenderItem &item) const {
+    const auto distance = glm::length(item.model->getPosition() - this->viewPosition);
+    const auto depth = static_cast<std::uint64_t>(
+            std::min(distance / this->maxDepth, 1.0f) * static_cast<float>(FIELD_MASK));
+
+    const auto textures = item.material == nullptr ? 0u : foldTo16Bits(item.material->getTextureHash());
+
+    return static_cast<std::uint64_t>(std::min<unsigned int>(item.layer, MAX_LAYER)) << LAYER_SHIFT |
+           (item.shader->getId() & SHADER_MASK) << SHADER_SHIFT |
+           textures << TEXTURES_SHIFT |
+           getVertexArrayField(*item.vertexArray) << VERTEX_ARRAY_SHIFT |
+           depth;
+}
+
+void RenderQueue::sort() {
+    // Least significant digit radix sort which keeps the submission order of equal keys
+    const auto numEntries = this->entries.size();
+    if (numEntries < 2u) return;
+
+    std::array<std::array<std::uint32_t, RADIX_SIZE>, NUM_RADIX_PASSES> histograms {};
+    for (const auto &entry : this->entries) {
+        for (auto pass = 0u; pass < NUM_RADIX_PASSES; ++pass) {
+            ++histograms[pass][(entry.key >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1u)];
+        }
+    }
+
+    this->sortBuffer.resize(numEntries);
+    for (auto pass = 0u; pass < NUM_RADIX_PASSES; ++pass) {
+        const auto shift = pass * RADIX_BITS;
+        auto &offsets = histograms[pass];
+
+        // Passes over a digit that all keys share would not change the order
+        if (offsets[(this->entries.front().key >> shift) & (RADIX_SIZE - 1u)] == numEntries) {
+            continue;
+        }
+
+        auto offset = 0u;
+        for (auto &count : offsets) {
+            const auto digitCount = count;
+            count = offset;
+            offset += digitCount;
+        }
+
+        for (const auto &entry : this->entries) {
+            this->sortBuffer[offsets[(entry.key >> shift) & (RADIX_SIZE - 1u)]++] = entry;
+        }
+        std::swap(this->entries, this->sortBuffer);
+    }
+}
+
+void RenderQueue::buildDraws(const UniformBufferRing *ring) {
+    this->sort();
+    this->draws.clear();
+
+    const ShaderProgram *shader = nullptr;
+    auto numBoundBlocks = 0u;
+    for (std::uint32_t i = 0u; i < this->entries.size(); ++i) {
+        const auto &item = this->items[this->entries[i].item];
+        if (item.shader != shader) {
+            shader = item.shader;
+            numBoundBlocks = getNumBoundBlocks(*shader, ring);
+        }
+
+        // Instances of a draw are limited by the length of the shader's uniform block array
+        if (!this->draws.empty()) {
+            auto &draw = this->draws.back();
+            const auto &firstItem = this->items[this->entries[draw.firstEntry].item];
+            if (draw.numInstances < numBoundBlocks && canDrawInstanced(firstItem, item)) {
+                ++draw.numInstances;
+                continue;
+            }
+        }
+
+        this->draws.push_back({i, 1u, NO_BLOCK, numBoundBlocks});
+    }
+}
+
+} // namespace age
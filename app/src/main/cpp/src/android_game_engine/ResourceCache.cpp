@@ -0,0 +1,172 @@
+#include <android_game_engine/ResourceCache.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <android_game_engine/Asset.h>
+#include <android_game_engine/ManagerAssets.h>
+
+namespace {
+
+using age::ResourceCache::Key;
+
+struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+};
+
+struct Entry {
+    std::shared_ptr<void> resource;
+    std::type_index type;
+    std::size_t size_bytes;
+
+    /// Frame that the resource was last used in
+    std::uint64_t lastUsed;
+};
+
+// Content hash of an asset of the given size and modification time
+struct AssetHash {
+    std::size_t size_bytes;
+    std::int64_t modificationTime;
+    std::uint64_t hash;
+};
+
+constexpr std::uint64_t HASH_PRIME = 0x100000001B3u;
+
+std::unordered_map<Key, Entry, KeyHash> entries;
+std::size_t budget_bytes = 64u * 1024u * 1024u;
+
+// Assets of the APK do not change while the app runs. Files of the assets directory on the host
+// may, which their size or modification time tells without reading them.
+std::unordered_map<std::string, AssetHash> assetHashes;
+
+// Advanced by every trim(), i.e. every frame
+std::uint64_t frame = 0u;
+
+age::ResourceCache::Stats stats;
+
+bool isUsed(const Entry &entry);
+
+std::size_t KeyHash::operator()(const Key &key) const {
+    return std::hash<std::string>()(key.filepath) ^ static_cast<std::size_t>(key.contentHash);
+}
+
+bool isUsed(const Entry &entry) {
+    return entry.resource.use_count() > 1;
+}
+
+} // namespace
+
+namespace age {
+namespace ResourceCache {
+
+bool Key::operator==(const Key &other) const {
+    return this->contentHash == other.contentHash && this->filepath == other.filepath;
+}
+
+std::uint64_t hash(const void *data, std::size_t size_bytes, std::uint64_t hash) {
+    const auto bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0u; i < size_bytes; ++i) {
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+    return hash;
+}
+
+std::uint64_t hashAsset(const std::string &filepath, std::vector<unsigned char> *contents) {
+    const auto asset = ManagerAssets::openAsset(filepath);
+    const auto modificationTime = asset.getModificationTime();
+    const auto known = assetHashes.find(filepath);
+    if (known != assetHashes.end() && known->second.size_bytes == asset.getLength() &&
+            known->second.modificationTime == modificationTime) {
+        return known->second.hash;
+    }
+
+    auto data = ManagerAssets::readAsset(filepath);
+    const auto contentHash = hash(data.data(), data.size());
+    assetHashes[filepath] = {data.size(), modificationTime, contentHash};
+    if (contents) {
+        *contents = std::move(data);
+    }
+    return contentHash;
+}
+
+std::shared_ptr<void> findResource(const Key &key, std::type_index type) {
+    const auto entry = entries.find(key);
+    if (entry == entries.end() || entry->second.type != type) {
+        ++stats.numMisses;
+        return nullptr;
+    }
+
+    ++stats.numHits;
+    entry->second.lastUsed = frame;
+    return entry->second.resource;
+}
+
+void insertResource(const Key &key, std::shared_ptr<void> resource, std::type_index type,
+                    std::size_t size_bytes) {
+    auto &entry = entries.emplace(key, Entry{nullptr, type, 0u, 0u}).first->second;
+    entry = {std::move(resource), type, size_bytes, frame};
+}
+
+void setSize(const Key &key, std::size_t size_bytes) {
+    const auto entry = entries.find(key);
+    if (entry != entries.end()) {
+        entry->second.size_bytes = size_bytes;
+    }
+}
+
+void setBudget(std::size_t budget) {
+    budget_bytes = budget;
+}
+
+void trim() {
+    ++frame;
+
+    std::vector<std::pair<std::uint64_t, const Key*>> unused;
+    std::size_t unused_bytes = 0u;
+    for (auto &entry : entries) {
+        if (isUsed(entry.second)) {
+            entry.second.lastUsed = frame;
+        } else {
+            unused.emplace_back(entry.second.lastUsed, &entry.first);
+            unused_bytes += entry.second.size_bytes;
+        }
+    }
+    if (unused_bytes <= budget_bytes) return;
+
+    // Least recently used first
+    std::sort(unused.begin(), unused.end(),
+              [](const auto &a, const auto &b){ return a.first < b.first; });
+
+    for (const auto &resource : unused) {
+        if (unused_bytes <= budget_bytes) break;
+
+        const auto entry = entries.find(*resource.second);
+        unused_bytes -= entry->second.size_bytes;
+        entries.erase(entry);
+        ++stats.numEvictions;
+    }
+}
+
+Stats getStats() {
+    auto result = stats;
+    for (const auto &entry : entries) {
+        ++result.numResources;
+        if (isUsed(entry.second)) {
+            result.used_bytes += entry.second.size_bytes;
+        } else {
+            ++result.numUnused;
+            result.unused_bytes += entry.second.size_bytes;
+        }
+    }
+    return result;
+}
+
+void clear() {
+    entries.clear();
+}
+
+} // namespace ResourceCache
+} // namespace age
@@ -3,29 +3,35 @@
 #include <array>
 #include <sstream>
 
-#include <android_game_engine/Asset.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/ManagerAssets.h>
 
 namespace age {
 
 Shader::Shader(const std::string &filepath, GLenum type) :
-    shader(new GLuint(glCreateShader(type)),
-           [](GLuint *shader){ glDeleteShader(*shader); delete shader; }) {
-    auto asset = age::ManagerAssets::openAsset(filepath);
-    auto length = asset.getLength();
-    std::unique_ptr<GLchar[]> buffer(new GLchar[length]);
-    if (asset.read(buffer.get(), length) < 0) {
-        throw age::LoadError("Failed to read shader code from file: " + filepath);
-    }
+    Shader(filepath, age::ManagerAssets::readAsset(filepath), type) {}
 
+Shader::Shader(const std::string &filepath, const std::vector<unsigned char> &source, GLenum type) :
+    filepath(filepath),
+    shader(new GLuint(glCreateShader(type)),
+           [](GLuint *shader){ GLState::deleteShader(*shader); delete shader; }) {
     // Compile shader
-    auto shaderCode = buffer.get();
-    std::array<GLint, 1> shaderCodeSize{static_cast<GLint>(length)};
+    auto shaderCode = reinterpret_cast<const GLchar*>(source.data());
+    std::array<GLint, 1> shaderCodeSize{static_cast<GLint>(source.size())};
     glShaderSource(*this->shader, 1, &shaderCode, shaderCodeSize.data());
     glCompileShader(*this->shader);
+}
+
+void Shader::attachToProgram(unsigned int program) {
+    glAttachShader(program, *this->shader);
+}
+
+void Shader::detachFromProgram(unsigned int program) {
+    glDetachShader(program, *this->shader);
+}
 
-    // Check for compilation errors
+void Shader::checkCompileStatus() const {
     int compiled;
     glGetShaderiv(*this->shader, GL_COMPILE_STATUS, &compiled);
     if (!compiled) {
@@ -37,18 +43,10 @@ Shader::Shader(const std::string &filepath, GLenum type) :
         glGetShaderInfoLog(*this->shader, logLength, nullptr, compileLog.get());
 
         std::stringstream errorMsg;
-        errorMsg << "Failed to compile " << filepath << "\n" << compileLog;
+        errorMsg << "Failed to compile " << this->filepath << "\n" << compileLog.get();
 
         throw age::BuildError(errorMsg.str());
     }
 }
 
-void Shader::attachToProgram(unsigned int program) {
-    glAttachShader(program, *this->shader);
-}
-
-void Shader::detachFromProgram(unsigned int program) {
-    glDetachShader(program, *this->shader);
-}
-
 } // namespace age
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include <android_game_engine/ShaderProgram.h>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/mat3x3.hpp>
@@ -10,98 +15,309 @@
 #include <glm/vec3.hpp>
 
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/Log.h>
-#include <android_game_engine/Shader.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/ResourceCache.h>
 #include <android_game_engine/UniformBuffer.h>
 
+namespace {
+
+///
+/// \brief getProgramSize Returns the size of the program binary as an estimate of the GPU
+///                       memory of the program.
+///
+std::size_t getProgramSize(unsigned int program);
+
+std::size_t getProgramSize(unsigned int program) {
+    GLint size_bytes = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size_bytes);
+    return static_cast<std::size_t>(std::max(size_bytes, 0));
+}
+
+} // namespace
+
 namespace age {
 ShaderProgram::ShaderProgram(const std::string &vertexShaderPath,
-                             const std::string &fragmentShaderPath) :
-                             program(new unsigned int(glCreateProgram()),
-                                     [](unsigned int *program){ glDeleteProgram(*program); delete program; }){
-    // Compile shaders
-    auto shaderDeleter = [program=*this->program](Shader *shader) {
-        shader->detachFromProgram(program);
-        delete shader;
-    };
-
-    std::unique_ptr<Shader, decltype(shaderDeleter)> vertexShader(
-            new Shader(vertexShaderPath, GL_VERTEX_SHADER), shaderDeleter);
-    vertexShader->attachToProgram(*this->program);
-
-    std::unique_ptr<Shader, decltype(shaderDeleter)> fragmentShader(
-            new Shader(fragmentShaderPath, GL_FRAGMENT_SHADER), shaderDeleter);
-    fragmentShader->attachToProgram(*this->program);
-
-    // Link shaders
-    int linked;
-    glLinkProgram(*this->program);
-    glGetProgramiv(*this->program, GL_LINK_STATUS, &linked);
-    if (!linked) {
-        // Get error log
-        GLint logLength = 0;
-        glGetProgramiv(*this->program, GL_INFO_LOG_LENGTH, &logLength);
-        std::unique_ptr<char[]> linkLog(new char[logLength]);
-        glGetProgramInfoLog(*this->program, logLength, nullptr, linkLog.get());
-
-        std::stringstream errorMsg;
-        errorMsg << "Failed to link shaders\n" << linkLog;
-
-        throw age::BuildError(errorMsg.str());
-    }
+                             const std::string &fragmentShaderPath) {
+    std::vector<unsigned char> vertexShaderSource;
+    std::vector<unsigned char> fragmentShaderSource;
+    const auto fragmentShaderHash = ResourceCache::hashAsset(fragmentShaderPath,
+                                                             &fragmentShaderSource);
+    const auto contentHash = ResourceCache::hash(&fragmentShaderHash, sizeof(fragmentShaderHash),
+                                                 ResourceCache::hashAsset(vertexShaderPath,
+                                                                          &vertexShaderSource));
+    const ResourceCache::Key key{vertexShaderPath + "\n" + fragmentShaderPath, contentHash};
 
-    Log::info("Successfully compiled and linked shaders:\n" +
-              vertexShaderPath + "\n" + fragmentShaderPath);
+    this->program = ResourceCache::find<Program>(key);
+    if (!this->program) {
+        // Sources whose hash was known are read only now
+        if (vertexShaderSource.empty()) {
+            vertexShaderSource = ManagerAssets::readAsset(vertexShaderPath);
+        }
+        if (fragmentShaderSource.empty()) {
+            fragmentShaderSource = ManagerAssets::readAsset(fragmentShaderPath);
+        }
+
+        this->program = std::make_shared<Program>();
+        this->program->build = ProgramBuilder::build(vertexShaderPath, std::move(vertexShaderSource),
+                                                     fragmentShaderPath, std::move(fragmentShaderSource),
+                                                     contentHash);
+        ResourceCache::insert(key, this->program, 0u);
+
+        std::weak_ptr<Program> weakProgram = this->program;
+        ProgramBuilder::onReady(this->program->build.get(), [weakProgram, key](){
+            const auto program = weakProgram.lock();
+            if (!program) return;
+
+            reflectUniforms(program.get());
+            for (const auto &binding : program->blockBindings) {
+                bindUniformBlock(*program, binding.first, binding.second);
+            }
+            program->blockBindings.clear();
+            for (const auto &textureUnit : program->textureUnits) {
+                bindTextureUnit(*program, textureUnit.first, textureUnit.second);
+            }
+            program->textureUnits.clear();
+
+            ResourceCache::setSize(key, getProgramSize(ProgramBuilder::getId(*program->build)));
+        });
+    }
 }
 
 void ShaderProgram::use() {
-    glUseProgram(*this->program);
+    // Programs that are not linked yet are finished first
+    GLState::useProgram(ProgramBuilder::getId(*this->getProgram().build));
+}
+
+bool ShaderProgram::isReady() const {
+    return ProgramBuilder::isReady(this->program->build.get());
 }
 
 void ShaderProgram::setUniform(const std::string &name, bool value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform1i(location, value);
+    this->setUniform(name.c_str(), value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, int value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform1i(location, value);
+    this->setUniform(name.c_str(), value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, float value) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform1f(location, value);
+    this->setUniform(name.c_str(), value);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec2 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform2f(location, v.x, v.y);
+    this->setUniform(name.c_str(), v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec3 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform3f(location, v.x, v.y, v.z);
+    this->setUniform(name.c_str(), v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::vec4 &v) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniform4f(location, v.x, v.y, v.z, v.w);
+    this->setUniform(name.c_str(), v);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat3 &m) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
-    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(m));
+    this->setUniform(name.c_str(), m);
 }
 
 void ShaderProgram::setUniform(const std::string &name, const glm::mat4 &m) {
-    auto location = glGetUniformLocation(*this->program, name.c_str());
+    this->setUniform(name.c_str(), m);
+}
+
+void ShaderProgram::setUniform(const char *name, bool value) {
+    auto location = this->getUniformLocation(name);
+    glUniform1i(location, value);
+}
+
+void ShaderProgram::setUniform(const char *name, int value) {
+    auto location = this->getUniformLocation(name);
+    glUniform1i(location, value);
+}
+
+void ShaderProgram::setUniform(const char *name, float value) {
+    auto location = this->getUniformLocation(name);
+    glUniform1f(location, value);
+}
+
+void ShaderProgram::setUniform(const char *name, const glm::vec2 &v) {
+    auto location = this->getUniformLocation(name);
+    glUniform2f(location, v.x, v.y);
+}
+
+void ShaderProgram::setUniform(const char *name, const glm::vec3 &v) {
+    auto location = this->getUniformLocation(name);
+    glUniform3f(location, v.x, v.y, v.z);
+}
+
+void ShaderProgram::setUniform(const char *name, const glm::vec4 &v) {
+    auto location = this->getUniformLocation(name);
+    glUniform4f(location, v.x, v.y, v.z, v.w);
+}
+
+void ShaderProgram::setUniform(const char *name, const glm::mat3 &m) {
+    auto location = this->getUniformLocation(name);
+    glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(m));
+}
+
+void ShaderProgram::setUniform(const char *name, const glm::mat4 &m) {
+    auto location = this->getUniformLocation(name);
     glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(m));
 }
 
+void ShaderProgram::setUniform(UniformHandle<bool> handle, bool value) {
+    glUniform1i(handle.location, value);
+}
+
+void ShaderProgram::setUniform(UniformHandle<int> handle, int value) {
+    glUniform1i(handle.location, value);
+}
+
+void ShaderProgram::setUniform(UniformHandle<float> handle, float value) {
+    glUniform1f(handle.location, value);
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec2> handle, const glm::vec2 &v) {
+    glUniform2f(handle.location, v.x, v.y);
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec3> handle, const glm::vec3 &v) {
+    glUniform3f(handle.location, v.x, v.y, v.z);
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::vec4> handle, const glm::vec4 &v) {
+    glUniform4f(handle.location, v.x, v.y, v.z, v.w);
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::mat3> handle, const glm::mat3 &m) {
+    glUniformMatrix3fv(handle.location, 1, GL_FALSE, glm::value_ptr(m));
+}
+
+void ShaderProgram::setUniform(UniformHandle<glm::mat4> handle, const glm::mat4 &m) {
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(m));
+}
+
 void ShaderProgram::setUniformBlockBinding(const UniformBuffer &ubo) {
-    glUniformBlockBinding(*this->program,
-                          glGetUniformBlockIndex(*this->program, ubo.getUniformBlockName().c_str()),
-                          ubo.getBindingPoint());
+    this->setUniformBlockBinding(ubo.getUniformBlockName(), ubo.getBindingPoint());
+}
+
+void ShaderProgram::setUniformBlockBinding(const UniformBufferRing &uboRing) {
+    this->setUniformBlockBinding(uboRing.getUniformBlockName(), uboRing.getBindingPoint());
+}
+
+void ShaderProgram::setUniformBlockBinding(const std::string &uniformBlockName,
+                                           unsigned int bindingPoint) {
+    // Bindings of programs that are not linked yet are set once they are
+    if (!this->isReady()) {
+        this->program->blockBindings.emplace_back(uniformBlockName, bindingPoint);
+        return;
+    }
+
+    bindUniformBlock(*this->program, uniformBlockName, bindingPoint);
+}
+
+void ShaderProgram::setTextureUnit(const std::string &samplerName, int textureUnit) {
+    // Units of programs that are not linked yet are set once they are
+    if (!this->isReady()) {
+        this->program->textureUnits.emplace_back(samplerName, textureUnit);
+        return;
+    }
+
+    bindTextureUnit(*this->program, samplerName, textureUnit);
+}
+
+const ShaderProgram::Program& ShaderProgram::getProgram() const {
+    ProgramBuilder::wait(this->program->build.get());
+    return *this->program;
+}
+
+void ShaderProgram::bindUniformBlock(const Program &program, const std::string &uniformBlockName,
+                                     unsigned int bindingPoint) {
+    const auto block = program.uniformBlocks.find(uniformBlockName);
+    if (block == program.uniformBlocks.cend()) return;
+
+    glUniformBlockBinding(ProgramBuilder::getId(*program.build), block->second.index, bindingPoint);
+}
+
+void ShaderProgram::bindTextureUnit(const Program &program, const std::string &samplerName,
+                                    int textureUnit) {
+    const auto location = findUniformLocation(program, samplerName.c_str());
+    if (location < 0) return;
+
+    // Set without binding the program, which may not be the one in use
+    glProgramUniform1i(ProgramBuilder::getId(*program.build), location, textureUnit);
+}
+
+void ShaderProgram::reflectUniforms(Program *program) {
+    const auto id = ProgramBuilder::getId(*program->build);
+
+    GLint numUniforms = 0;
+    GLint maxNameLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &numUniforms);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    std::vector<char> nameBuffer(static_cast<size_t>(std::max(maxNameLength, 1)));
+    for (GLuint i = 0u; i < static_cast<GLuint>(numUniforms); ++i) {
+        GLsizei nameLength = 0;
+        GLint size = 0;
+        GLenum type = GL_NONE;
+        glGetActiveUniform(id, i, static_cast<GLsizei>(nameBuffer.size()),
+                           &nameLength, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), static_cast<size_t>(nameLength));
+
+        // Members of uniform blocks have no location
+        const auto location = glGetUniformLocation(id, name.c_str());
+        if (location < 0) continue;
+
+        // Arrays are reported by the name of their first element
+        const std::string firstElementSuffix("[0]");
+        if (name.size() > firstElementSuffix.size() &&
+                name.compare(name.size() - firstElementSuffix.size(),
+                             firstElementSuffix.size(), firstElementSuffix) == 0) {
+            name.resize(name.size() - firstElementSuffix.size());
+            program->uniformLocations.emplace_back(name, location);
+
+            for (auto element = 0; element < size; ++element) {
+                const auto elementName = name + "[" + std::to_string(element) + "]";
+                program->uniformLocations.emplace_back(
+                        elementName, glGetUniformLocation(id, elementName.c_str()));
+            }
+        } else {
+            program->uniformLocations.emplace_back(name, location);
+        }
+    }
+    std::sort(program->uniformLocations.begin(), program->uniformLocations.end());
+
+    GLint numUniformBlocks = 0;
+    GLint maxBlockNameLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCKS, &numUniformBlocks);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+
+    nameBuffer.resize(static_cast<size_t>(std::max(maxBlockNameLength, 1)));
+    for (GLuint i = 0u; i < static_cast<GLuint>(numUniformBlocks); ++i) {
+        GLsizei nameLength = 0;
+        glGetActiveUniformBlockName(id, i, static_cast<GLsizei>(nameBuffer.size()),
+                                    &nameLength, nameBuffer.data());
+        GLint size_bytes = 0;
+        glGetActiveUniformBlockiv(id, i, GL_UNIFORM_BLOCK_DATA_SIZE, &size_bytes);
+        program->uniformBlocks[std::string(nameBuffer.data(), static_cast<size_t>(nameLength))] =
+                {i, static_cast<unsigned int>(size_bytes)};
+    }
+}
+
+int ShaderProgram::findUniformLocation(const Program &program, const char *name) {
+    const auto &uniformLocations = program.uniformLocations;
+    const auto location = std::lower_bound(
+            uniformLocations.cbegin(), uniformLocations.cend(), name,
+            [](const std::pair<std::string, int> &uniform, const char *name) {
+                return std::strcmp(uniform.first.c_str(), name) < 0;
+            });
+    return location == uniformLocations.cend() || location->first != name ? -1 : location->second;
+}
+
+int ShaderProgram::getUniformLocation(const char *name) const {
+    return findUniformLocation(this->getProgram(), name);
 }
 
 } // namespace age
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <android_game_engine/Skybox.h>
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -8,17 +9,33 @@
 
 #include <android_game_engine/Asset.h>
 #include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/KTX2.h>
 #include <android_game_engine/ManagerAssets.h>
 #include <android_game_engine/ShaderProgram.h>
 
 namespace {
 
+unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths);
+
+// Uploads the compressed mip levels of KTX2 files, either one cubemap or one file per face
+unsigned int loadCompressedCubemapTexture(const std::vector<std::string> &imageFilepaths);
+
 unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths) {
+    const auto numCompressedFaces = std::count_if(imageFilepaths.cbegin(), imageFilepaths.cend(),
+                                                  age::KTX2::isKTX2File);
+    if (numCompressedFaces == static_cast<long>(imageFilepaths.size())) {
+        return loadCompressedCubemapTexture({imageFilepaths.cbegin(), imageFilepaths.cend()});
+    }
+    if (numCompressedFaces > 0) {
+        throw age::LoadError("Skybox faces must all be KTX2 files or all be images");
+    }
+    
     unsigned int texture;
     glGenTextures(1, &texture);
     
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    age::GLState::activeTexture(GL_TEXTURE0);
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, texture);
     
     int width, height, numChannels;
     for (auto i = 0u; i < imageFilepaths.size(); ++i) {
@@ -55,7 +72,7 @@ unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths
             stbi_image_free(img);
         } else {
             stbi_image_free(img);
-            glDeleteTextures(1, &texture);
+            age::GLState::deleteTextures(1, &texture);
             throw age::LoadError("Failed to load skybox texture: " + imageFilepaths[i]);
         }
     }
@@ -65,7 +82,52 @@ unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
+    return texture;
+}
+
+unsigned int loadCompressedCubemapTexture(const std::vector<std::string> &imageFilepaths) {
+    // Load all files before creating the texture so that errors leave nothing behind
+    std::vector<age::KTX2::Image> images;
+    for (const auto &imageFilepath : imageFilepaths) {
+        images.push_back(age::KTX2::load(imageFilepath));
+        
+        const auto &image = images.back();
+        const auto &first = images.front();
+        if (image.numFaces * imageFilepaths.size() != 6u) {
+            throw age::LoadError("Unexpected number of cubemap faces in: " + imageFilepath);
+        }
+        if (image.width != image.height) {
+            throw age::LoadError("Cubemap faces must be square: " + imageFilepath);
+        }
+        if (image.internalFormat != first.internalFormat || image.width != first.width ||
+                image.height != first.height || image.levels.size() != first.levels.size()) {
+            throw age::LoadError("Skybox face differs in format, size or mip levels: " + imageFilepath);
+        }
+    }
+    
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    
+    age::GLState::activeTexture(GL_TEXTURE0);
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, texture);
+    
+    auto target = static_cast<GLenum>(GL_TEXTURE_CUBE_MAP_POSITIVE_X);
+    for (const auto &image : images) {
+        for (auto face = 0u; face < image.numFaces; ++face, ++target) {
+            age::KTX2::upload(image, target, face);
+        }
+    }
+    
+    const auto numLevels = images.front().levels.size();
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(numLevels - 1u));
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER,
+                    numLevels > 1u ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    
+    age::GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
     return texture;
 }
 
@@ -73,7 +135,23 @@ unsigned int loadCubemapTexture(const std::array<std::string, 6> &imageFilepaths
 
 namespace age {
 
-Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
+Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths)
+        : texture(loadCubemapTexture(imageFilepaths)) {
+    this->init();
+}
+
+Skybox::Skybox(const std::string &cubemapFilepath)
+        : texture(loadCompressedCubemapTexture({cubemapFilepath})) {
+    this->init();
+}
+
+Skybox::~Skybox() {
+    GLState::deleteTextures(1, &this->texture);
+    GLState::deleteVertexArrays(1, &this->vao);
+    GLState::deleteBuffers(1, &this->vbo);
+}
+
+void Skybox::init() {
     const std::vector<float> positions {
             -1.0f,  1.0f, -1.0f,
             -1.0f, -1.0f, -1.0f,
@@ -118,13 +196,11 @@ Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
             1.0f, -1.0f,  1.0f
     };
 
-    this->texture = loadCubemapTexture(imageFilepaths);
-
     glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
 
     glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vbo);
     
     glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(positions.size() * sizeof(float)),
                  positions.data(), GL_STATIC_DRAW);
@@ -132,22 +208,16 @@ Skybox::Skybox(const std::array<std::string, 6> &imageFilepaths) {
                           reinterpret_cast<GLvoid*>(0));
     glEnableVertexAttribArray(0u);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-}
-
-Skybox::~Skybox() {
-    glDeleteTextures(1, &this->texture);
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+    GLState::bindVertexArray(0);
 }
 
 void Skybox::render(ShaderProgram *shader) {
-    glBindVertexArray(this->vao);
+    GLState::bindVertexArray(this->vao);
     
-    glActiveTexture(GL_TEXTURE0);
+    GLState::activeTexture(GL_TEXTURE0);
     shader->setUniform("skybox", 0);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, this->texture);
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, this->texture);
     
     glDrawArrays(GL_TRIANGLES, 0, 36);
 }
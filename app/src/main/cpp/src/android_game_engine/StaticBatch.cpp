@@ -0,0 +1,159 @@
+#include <android_game_engine/StaticBatch.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+
+#include <android_game_engine/Vertex.h>
+#include <android_game_engine/VertexArray.h>
+
+namespace {
+
+// Chunk, color and specular exponent of the game objects that are batched together
+using BatchKey = std::tuple<int, int, int, float, float, float, float>;
+
+using Geometry = std::pair<std::vector<age::Vertex>, std::vector<unsigned int>>;
+
+// Merged geometry of the meshes of a batch that share their textures. It is stored in the vertex
+// layout of the first mesh.
+struct MaterialGeometry {
+    const age::Mesh *material;
+    age::VertexLayout layout;
+    Geometry geometry;
+};
+
+struct Batch {
+    age::AABB bounds;
+    glm::vec3 color;
+    float specularExponent;
+    std::vector<MaterialGeometry> materials;
+};
+
+BatchKey getBatchKey(const age::GameObject &gameObject, float chunkSize);
+
+Geometry& getMaterialGeometry(Batch *batch, const age::Mesh &material);
+
+void appendGeometry(const Geometry &geometry, const glm::mat4 &modelMatrix,
+                    const glm::mat3 &normalMatrix, Geometry *batchGeometry);
+
+BatchKey getBatchKey(const age::GameObject &gameObject, float chunkSize) {
+    const auto chunk = glm::floor(gameObject.getWorldBounds().center / chunkSize);
+    const auto color = gameObject.getColor();
+    return BatchKey(static_cast<int>(chunk.x), static_cast<int>(chunk.y), static_cast<int>(chunk.z),
+                    color.r, color.g, color.b, gameObject.getSpecularExponent());
+}
+
+Geometry& getMaterialGeometry(Batch *batch, const age::Mesh &material) {
+    auto materialGeometry = std::find_if(batch->materials.begin(), batch->materials.end(),
+                                         [&material](const auto &materialGeometry){
+                                             return materialGeometry.material->hasSameTextures(material);
+                                         });
+    if (materialGeometry == batch->materials.end()) {
+        batch->materials.push_back({&material, material.getVertexArray()->getLayout(), {}});
+        return batch->materials.back().geometry;
+    }
+    return materialGeometry->geometry;
+}
+
+void appendGeometry(const Geometry &geometry, const glm::mat4 &modelMatrix,
+                    const glm::mat3 &normalMatrix, Geometry *batchGeometry) {
+    auto &vertices = batchGeometry->first;
+    auto &indices = batchGeometry->second;
+    const auto baseVertex = static_cast<unsigned int>(vertices.size());
+
+    vertices.reserve(vertices.size() + geometry.first.size());
+    for (const auto &vertex : geometry.first) {
+        vertices.emplace_back(glm::vec3(modelMatrix * glm::vec4(vertex.position, 1.0f)),
+                              glm::normalize(normalMatrix * vertex.normal),
+                              glm::vec2(vertex.textureCoordinates));
+    }
+
+    indices.reserve(indices.size() + geometry.second.size());
+    std::transform(geometry.second.cbegin(), geometry.second.cend(), std::back_inserter(indices),
+                   [baseVertex](const auto i){ return baseVertex + i; });
+}
+
+} // namespace
+
+namespace age {
+
+std::vector<std::shared_ptr<StaticBatch>> StaticBatch::build(const std::vector<GameObject*> &gameObjects,
+                                                             float chunkSize) {
+    std::map<BatchKey, Batch> batches;
+
+    // Vertex arrays are often shared, e.g. by boxes, so they are only read back once
+    std::unordered_map<const VertexArray*, Geometry> vertexArrayGeometries;
+
+    for (auto gameObject : gameObjects) {
+        if (!gameObject->hasBounds()) continue;
+
+        const auto bounds = gameObject->getWorldBounds();
+        auto batch = batches.emplace(getBatchKey(*gameObject, chunkSize),
+                                     Batch{bounds, gameObject->getColor(),
+                                           gameObject->getSpecularExponent(), {}});
+        if (!batch.second) {
+            batch.first->second.bounds = AABB::merge(batch.first->second.bounds, bounds);
+        }
+
+        const auto modelMatrix = gameObject->getModelMatrix();
+        const auto normalMatrix = gameObject->getNormalMatrix();
+        const auto meshes = gameObject->getMesh();
+        for (const auto &mesh : *meshes) {
+            const auto vertexArray = mesh.getVertexArray();
+            auto geometry = vertexArrayGeometries.find(vertexArray);
+            if (geometry == vertexArrayGeometries.end()) {
+                geometry = vertexArrayGeometries.emplace(vertexArray, Geometry()).first;
+                vertexArray->readGeometry(&geometry->second.first, &geometry->second.second);
+            }
+
+            appendGeometry(geometry->second, modelMatrix, normalMatrix,
+                           &getMaterialGeometry(&batch.first->second, mesh));
+        }
+
+        gameObject->setVisible(false);
+    }
+
+    std::vector<std::shared_ptr<StaticBatch>> staticBatches;
+    staticBatches.reserve(batches.size());
+    for (auto &batch : batches) {
+        const auto &bounds = batch.second.bounds;
+
+        // Vertices are stored relative to the center of the batch which is its position
+        std::shared_ptr<Meshes> meshes(new Meshes);
+        meshes->reserve(batch.second.materials.size());
+        for (auto &materialGeometry : batch.second.materials) {
+            auto &vertices = materialGeometry.geometry.first;
+            for (auto &vertex : vertices) {
+                vertex.position -= bounds.center;
+            }
+
+            meshes->emplace_back(std::make_shared<VertexArray>(vertices, materialGeometry.geometry.second,
+                                                               materialGeometry.layout),
+                                 materialGeometry.material->getDiffuseTextures(),
+                                 materialGeometry.material->getSpecularTextures());
+        }
+
+        staticBatches.push_back(std::shared_ptr<StaticBatch>(new StaticBatch(std::move(meshes), bounds)));
+        staticBatches.back()->setColor(batch.second.color);
+        staticBatches.back()->setSpecularExponent(batch.second.specularExponent);
+    }
+
+    return staticBatches;
+}
+
+StaticBatch::StaticBatch(std::shared_ptr<Meshes> meshes, const AABB &bounds) : GameObject() {
+    this->setMesh(std::move(meshes));
+    this->setPosition(bounds.center);
+    this->setUnscaledDimensions(bounds.halfExtents * 2.0f);
+}
+
+} // namespace age
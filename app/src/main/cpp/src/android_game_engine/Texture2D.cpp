@@ -1,137 +1,175 @@
 #include <android_game_engine/Texture2D.h>
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <GLES3/gl32.h>
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
-#include <android_game_engine/Asset.h>
-#include <android_game_engine/Exception.h>
-#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/ResourceCache.h>
+#include <android_game_engine/TextureStreamer.h>
 
 namespace {
 
-std::unordered_map<std::string, std::weak_ptr<unsigned int>> textureIdCache;
+// Texture loaded from a file. Deletes its GPU data when the cache and all users released it.
+struct CachedTexture {
+    CachedTexture();
+    ~CachedTexture();
+
+    CachedTexture(const CachedTexture &) = delete;
+    CachedTexture& operator=(const CachedTexture &) = delete;
+
+    unsigned int id;
+    std::shared_ptr<age::TextureStreamer::Stream> stream;
+};
+
+// GPU memory of the white texture until the image is uploaded
+constexpr std::size_t PLACEHOLDER_SIZE_bytes = 3u;
+
+// Solid color textures by their 8 bit RGB values packed into an integer
+std::unordered_map<std::uint32_t, std::weak_ptr<unsigned int>> solidColorTextureIdCache;
 
 ///
-/// \brief loadImageTexture Loads and caches texture data from image file.
-/// \param imageFilepath Filepath to the image.
-/// \return OpenGL's texture ID for the loaded texture.
-/// \exception age::LoadError Failed to load image data from file.
+/// \brief createPlaceholderTexture Creates a white texture that the image is loaded into.
 ///
-std::shared_ptr<unsigned int> loadImageTexture(const std::string &imageFilepath) {
-    const auto imageFilename = imageFilepath.substr(imageFilepath.find_last_of('/') + 1);
-    
-    // Check cache to avoid reloading
-    auto textureId = textureIdCache[imageFilename].lock();
+std::shared_ptr<CachedTexture> createPlaceholderTexture();
+
+///
+/// \brief loadSolidColorTexture Creates and caches a 1x1 texture of a solid color.
+/// \param color RGB values between 0.0 and 1.0
+/// \return OpenGL's texture ID for the texture.
+///
+std::shared_ptr<unsigned int> loadSolidColorTexture(const glm::vec3 &color) {
+    const auto rgb8 = glm::round(glm::clamp(color, 0.0f, 1.0f) * 255.0f);
+    std::array<uint8_t, 3> rgb{static_cast<uint8_t>(rgb8.r),
+                               static_cast<uint8_t>(rgb8.g),
+                               static_cast<uint8_t>(rgb8.b)};
+    const auto key = static_cast<std::uint32_t>(rgb[0]) << 16u |
+                     static_cast<std::uint32_t>(rgb[1]) << 8u | rgb[2];
+
+    // Colors that are equal in 8 bits share their texture
+    auto textureId = solidColorTextureIdCache[key].lock();
     if (textureId) return textureId;
-    
-    // Load image from file
-    int width, height, numChannels;
-    auto asset = age::ManagerAssets::openAsset(imageFilepath);
-    auto length = asset.getLength();
-    std::unique_ptr<stbi_uc[]> buffer(new stbi_uc[length]);
-    asset.read(buffer.get(), length);
-    
-    stbi_set_flip_vertically_on_load(true);
-    auto img = stbi_load_from_memory(buffer.get(), length, &width, &height, &numChannels, 0);
-    
-    if (!img) {
-        stbi_image_free(img);
-        throw age::LoadError("Failed to load texture at: " + imageFilepath);
-    }
-    
-    GLenum format;
-    switch (numChannels) {
-        case 1:
-            format = GL_ALPHA;
-            break;
-        
-        case 3:
-            format = GL_RGB;
-            break;
-        
-        case 4:
-            format = GL_RGBA;
-            break;
-        
-        default:
-            format = GL_RGB;
-            break;
-    }
-    
-    // Clean up texture img on GPU and clear cache
-    auto textureIdDeleter = [imageFilename](auto textureId) {
-        glDeleteTextures(1, textureId);
-        
-        textureIdCache.erase(imageFilename);
+
+    auto textureIdDeleter = [key](auto textureId) {
+        age::GLState::deleteTextures(1, textureId);
+
+        solidColorTextureIdCache.erase(key);
         delete textureId;
     };
     textureId = std::shared_ptr<unsigned int>(new unsigned int, textureIdDeleter);
-    
-    // Load texture img onto GPU
+
+    // Load texture img onto GPU. A single texel needs no mipmaps.
     glGenTextures(1, textureId.get());
-    glBindTexture(GL_TEXTURE_2D, *textureId);
-    
+    age::GLState::bindTexture(GL_TEXTURE_2D, *textureId);
+
     glTexImage2D(GL_TEXTURE_2D,
-                 0, static_cast<GLint>(format), width, height, 0,
-                 format, GL_UNSIGNED_BYTE, img);
-    glGenerateMipmap(GL_TEXTURE_2D);
-    
+                 0, GL_RGB, 1, 1, 0,
+                 GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    textureIdCache[imageFilename] = textureId;
-    
-    glBindTexture(GL_TEXTURE_2D, 0);
-    stbi_image_free(img);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    solidColorTextureIdCache[key] = textureId;
+
+    age::GLState::bindTexture(GL_TEXTURE_2D, 0);
     return textureId;
 }
 
-} // namespace
+CachedTexture::CachedTexture() {
+    glGenTextures(1, &this->id);
+}
 
-namespace age {
+CachedTexture::~CachedTexture() {
+    age::GLState::deleteTextures(1, &this->id);
+}
 
-Texture2D::Texture2D(const std::string &imageFilepath)
-        : id(loadImageTexture(imageFilepath)) {}
-        
-Texture2D::Texture2D(const glm::vec3 &color) {
-    std::array<uint8_t, 3> rgb{static_cast<uint8_t>(color.r * 255),
-                               static_cast<uint8_t>(color.g * 255),
-                               static_cast<uint8_t>(color.b * 255)};
-    
-    auto textureIdDeleter = [](auto textureId) {
-        glDeleteTextures(1, textureId);
-        delete textureId;
-    };
-    this->id = std::shared_ptr<unsigned int>(new unsigned int, textureIdDeleter);
-    
-    // Load texture img onto GPU
-    glGenTextures(1, this->id.get());
-    glBindTexture(GL_TEXTURE_2D, *this->id);
+std::shared_ptr<CachedTexture> createPlaceholderTexture() {
+    std::shared_ptr<CachedTexture> texture(new CachedTexture);
+
+    const std::array<uint8_t, 3> white{255u, 255u, 255u};
+    age::GLState::bindTexture(GL_TEXTURE_2D, texture->id);
     
     glTexImage2D(GL_TEXTURE_2D,
                  0, GL_RGB, 1, 1, 0,
-                 GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
-    glGenerateMipmap(GL_TEXTURE_2D);
+                 GL_RGB, GL_UNSIGNED_BYTE, white.data());
     
+    // The minification filter uses mipmaps once they are loaded
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     
-    glBindTexture(GL_TEXTURE_2D, 0);
+    age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+    return texture;
 }
 
+} // namespace
+
+namespace age {
+
+Texture2D::Texture2D(const std::string &imageFilepath) {
+    // The contents are only read here the first time the file is seen, otherwise the loader reads
+    // them off the rendering thread if the texture is not cached
+    std::vector<unsigned char> contents;
+    const ResourceCache::Key key{imageFilepath, ResourceCache::hashAsset(imageFilepath, &contents)};
+
+    // Check cache to avoid reloading
+    auto texture = ResourceCache::find<CachedTexture>(key);
+    if (!texture) {
+        texture = createPlaceholderTexture();
+        texture->stream = TextureStreamer::create(std::shared_ptr<unsigned int>(texture, &texture->id),
+                                                  imageFilepath, std::move(contents));
+        ResourceCache::insert(key, texture, PLACEHOLDER_SIZE_bytes);
+
+        TextureStreamer::onResized(texture->stream.get(), [key](std::size_t size_bytes){
+            ResourceCache::setSize(key, size_bytes);
+        });
+    }
+
+    // Users share ownership of the cached texture
+    this->id = std::shared_ptr<unsigned int>(texture, &texture->id);
+    this->stream = std::shared_ptr<TextureStreamer::Stream>(texture, texture->stream.get());
+    this->load = TextureStreamer::getInitialLoad(*texture->stream);
+}
+        
+Texture2D::Texture2D(const glm::vec3 &color)
+        : id(loadSolidColorTexture(color)) {}
+
 void Texture2D::bind() {
-    glBindTexture(GL_TEXTURE_2D, *this->id);
+    GLState::bindTexture(GL_TEXTURE_2D, *this->id);
+}
+
+void Texture2D::requestSize(float screenSize_pixels) {
+    if (this->stream) {
+        TextureStreamer::request(this->stream.get(), screenSize_pixels);
+    }
+}
+
+bool Texture2D::isLoaded() const {
+    return !this->load || TextureLoader::isLoaded(*this->load);
+}
+
+void Texture2D::wait() {
+    if (this->load) {
+        TextureLoader::wait(this->load.get());
+    }
+}
+
+void Texture2D::onLoaded(TextureLoader::Callback callback) {
+    if (this->load) {
+        TextureLoader::onLoaded(this->load.get(), std::move(callback));
+    } else {
+        callback(true);
+    }
 }
 
 } // namespace age
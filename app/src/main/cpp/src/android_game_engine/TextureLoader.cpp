@@ -0,0 +1,474 @@
+#include <android_game_engine/TextureLoader.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <GLES3/gl32.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/JobSystem.h>
+#include <android_game_engine/KTX2.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ManagerAssets.h>
+
+namespace age {
+namespace TextureLoader {
+
+class Load {
+public:
+    enum class State {
+        DECODING,
+        DECODED,
+        STAGING,
+        STAGED,
+        FAILED,
+        LOADED
+    };
+
+    std::weak_ptr<unsigned int> textureId;
+    std::string imageFilepath;
+    unsigned int maxResolution;
+
+    std::atomic<State> state {State::DECODING};
+    JobCounter decoding;
+
+    /// Largest width or height of the file and of the uploaded image
+    unsigned int fullResolution = 0u;
+    unsigned int resolution = 0u;
+
+    /// GPU memory of the uploaded image
+    std::size_t size_bytes = 0u;
+
+    // Decoded image that is released after the upload
+    bool compressed = false;
+    KTX2::Image compressedImage;
+    unsigned int firstLevel = 0u;
+    GLenum format = GL_RGB;
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels;
+
+    // Only accessed on the rendering thread
+    bool finished = false;
+    std::vector<Callback> callbacks;
+    GLuint pixelUnpackBuffer = 0u; ///< Mapped while the pixels are copied into it
+};
+
+} // namespace TextureLoader
+} // namespace age
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using age::TextureLoader::Load;
+
+std::chrono::duration<float> uploadBudget(0.002f);
+std::atomic<unsigned int> numPending(0u);
+
+// Loads whose decoding finished, successfully or not, in the order that they finished
+std::mutex decodedMutex;
+std::deque<std::shared_ptr<Load>> decodedLoads;
+
+// Loads whose pixels are copied into their unpack buffer in the order that they were staged.
+// Only accessed on the rendering thread.
+std::deque<std::shared_ptr<Load>> stagedLoads;
+
+std::shared_ptr<Load> startLoad(const std::shared_ptr<unsigned int> &textureId,
+                                const std::string &imageFilepath, unsigned int maxResolution,
+                                std::shared_ptr<std::vector<unsigned char>> contents);
+void decode(Load *load, std::vector<unsigned char> data);
+void decodeImage(Load *load, const std::vector<unsigned char> &data);
+void decodeCompressedImage(Load *load, std::vector<unsigned char> data);
+
+///
+/// \brief downsample Halves the size of an image with a box filter.
+///
+void downsample(std::vector<unsigned char> *pixels, int *width, int *height, int numChannels);
+
+///
+/// \brief stageImage Maps a new pixel unpack buffer for a decoded image and copies the pixels
+///                   into it through a job, so that the image can be uploaded by a later update()
+///                   without the rendering thread copying it or waiting for the transfer.
+/// \return False if the image can't be staged and must be uploaded from client memory.
+///
+bool stageImage(const std::shared_ptr<Load> &load);
+void finish(Load *load);
+void uploadImage(Load *load, GLuint textureId);
+void uploadCompressedImage(Load *load, GLuint textureId);
+
+std::shared_ptr<Load> startLoad(const std::shared_ptr<unsigned int> &textureId,
+                                const std::string &imageFilepath, unsigned int maxResolution,
+                                std::shared_ptr<std::vector<unsigned char>> contents) {
+    std::shared_ptr<Load> load(new Load);
+    load->textureId = textureId;
+    load->imageFilepath = imageFilepath;
+    load->maxResolution = std::max(maxResolution, 1u);
+    ++numPending;
+
+    // The contents are shared with the job as std::function requires copyable jobs
+    age::JobSystem::run([load, contents]{
+        decode(load.get(), contents ? std::move(*contents) : std::vector<unsigned char>());
+
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        decodedLoads.push_back(load);
+    }, &load->decoding);
+
+    return load;
+}
+
+void decode(Load *load, std::vector<unsigned char> data) {
+    try {
+        if (data.empty()) {
+            data = age::ManagerAssets::readAsset(load->imageFilepath);
+        }
+
+        load->compressed = age::KTX2::isKTX2File(load->imageFilepath);
+        if (load->compressed) {
+            decodeCompressedImage(load, std::move(data));
+        } else {
+            decodeImage(load, data);
+        }
+        load->state = Load::State::DECODED;
+    } catch (const age::LoadError &e) {
+        age::Log::error(e.what());
+        load->state = Load::State::FAILED;
+    }
+}
+
+void decodeImage(Load *load, const std::vector<unsigned char> &data) {
+    // Gray images with alpha are expanded to RGBA as GL has no format for them
+    int numChannels = 0;
+    stbi_info_from_memory(data.data(), static_cast<int>(data.size()), &load->width, &load->height,
+                          &numChannels);
+    const auto desiredNumChannels = numChannels == 2 ? 4 : 0;
+
+    // Flipping is done by hand as stb_image's flip setting is shared by all threads
+    const auto img = stbi_load_from_memory(data.data(), static_cast<int>(data.size()),
+                                           &load->width, &load->height, &numChannels,
+                                           desiredNumChannels);
+    if (!img) {
+        throw age::LoadError("Failed to load texture at: " + load->imageFilepath);
+    }
+    if (desiredNumChannels > 0) {
+        numChannels = desiredNumChannels;
+    }
+
+    switch (numChannels) {
+        case 1:
+            load->format = GL_ALPHA;
+            break;
+
+        case 4:
+            load->format = GL_RGBA;
+            break;
+
+        default:
+            load->format = GL_RGB;
+            break;
+    }
+
+    const auto rowSize_bytes = static_cast<std::size_t>(load->width) * numChannels;
+    load->pixels.resize(rowSize_bytes * load->height);
+    for (auto y = 0; y < load->height; ++y) {
+        std::memcpy(load->pixels.data() + rowSize_bytes * (load->height - 1 - y),
+                    img + rowSize_bytes * y, rowSize_bytes);
+    }
+    stbi_image_free(img);
+
+    // Mip levels above the maximum resolution are skipped
+    load->fullResolution = static_cast<unsigned int>(std::max(load->width, load->height));
+    while (static_cast<unsigned int>(std::max(load->width, load->height)) > load->maxResolution) {
+        downsample(&load->pixels, &load->width, &load->height, numChannels);
+    }
+}
+
+void decodeCompressedImage(Load *load, std::vector<unsigned char> data) {
+    load->compressedImage = age::KTX2::parse(std::move(data), load->imageFilepath);
+    const auto &image = load->compressedImage;
+    if (image.numFaces != 1u) {
+        throw age::LoadError("Expected a 2D texture but got a cubemap at: " +
+                             load->imageFilepath);
+    }
+
+    // The first level within the maximum resolution, or the last level if none is
+    const auto lastLevel = static_cast<unsigned int>(image.levels.size() - 1u);
+    load->fullResolution = static_cast<unsigned int>(std::max(image.width, image.height));
+    load->firstLevel = 0u;
+    while (load->firstLevel < lastLevel &&
+            std::max(load->fullResolution >> load->firstLevel, 1u) > load->maxResolution) {
+        ++load->firstLevel;
+    }
+}
+
+void downsample(std::vector<unsigned char> *pixels, int *width, int *height, int numChannels) {
+    // Odd rows and columns are blended into the last texel of the smaller image
+    const auto newWidth = std::max(*width / 2, 1);
+    const auto newHeight = std::max(*height / 2, 1);
+    const auto at = [pixels, width, numChannels](int x, int y, int c) {
+        const auto i = (static_cast<std::size_t>(y) * *width + x) * numChannels + c;
+        return static_cast<unsigned int>((*pixels)[i]);
+    };
+
+    std::vector<unsigned char> result(static_cast<std::size_t>(newWidth) * newHeight * numChannels);
+    for (auto y = 0; y < newHeight; ++y) {
+        const auto y0 = std::min(2 * y, *height - 1);
+        const auto y1 = std::min(2 * y + 1, *height - 1);
+        for (auto x = 0; x < newWidth; ++x) {
+            const auto x0 = std::min(2 * x, *width - 1);
+            const auto x1 = std::min(2 * x + 1, *width - 1);
+            for (auto c = 0; c < numChannels; ++c) {
+                const auto sum = at(x0, y0, c) + at(x1, y0, c) + at(x0, y1, c) + at(x1, y1, c);
+                result[(static_cast<std::size_t>(y) * newWidth + x) * numChannels + c] =
+                        static_cast<unsigned char>((sum + 2u) / 4u);
+            }
+        }
+    }
+
+    *pixels = std::move(result);
+    *width = newWidth;
+    *height = newHeight;
+}
+
+bool stageImage(const std::shared_ptr<Load> &load) {
+    // Compressed levels are small and in their final format, so they are uploaded directly
+    if (load->state != Load::State::DECODED || load->compressed || load->textureId.expired()) {
+        return false;
+    }
+
+    const auto size = static_cast<GLsizeiptr>(load->pixels.size());
+    glGenBuffers(1, &load->pixelUnpackBuffer);
+    age::GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, load->pixelUnpackBuffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    const auto mappedPixels = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                               GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    age::GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (mappedPixels == nullptr) {
+        age::GLState::deleteBuffers(1, &load->pixelUnpackBuffer);
+        load->pixelUnpackBuffer = 0u;
+        return false;
+    }
+
+    load->state = Load::State::STAGING;
+    age::JobSystem::run([load, mappedPixels]{
+        std::memcpy(mappedPixels, load->pixels.data(), load->pixels.size());
+        load->state = Load::State::STAGED;
+    }, &load->decoding);
+    return true;
+}
+
+void finish(Load *load) {
+    if (load->finished) return;
+    load->finished = true;
+    --numPending;
+
+    const auto textureId = load->textureId.lock();
+    if (textureId && (load->state == Load::State::DECODED ||
+                      load->state == Load::State::STAGED)) {
+        if (load->compressed) {
+            uploadCompressedImage(load, *textureId);
+        } else {
+            uploadImage(load, *textureId);
+        }
+        load->state = Load::State::LOADED;
+    }
+
+    // Deleting the buffer also unmaps it if the texture was deleted while it was staged
+    if (load->pixelUnpackBuffer != 0u) {
+        age::GLState::deleteBuffers(1, &load->pixelUnpackBuffer);
+        load->pixelUnpackBuffer = 0u;
+    }
+    load->compressedImage = age::KTX2::Image();
+    load->pixels = std::vector<unsigned char>();
+
+    const auto loaded = load->state == Load::State::LOADED;
+    for (const auto &callback : load->callbacks) {
+        callback(loaded);
+    }
+    load->callbacks.clear();
+}
+
+void uploadImage(Load *load, GLuint textureId) {
+    const auto &pixels = load->pixels;
+
+    // Pixels are uploaded from client memory if they weren't staged or the contents of their
+    // buffer were lost while it was mapped
+    const void *uploadedPixels = pixels.data();
+    if (load->pixelUnpackBuffer != 0u) {
+        age::GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, load->pixelUnpackBuffer);
+        if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE) {
+            uploadedPixels = nullptr;
+        } else {
+            age::GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+    }
+
+    // Rows of RGB images are not necessarily aligned to 4 bytes
+    age::GLState::bindTexture(GL_TEXTURE_2D, textureId);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D,
+                 0, static_cast<GLint>(load->format), load->width, load->height, 0,
+                 load->format, GL_UNSIGNED_BYTE, uploadedPixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    age::GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+    // The mip levels add a third to the base level
+    load->size_bytes = pixels.size() + pixels.size() / 3u;
+    load->resolution = static_cast<unsigned int>(std::max(load->width, load->height));
+}
+
+void uploadCompressedImage(Load *load, GLuint textureId) {
+    // Compressed levels are small and in their final format, so they are uploaded directly
+    const auto &image = load->compressedImage;
+    age::GLState::bindTexture(GL_TEXTURE_2D, textureId);
+
+    // Mip levels are generated offline
+    const auto numLevels = static_cast<unsigned int>(image.levels.size()) - load->firstLevel;
+    age::KTX2::upload(image, GL_TEXTURE_2D, 0u, load->firstLevel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(numLevels - 1u));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    numLevels > 1u ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    age::GLState::bindTexture(GL_TEXTURE_2D, 0);
+
+    load->size_bytes = 0u;
+    for (auto i = load->firstLevel; i < image.levels.size(); ++i) {
+        load->size_bytes += image.levels[i].size_bytes;
+    }
+    load->resolution = std::max(load->fullResolution >> load->firstLevel, 1u);
+}
+
+} // namespace
+
+namespace age {
+namespace TextureLoader {
+
+std::shared_ptr<Load> load(const std::shared_ptr<unsigned int> &textureId,
+                           const std::string &imageFilepath,
+                           std::vector<unsigned char> contents,
+                           unsigned int maxResolution) {
+    return startLoad(textureId, imageFilepath, maxResolution,
+                     std::make_shared<std::vector<unsigned char>>(std::move(contents)));
+}
+
+std::shared_ptr<Load> load(const std::shared_ptr<unsigned int> &textureId,
+                           const std::string &imageFilepath,
+                           unsigned int maxResolution) {
+    return startLoad(textureId, imageFilepath, maxResolution, nullptr);
+}
+
+bool isLoaded(const Load &load) {
+    return load.state == Load::State::LOADED;
+}
+
+std::size_t getSize(const Load &load) {
+    return load.size_bytes;
+}
+
+unsigned int getResolution(const Load &load) {
+    return load.resolution;
+}
+
+unsigned int getFullResolution(const Load &load) {
+    return load.fullResolution;
+}
+
+void wait(Load *load) {
+    JobSystem::wait(&load->decoding);
+    finish(load);
+}
+
+void onLoaded(Load *load, Callback callback) {
+    if (load->finished) {
+        callback(load->state == Load::State::LOADED);
+    } else {
+        load->callbacks.push_back(std::move(callback));
+    }
+}
+
+void update() {
+    const auto start = Clock::now();
+    auto done = false;
+
+    // Staged images are uploaded first as their copies had the most time to finish. Loads that
+    // were waited for are already finished.
+    while (!stagedLoads.empty() && (!done || Clock::now() - start < uploadBudget)) {
+        const auto &load = stagedLoads.front();
+        if (!load->finished) {
+            if (load->state != Load::State::STAGED) break;
+            finish(load.get());
+            done = true;
+        }
+        stagedLoads.pop_front();
+    }
+
+    while (!done || Clock::now() - start < uploadBudget) {
+        std::shared_ptr<Load> load;
+        {
+            std::lock_guard<std::mutex> lock(decodedMutex);
+            while (!decodedLoads.empty() && decodedLoads.front()->finished) {
+                decodedLoads.pop_front();
+            }
+            if (decodedLoads.empty()) return;
+
+            load = std::move(decodedLoads.front());
+            decodedLoads.pop_front();
+        }
+
+        if (stageImage(load)) {
+            stagedLoads.push_back(std::move(load));
+        } else {
+            finish(load.get());
+        }
+        done = true;
+    }
+}
+
+void setUploadBudget(std::chrono::duration<float> budget) {
+    uploadBudget = budget;
+}
+
+unsigned int getNumPending() {
+    return numPending;
+}
+
+void shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(decodedMutex);
+        for (const auto &load : decodedLoads) {
+            if (load->finished) continue;
+
+            load->finished = true;
+            load->callbacks.clear();
+            --numPending;
+        }
+        decodedLoads.clear();
+    }
+
+    // Copies into the unpack buffers must be done before the buffers are deleted
+    for (const auto &load : stagedLoads) {
+        if (load->finished) continue;
+
+        JobSystem::wait(&load->decoding);
+        GLState::deleteBuffers(1, &load->pixelUnpackBuffer);
+        load->finished = true;
+        load->callbacks.clear();
+        --numPending;
+    }
+    stagedLoads.clear();
+}
+
+} // namespace TextureLoader
+} // namespace age
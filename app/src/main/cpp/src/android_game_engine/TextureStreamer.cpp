@@ -0,0 +1,289 @@
+#include <android_game_engine/TextureStreamer.h>
+
+#include <algorithm>
+#include <utility>
+
+#include <unistd.h>
+
+namespace age {
+namespace TextureStreamer {
+
+class Stream {
+public:
+    std::weak_ptr<unsigned int> textureId;
+    std::string imageFilepath;
+    std::shared_ptr<TextureLoader::Load> initialLoad;
+
+    bool loading = true;
+    bool failed = false;
+
+    /// Largest width or height of the file, 0 until the initial load finished
+    unsigned int fullResolution = 0u;
+
+    /// First mip level of the file that is resident and its GPU memory
+    unsigned int level = 0u;
+    std::size_t size_bytes = 0u;
+
+    /// Level of the initial load. KTX2 files may not have a level of MIN_RESOLUTION.
+    unsigned int maxLevel = 0u;
+
+    /// Largest screen size that the texture was requested with since the last update
+    float requested_pixels = 0.0f;
+
+    std::vector<ResizeCallback> resizeCallbacks;
+};
+
+} // namespace TextureStreamer
+} // namespace age
+
+namespace {
+
+using age::TextureStreamer::Stream;
+
+// Mip levels chosen for a stream by update()
+struct Choice {
+    std::shared_ptr<Stream> stream;
+    float requested_pixels;
+
+    /// Level that covers the requested size with a texel per pixel
+    unsigned int desiredLevel;
+
+    unsigned int level;
+};
+
+std::vector<std::weak_ptr<Stream>> streams;
+std::size_t budget_bytes = age::TextureStreamer::getDefaultBudget();
+
+unsigned int numUpgrades = 0u;
+unsigned int numDowngrades = 0u;
+
+void startLoad(const std::shared_ptr<Stream> &stream,
+               const std::shared_ptr<age::TextureLoader::Load> &load);
+void finishLoad(Stream *stream, const age::TextureLoader::Load &load, bool loaded);
+
+///
+/// \brief getLevel Returns the first mip level whose resolution is at most the given
+///                 resolution, or the level that still covers it if roundUp is set.
+///
+unsigned int getLevel(unsigned int fullResolution, float resolution, bool roundUp);
+
+unsigned int getResolution(unsigned int fullResolution, unsigned int level);
+
+///
+/// \brief getSize Estimates the GPU memory of a stream with the given first mip level from the
+///                GPU memory of its resident levels.
+///
+std::size_t getSize(const Stream &stream, unsigned int level);
+
+void startLoad(const std::shared_ptr<Stream> &stream,
+               const std::shared_ptr<age::TextureLoader::Load> &load) {
+    stream->loading = true;
+
+    std::weak_ptr<Stream> weakStream = stream;
+    std::weak_ptr<age::TextureLoader::Load> weakLoad = load;
+    age::TextureLoader::onLoaded(load.get(), [weakStream, weakLoad](bool loaded){
+        const auto stream = weakStream.lock();
+        const auto load = weakLoad.lock();
+        if (stream && load) {
+            finishLoad(stream.get(), *load, loaded);
+        }
+    });
+}
+
+void finishLoad(Stream *stream, const age::TextureLoader::Load &load, bool loaded) {
+    stream->loading = false;
+
+    // Textures whose file cannot be loaded are no longer streamed
+    if (!loaded) {
+        stream->failed = true;
+        return;
+    }
+
+    const auto initial = stream->fullResolution == 0u;
+    stream->fullResolution = age::TextureLoader::getFullResolution(load);
+    stream->level = getLevel(stream->fullResolution,
+                             static_cast<float>(age::TextureLoader::getResolution(load)), false);
+    stream->size_bytes = age::TextureLoader::getSize(load);
+    if (initial) {
+        stream->maxLevel = stream->level;
+    }
+
+    for (const auto &callback : stream->resizeCallbacks) {
+        callback(stream->size_bytes);
+    }
+}
+
+unsigned int getLevel(unsigned int fullResolution, float resolution, bool roundUp) {
+    auto level = 0u;
+    if (roundUp) {
+        while (getResolution(fullResolution, level + 1u) >= resolution &&
+                getResolution(fullResolution, level + 1u) < getResolution(fullResolution, level)) {
+            ++level;
+        }
+    } else {
+        while (static_cast<float>(getResolution(fullResolution, level)) > resolution &&
+                getResolution(fullResolution, level) > 1u) {
+            ++level;
+        }
+    }
+    return level;
+}
+
+unsigned int getResolution(unsigned int fullResolution, unsigned int level) {
+    return level < 32u ? std::max(fullResolution >> level, 1u) : 1u;
+}
+
+std::size_t getSize(const Stream &stream, unsigned int level) {
+    // Every level has a quarter of the texels of the level above it
+    if (level < stream.level) {
+        return stream.size_bytes << (2u * (stream.level - level));
+    }
+    return stream.size_bytes >> (2u * (level - stream.level));
+}
+
+} // namespace
+
+namespace age {
+namespace TextureStreamer {
+
+std::shared_ptr<Stream> create(const std::shared_ptr<unsigned int> &textureId,
+                               const std::string &imageFilepath,
+                               std::vector<unsigned char> contents) {
+    std::shared_ptr<Stream> stream(new Stream);
+    stream->textureId = textureId;
+    stream->imageFilepath = imageFilepath;
+    stream->initialLoad = TextureLoader::load(textureId, imageFilepath, std::move(contents),
+                                              MIN_RESOLUTION);
+    startLoad(stream, stream->initialLoad);
+
+    streams.push_back(stream);
+    return stream;
+}
+
+const std::shared_ptr<TextureLoader::Load>& getInitialLoad(const Stream &stream) {
+    return stream.initialLoad;
+}
+
+void onResized(Stream *stream, ResizeCallback callback) {
+    stream->resizeCallbacks.push_back(std::move(callback));
+}
+
+void request(Stream *stream, float screenSize_pixels) {
+    stream->requested_pixels = std::max(stream->requested_pixels, screenSize_pixels);
+}
+
+void update() {
+    streams.erase(std::remove_if(streams.begin(), streams.end(),
+                                 [](const auto &stream){ return stream.expired(); }),
+                  streams.end());
+
+    // Levels are only dropped if the budget requires it so that textures that were visible
+    // recently do not need to be reloaded
+    std::vector<Choice> choices;
+    std::size_t total_bytes = 0u;
+    auto numReloading = 0u;
+    for (const auto &weakStream : streams) {
+        const auto stream = weakStream.lock();
+        const auto requested_pixels = stream->requested_pixels;
+        stream->requested_pixels = 0.0f;
+
+        total_bytes += stream->size_bytes;
+        if (stream->loading && stream->fullResolution > 0u) {
+            ++numReloading;
+        }
+        if (stream->loading || stream->failed) continue;
+
+        Choice choice;
+        choice.stream = stream;
+        choice.requested_pixels = requested_pixels;
+        choice.desiredLevel = std::min(getLevel(stream->fullResolution, requested_pixels, true),
+                                       stream->maxLevel);
+        choice.level = std::min(choice.desiredLevel, stream->level);
+
+        total_bytes += getSize(*stream, choice.level) - stream->size_bytes;
+        choices.push_back(choice);
+    }
+
+    // Drop a level of the texture with the most levels beyond those it needs until the budget
+    // is met. Of textures that need all their levels, the largest is reduced first.
+    while (total_bytes > budget_bytes) {
+        Choice *drop = nullptr;
+        for (auto &choice : choices) {
+            if (choice.level >= choice.stream->maxLevel) continue;
+
+            const auto excess = static_cast<int>(choice.desiredLevel) - static_cast<int>(choice.level);
+            const auto dropExcess = drop ? static_cast<int>(drop->desiredLevel) - static_cast<int>(drop->level) : 0;
+            if (!drop || excess > dropExcess ||
+                    (excess == dropExcess &&
+                     getSize(*choice.stream, choice.level) > getSize(*drop->stream, drop->level))) {
+                drop = &choice;
+            }
+        }
+        if (!drop) break;
+
+        total_bytes -= getSize(*drop->stream, drop->level) - getSize(*drop->stream, drop->level + 1u);
+        ++drop->level;
+    }
+
+    // Reloads that free memory first, then the upgrades of the textures that cover most of the
+    // screen
+    std::sort(choices.begin(), choices.end(), [](const auto &a, const auto &b){
+        const auto aDrops = a.level > a.stream->level;
+        const auto bDrops = b.level > b.stream->level;
+        return aDrops != bDrops ? aDrops : a.requested_pixels > b.requested_pixels;
+    });
+
+    for (const auto &choice : choices) {
+        if (numReloading >= MAX_NUM_RELOADS) break;
+        if (choice.level == choice.stream->level) continue;
+
+        const auto textureId = choice.stream->textureId.lock();
+        if (!textureId) continue;
+
+        if (choice.level > choice.stream->level) {
+            ++numDowngrades;
+        } else {
+            ++numUpgrades;
+        }
+        startLoad(choice.stream, TextureLoader::load(textureId, choice.stream->imageFilepath,
+                                                     getResolution(choice.stream->fullResolution,
+                                                                   choice.level)));
+        ++numReloading;
+    }
+}
+
+void setBudget(std::size_t budget) {
+    budget_bytes = budget;
+}
+
+std::size_t getDefaultBudget() {
+    const auto numPages = sysconf(_SC_PHYS_PAGES);
+    const auto pageSize = sysconf(_SC_PAGESIZE);
+    const std::size_t minBudget_bytes = 64u * 1024u * 1024u;
+    const std::size_t maxBudget_bytes = 512u * 1024u * 1024u;
+    if (numPages <= 0 || pageSize <= 0) return minBudget_bytes;
+
+    const auto memory_bytes = static_cast<std::size_t>(numPages) * static_cast<std::size_t>(pageSize);
+    return std::min(std::max(memory_bytes / 16u, minBudget_bytes), maxBudget_bytes);
+}
+
+Stats getStats() {
+    Stats stats;
+    for (const auto &weakStream : streams) {
+        const auto stream = weakStream.lock();
+        if (!stream) continue;
+
+        ++stats.numStreams;
+        if (stream->loading && stream->fullResolution > 0u) {
+            ++stats.numReloading;
+        }
+        stats.resident_bytes += stream->size_bytes;
+    }
+    stats.budget_bytes = budget_bytes;
+    stats.numUpgrades = numUpgrades;
+    stats.numDowngrades = numDowngrades;
+    return stats;
+}
+
+} // namespace TextureStreamer
+} // namespace age
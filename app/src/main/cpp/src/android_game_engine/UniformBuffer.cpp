@@ -1,8 +1,14 @@
 #include <android_game_engine/UniformBuffer.h>
 
+#include <algorithm>
 #include <deque>
 
+#include <EGL/egl.h>
 #include <GLES3/gl32.h>
+#include <GLES2/gl2ext.h>
+
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
 
 namespace {
 
@@ -36,6 +42,30 @@ private:
 
 Pool<unsigned int> bindingPointPool {0, 1};
 
+constexpr unsigned int INITIAL_NUM_RING_BLOCKS = 64u;
+
+// Elements of std140 arrays of structures are aligned to the size of a vec4
+constexpr unsigned int STD140_STRUCT_ALIGNMENT_bytes = 16u;
+constexpr GLuint64 FENCE_TIMEOUT_ns = 1000000000u;
+
+PFNGLBUFFERSTORAGEEXTPROC glBufferStorageEXT = nullptr;
+
+unsigned int alignUp(unsigned int value, unsigned int alignment);
+unsigned int greatestCommonDivisor(unsigned int a, unsigned int b);
+
+unsigned int alignUp(unsigned int value, unsigned int alignment) {
+    return (value + alignment - 1u) / alignment * alignment;
+}
+
+unsigned int greatestCommonDivisor(unsigned int a, unsigned int b) {
+    while (b != 0u) {
+        const auto remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
 } // namespace
 
 namespace age {
@@ -43,25 +73,165 @@ namespace age {
 UniformBuffer::UniformBuffer(const std::string &uniformBlockName, unsigned int size_bytes)
         : uniformBlockName(uniformBlockName), bindingPoint(bindingPointPool.popFront()) {
     glGenBuffers(1, &this->ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
     glBufferData(GL_UNIFORM_BUFFER, size_bytes, nullptr, GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
 UniformBuffer::~UniformBuffer() {
-    glBindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
     bindingPointPool.pushFront(this->bindingPoint);
-    glDeleteBuffers(1, &this->ubo);
+    GLState::deleteBuffers(1, &this->ubo);
 }
 
 std::string UniformBuffer::getUniformBlockName() const {return this->uniformBlockName;}
 unsigned int UniformBuffer::getBindingPoint() const {return this->bindingPoint;}
 
 void UniformBuffer::bufferSubData(unsigned int offset_bytes, unsigned int size_bytes, const void *data) {
-    glBindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    // The buffer is left bound so that consecutive updates of it bind it only once
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
     glBufferSubData(GL_UNIFORM_BUFFER, offset_bytes, size_bytes, data);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
 }
 
-} // namespace age
\ No newline at end of file
+UniformBufferRing::UniformBufferRing(const std::string &uniformBlockName, unsigned int blockSize_bytes,
+                                     unsigned int maxBlocksPerBinding, unsigned int numFrames)
+        : uniformBlockName(uniformBlockName), bindingPoint(bindingPointPool.popFront()),
+          blockStride_bytes(alignUp(std::max(blockSize_bytes, 1u), STD140_STRUCT_ALIGNMENT_bytes)),
+          maxBlocksPerBinding(std::max(maxBlocksPerBinding, 1u)),
+          numFrames(std::max(numFrames, 1u)), frameFences(this->numFrames, nullptr) {
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    const auto alignment_bytes = static_cast<unsigned int>(std::max(alignment, 1));
+
+    // Number of blocks between offsets that can be bound
+    this->alignmentStride = alignment_bytes /
+            greatestCommonDivisor(this->blockStride_bytes, alignment_bytes);
+
+    glBufferStorageEXT = reinterpret_cast<PFNGLBUFFERSTORAGEEXTPROC>(
+            eglGetProcAddress("glBufferStorageEXT"));
+    this->persistent = GLState::hasExtension("GL_EXT_buffer_storage") &&
+            glBufferStorageEXT != nullptr;
+
+    this->allocate(this->alignBlock(INITIAL_NUM_RING_BLOCKS));
+}
+
+UniformBufferRing::~UniformBufferRing() {
+    this->release();
+    GLState::bindBufferBase(GL_UNIFORM_BUFFER, this->bindingPoint, 0);
+    bindingPointPool.pushFront(this->bindingPoint);
+}
+
+void UniformBufferRing::beginFrame(unsigned int numBlocks) {
+    if (numBlocks > this->numBlocksPerFrame) {
+        // Blocks of frames in flight stay valid in the orphaned buffer
+        this->release();
+        this->allocate(this->alignBlock(std::max(numBlocks, this->numBlocksPerFrame * 2u)));
+    }
+
+    // Commands that read the blocks of the previous frame have all been issued by now
+    if (this->frameMemory != nullptr) {
+        this->frameFences[this->frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    this->frame = (this->frame + 1u) % this->numFrames;
+    auto &fence = this->frameFences[this->frame];
+    if (fence != nullptr) {
+        GLenum result = GL_TIMEOUT_EXPIRED;
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT_ns);
+        }
+        GLState::deleteSync(fence);
+        fence = nullptr;
+    }
+
+    this->frameOffset_bytes = this->frame * this->numBlocksPerFrame * this->blockStride_bytes;
+    this->numFrameBlocks = numBlocks;
+
+    if (this->persistent) {
+        this->frameMemory = this->persistentMemory + this->frameOffset_bytes;
+    } else {
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+        this->frameMemory = static_cast<char*>(glMapBufferRange(
+                GL_UNIFORM_BUFFER, this->frameOffset_bytes,
+                this->numBlocksPerFrame * this->blockStride_bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                GL_MAP_FLUSH_EXPLICIT_BIT));
+
+        // Blocks are written to client memory and uploaded if the region can't be mapped
+        this->staged = this->frameMemory == nullptr;
+        if (this->staged) {
+            this->stagingMemory.resize(this->numBlocksPerFrame * this->blockStride_bytes);
+            this->frameMemory = this->stagingMemory.data();
+        }
+    }
+}
+
+void UniformBufferRing::endFrame() {
+    if (this->persistent || this->frameMemory == nullptr) return;
+
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+    if (this->staged) {
+        glBufferSubData(GL_UNIFORM_BUFFER, this->frameOffset_bytes,
+                        this->numFrameBlocks * this->blockStride_bytes, this->frameMemory);
+        return;
+    }
+
+    glFlushMappedBufferRange(GL_UNIFORM_BUFFER, 0, this->numFrameBlocks * this->blockStride_bytes);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+}
+
+void UniformBufferRing::bindBlocks(unsigned int first, unsigned int numBlocks) {
+    GLState::bindBufferRange(GL_UNIFORM_BUFFER, this->bindingPoint, this->ubo,
+                             this->frameOffset_bytes + first * this->blockStride_bytes,
+                             std::min(numBlocks, this->maxBlocksPerBinding) * this->blockStride_bytes);
+}
+
+void UniformBufferRing::allocate(unsigned int numBlocksPerFrame) {
+    this->numBlocksPerFrame = numBlocksPerFrame;
+    // Bindings of the last blocks of the last frame may extend beyond it
+    const auto size_bytes = static_cast<GLsizeiptr>(this->numBlocksPerFrame * this->numFrames +
+                                                    this->maxBlocksPerBinding) *
+            this->blockStride_bytes;
+
+    glGenBuffers(1, &this->ubo);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+
+    if (this->persistent) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT_EXT | GL_MAP_COHERENT_BIT_EXT;
+        glBufferStorageEXT(GL_UNIFORM_BUFFER, size_bytes, nullptr, flags);
+        this->persistentMemory = static_cast<char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0,
+                                                                     size_bytes, flags));
+        if (this->persistentMemory != nullptr) return;
+
+        // The storage of the buffer is immutable, so it is recreated to be mapped per frame
+        Log::warn("Failed to map uniform buffer ring persistently: " + this->uniformBlockName);
+        GLState::deleteBuffers(1, &this->ubo);
+        this->persistent = false;
+        this->allocate(numBlocksPerFrame);
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, size_bytes, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void UniformBufferRing::release() {
+    for (auto &fence : this->frameFences) {
+        if (fence != nullptr) {
+            GLState::deleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    // The mapping of a lost context is gone with its buffer
+    if (this->persistent && !GLState::isContextLost()) {
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, this->ubo);
+        glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+    this->persistentMemory = nullptr;
+    this->frameMemory = nullptr;
+
+    GLState::deleteBuffers(1, &this->ubo);
+    this->ubo = 0u;
+}
+
+} // namespace age
@@ -1,16 +1,120 @@
 #include <android_game_engine/VertexArray.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+
 #include <GLES3/gl32.h>
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
 
+#include <android_game_engine/GLState.h>
 #include <android_game_engine/Vertex.h>
 
 namespace {
 
-constexpr auto positionStride = sizeof(glm::vec3);
-constexpr auto normalStride = sizeof(glm::vec3);
-constexpr auto textureCoordinatesStride = sizeof(glm::vec2);
+void writeComponents(const float *components, GLint numComponents, GLenum type, char *data);
+void readComponents(const char *data, GLint numComponents, GLenum type, float *components);
+
+glm::vec2 encodeOctahedral(const glm::vec3 &normal);
+glm::vec3 decodeOctahedral(const glm::vec2 &encoding);
+
+std::vector<age::Vertex> toVertices(const std::vector<glm::vec3> &positions,
+                                    const std::vector<glm::vec3> &normals,
+                                    const std::vector<glm::vec2> &textureCoordinates);
+std::vector<unsigned int> toIndices(const std::vector<glm::uvec3> &indices);
+
+void writeComponents(const float *components, GLint numComponents, GLenum type, char *data) {
+    for (auto i = 0; i < numComponents; ++i) {
+        switch (type) {
+            case GL_HALF_FLOAT: {
+                const auto component = glm::packHalf1x16(components[i]);
+                std::memcpy(data + i * sizeof(component), &component, sizeof(component));
+                break;
+            }
+            case GL_SHORT: {
+                const auto component = glm::packSnorm1x16(components[i]);
+                std::memcpy(data + i * sizeof(component), &component, sizeof(component));
+                break;
+            }
+            default:
+                std::memcpy(data + i * sizeof(float), components + i, sizeof(float));
+                break;
+        }
+    }
+}
+
+void readComponents(const char *data, GLint numComponents, GLenum type, float *components) {
+    for (auto i = 0; i < numComponents; ++i) {
+        switch (type) {
+            case GL_HALF_FLOAT: {
+                std::uint16_t component;
+                std::memcpy(&component, data + i * sizeof(component), sizeof(component));
+                components[i] = glm::unpackHalf1x16(component);
+                break;
+            }
+            case GL_SHORT: {
+                std::uint16_t component;
+                std::memcpy(&component, data + i * sizeof(component), sizeof(component));
+                components[i] = glm::unpackSnorm1x16(component);
+                break;
+            }
+            default:
+                std::memcpy(components + i, data + i * sizeof(float), sizeof(float));
+                break;
+        }
+    }
+}
+
+glm::vec2 encodeOctahedral(const glm::vec3 &normal) {
+    // Projects the normal onto the octahedron |x| + |y| + |z| = 1 and folds its lower half onto
+    // the upper one
+    const auto l1Norm = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if (l1Norm == 0.0f) return glm::vec2(0.0f);
+
+    const auto n = normal / l1Norm;
+    if (n.z >= 0.0f) return glm::vec2(n);
+
+    return (1.0f - glm::abs(glm::vec2(n.y, n.x))) *
+           glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+glm::vec3 decodeOctahedral(const glm::vec2 &encoding) {
+    glm::vec3 n(encoding, 1.0f - std::abs(encoding.x) - std::abs(encoding.y));
+    const auto t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+std::vector<age::Vertex> toVertices(const std::vector<glm::vec3> &positions,
+                                    const std::vector<glm::vec3> &normals,
+                                    const std::vector<glm::vec2> &textureCoordinates) {
+    std::vector<age::Vertex> vertices;
+    vertices.reserve(positions.size());
+    for (size_t i = 0u; i < positions.size(); ++i) {
+        vertices.emplace_back(glm::vec3(positions[i]), glm::vec3(normals[i]),
+                              glm::vec2(textureCoordinates[i]));
+    }
+    return vertices;
+}
+
+std::vector<unsigned int> toIndices(const std::vector<glm::uvec3> &indices) {
+    std::vector<unsigned int> flatIndices;
+    flatIndices.reserve(indices.size() * 3u);
+    for (const auto &triangle : indices) {
+        flatIndices.insert(flatIndices.end(), {triangle.x, triangle.y, triangle.z});
+    }
+    return flatIndices;
+}
 
 } // namespace
 
@@ -19,102 +123,165 @@ namespace age {
 VertexArray::VertexArray(const std::vector<glm::vec3> &positions,
                          const std::vector<glm::vec3> &normals,
                          const std::vector<glm::vec2> &textureCoordinates,
-                         const std::vector<glm::uvec3> &indices) :
-                         numIndices(indices.size() * 3) {
-    const auto positionsSize_bytes = positions.size() * positionStride;
-    const auto normalsSize_bytes = normals.size() * normalStride;
-    const auto textureCoordinatesSize_bytes = textureCoordinates.size() * textureCoordinatesStride;
-
-    const auto normalsOffset = positionsSize_bytes;
-    const auto textureCoordinatesOffset = normalsOffset + normalsSize_bytes;
-
-    glGenVertexArrays(1, &this->vao);
-    glBindVertexArray(this->vao);
-
-    // Store vertex data
-    glGenBuffers(1, &this->vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-    glBufferData(GL_ARRAY_BUFFER,
-                 positionsSize_bytes + normalsSize_bytes + textureCoordinatesSize_bytes,
-                 nullptr, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, 0, positionsSize_bytes, positions.data());
-    glBufferSubData(GL_ARRAY_BUFFER, normalsOffset, normalsSize_bytes, normals.data());
-    glBufferSubData(GL_ARRAY_BUFFER, textureCoordinatesOffset,
-                    textureCoordinatesSize_bytes, textureCoordinates.data());
-
-    // Assign vertex attributes
-    glVertexAttribPointer(0u, 3, GL_FLOAT, GL_FALSE, positionStride,
-                          reinterpret_cast<GLvoid*>(0));
-    glEnableVertexAttribArray(0u);
-
-    glVertexAttribPointer(1u, 3, GL_FLOAT, GL_FALSE, normalStride,
-                          reinterpret_cast<GLvoid*>(normalsOffset));
-    glEnableVertexAttribArray(1u);
-
-    glVertexAttribPointer(2u, 2, GL_FLOAT, GL_FALSE, textureCoordinatesStride,
-                          reinterpret_cast<GLvoid*>(textureCoordinatesOffset));
-    glEnableVertexAttribArray(2u);
-
-    // Store indices data
-    glGenBuffers(1, &this->ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
-
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(glm::uvec3),
-                 indices.data(), GL_STATIC_DRAW);
-
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-}
+                         const std::vector<glm::uvec3> &indices,
+                         const VertexLayout &layout) :
+                         VertexArray(toVertices(positions, normals, textureCoordinates),
+                                     toIndices(indices), layout) {}
 
 VertexArray::VertexArray(const std::vector<Vertex> &vertices,
-                         const std::vector<unsigned int> &indices) :
-                         numIndices(indices.size()) {
-    glGenVertexArrays(1, &this->vao);
-    glGenBuffers(1, &this->vbo);
-    glGenBuffers(1, &this->ebo);
-
-    // Copy data into GPU
-    glBindVertexArray(this->vao);
-    glBindBuffer(GL_ARRAY_BUFFER, this->vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex),
-                 vertices.data(), GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int),
-                 indices.data(), GL_STATIC_DRAW);
-
-    // Assign vertex attributes
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(0));
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(offsetof(Vertex, normal)));
-
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
-                          reinterpret_cast<void *>(offsetof(Vertex, textureCoordinates)));
-
-    // Unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+                         const std::vector<unsigned int> &indices,
+                         const VertexLayout &layout) :
+                         arena(GeometryArena::get(layout)), numIndices(indices.size()),
+                         positionTransform(1.0f),
+                         indexType(vertices.size() <= std::numeric_limits<std::uint16_t>::max() + 1u ?
+                                   GL_UNSIGNED_SHORT : GL_UNSIGNED_INT) {
+    const auto position = layout.getPositionAttribute();
+    const auto normal = layout.getNormalAttribute();
+    const auto textureCoordinates = layout.getTextureCoordinatesAttribute();
+    const auto vertexStride = layout.getStride();
+
+    // Quantized positions span [-1, 1] over the bounds of the vertices
+    glm::vec3 center(0.0f);
+    glm::vec3 halfExtents(1.0f);
+    if (layout.position != VertexLayout::Position::FLOAT && !vertices.empty()) {
+        auto min = vertices.front().position;
+        auto max = min;
+        for (const auto &vertex : vertices) {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        center = (min + max) * 0.5f;
+        halfExtents = glm::max((max - min) * 0.5f, glm::vec3(1.0e-6f));
+        this->positionTransform = glm::scale(glm::translate(glm::mat4(1.0f), center), halfExtents);
+    }
+
+    std::vector<char> vertexData(vertices.size() * vertexStride);
+    auto data = vertexData.data();
+    for (const auto &vertex : vertices) {
+        const auto quantizedPosition = (vertex.position - center) / halfExtents;
+        writeComponents(&quantizedPosition[0], position.numComponents, position.type, data);
+
+        if (layout.normal == VertexLayout::Normal::OCTAHEDRAL) {
+            const auto encodedNormal = encodeOctahedral(vertex.normal);
+            writeComponents(&encodedNormal[0], normal.numComponents, normal.type,
+                            data + normal.offset_bytes);
+        } else {
+            writeComponents(&vertex.normal[0], normal.numComponents, normal.type,
+                            data + normal.offset_bytes);
+        }
+
+        writeComponents(&vertex.textureCoordinates[0], textureCoordinates.numComponents,
+                        textureCoordinates.type, data + textureCoordinates.offset_bytes);
+        data += vertexStride;
+    }
+
+    // Copy data into GPU. Indices are relative to the base vertex of the allocation.
+    const auto numVertices = static_cast<unsigned int>(vertices.size());
+    if (this->indexType == GL_UNSIGNED_SHORT) {
+        const std::vector<std::uint16_t> shortIndices(indices.cbegin(), indices.cend());
+        this->allocation = this->arena->allocate(vertexData.data(), numVertices, shortIndices.data(),
+                                                 shortIndices.size() * sizeof(std::uint16_t));
+    } else {
+        this->allocation = this->arena->allocate(vertexData.data(), numVertices, indices.data(),
+                                                 indices.size() * sizeof(unsigned int));
+    }
 }
 
 VertexArray::~VertexArray() {
-    glDeleteVertexArrays(1, &this->vao);
-    glDeleteBuffers(1, &this->vbo);
-    glDeleteBuffers(1, &this->ebo);
+    // Moved from vertex arrays have no arena
+    if (this->arena) {
+        this->arena->free(this->allocation);
+    }
+}
+
+VertexArray& VertexArray::operator=(VertexArray &&vertexArray) noexcept {
+    // The allocation of this vertex array is freed by the moved from one
+    std::swap(this->arena, vertexArray.arena);
+    std::swap(this->allocation, vertexArray.allocation);
+    std::swap(this->numIndices, vertexArray.numIndices);
+    std::swap(this->positionTransform, vertexArray.positionTransform);
+    std::swap(this->indexType, vertexArray.indexType);
+    return *this;
 }
 
 void VertexArray::render() {
-    glBindVertexArray(this->vao);
-    glDrawElements(GL_TRIANGLES, this->numIndices,
-                   GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(0));
+    this->bind();
+    this->draw();
+}
+
+void VertexArray::bind() {
+    this->arena->bind();
+}
+
+void VertexArray::draw() {
+    glDrawElementsBaseVertex(GL_TRIANGLES, this->numIndices, this->indexType,
+                             reinterpret_cast<const GLvoid*>(this->allocation->indexOffset_bytes),
+                             this->allocation->baseVertex);
+}
+
+void VertexArray::readGeometry(std::vector<Vertex> *vertices,
+                               std::vector<unsigned int> *indices) const {
+    const auto &layout = this->getLayout();
+    const auto position = layout.getPositionAttribute();
+    const auto normal = layout.getNormalAttribute();
+    const auto textureCoordinates = layout.getTextureCoordinatesAttribute();
+    const auto vertexStride = layout.getStride();
+    const auto numVertices = this->allocation->numVertices;
+
+    // The copy target leaves the bindings of vertex arrays untouched
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, this->arena->getVertexBuffer());
+    auto vertexData = static_cast<const char*>(glMapBufferRange(
+            GL_COPY_READ_BUFFER, this->allocation->baseVertex * vertexStride,
+            numVertices * vertexStride, GL_MAP_READ_BIT));
+
+    vertices->clear();
+    vertices->reserve(numVertices);
+    for (auto i = 0u; i < numVertices; ++i, vertexData += vertexStride) {
+        glm::vec3 quantizedPosition;
+        readComponents(vertexData, position.numComponents, position.type, &quantizedPosition[0]);
+
+        glm::vec3 decodedNormal;
+        if (layout.normal == VertexLayout::Normal::OCTAHEDRAL) {
+            glm::vec2 encodedNormal;
+            readComponents(vertexData + normal.offset_bytes, normal.numComponents, normal.type,
+                           &encodedNormal[0]);
+            decodedNormal = decodeOctahedral(encodedNormal);
+        } else {
+            readComponents(vertexData + normal.offset_bytes, normal.numComponents, normal.type,
+                           &decodedNormal[0]);
+        }
+
+        glm::vec2 decodedTextureCoordinates;
+        readComponents(vertexData + textureCoordinates.offset_bytes, textureCoordinates.numComponents,
+                       textureCoordinates.type, &decodedTextureCoordinates[0]);
+
+        vertices->emplace_back(glm::vec3(this->positionTransform * glm::vec4(quantizedPosition, 1.0f)),
+                               std::move(decodedNormal), std::move(decodedTextureCoordinates));
+    }
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, this->arena->getIndexBuffer());
+    indices->resize(this->numIndices);
+    if (this->indexType == GL_UNSIGNED_SHORT) {
+        const auto indexData = static_cast<const std::uint16_t*>(glMapBufferRange(
+                GL_COPY_READ_BUFFER, this->allocation->indexOffset_bytes,
+                this->numIndices * sizeof(std::uint16_t), GL_MAP_READ_BIT));
+        std::copy(indexData, indexData + this->numIndices, indices->begin());
+    } else {
+        const auto indexData = glMapBufferRange(GL_COPY_READ_BUFFER, this->allocation->indexOffset_bytes,
+                                                this->numIndices * sizeof(unsigned int), GL_MAP_READ_BIT);
+        std::memcpy(indices->data(), indexData, this->numIndices * sizeof(unsigned int));
+    }
+    glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+    GLState::bindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void VertexArray::drawInstanced(unsigned int numInstances) {
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, this->numIndices, this->indexType,
+                                      reinterpret_cast<const GLvoid*>(this->allocation->indexOffset_bytes),
+                                      numInstances, this->allocation->baseVertex);
 }
 
 } // namespace age
@@ -0,0 +1,115 @@
+#include <android_game_engine/VertexLayout.h>
+
+#include <tuple>
+
+#include <GLES3/gl32.h>
+
+namespace {
+
+// Format of an attribute in the vertex buffer
+struct AttributeFormat {
+    GLint numComponents;
+    GLenum type;
+    GLboolean normalized;
+
+    // Padded so that attributes start at multiples of 4 bytes
+    unsigned int size_bytes;
+};
+
+AttributeFormat getFormat(age::VertexLayout::Position position);
+AttributeFormat getFormat(age::VertexLayout::Normal normal);
+AttributeFormat getFormat(age::VertexLayout::TextureCoordinates textureCoordinates);
+
+void setAttributePointer(GLuint location, const age::VertexLayout::Attribute &attribute,
+                         GLsizei stride);
+
+AttributeFormat getFormat(age::VertexLayout::Position position) {
+    switch (position) {
+        case age::VertexLayout::Position::HALF_FLOAT:
+            return {3, GL_HALF_FLOAT, GL_FALSE, 8u};
+        case age::VertexLayout::Position::NORMALIZED_SHORT:
+            return {3, GL_SHORT, GL_TRUE, 8u};
+        default:
+            return {3, GL_FLOAT, GL_FALSE, 12u};
+    }
+}
+
+AttributeFormat getFormat(age::VertexLayout::Normal normal) {
+    switch (normal) {
+        case age::VertexLayout::Normal::OCTAHEDRAL:
+            return {2, GL_SHORT, GL_TRUE, 4u};
+        default:
+            return {3, GL_FLOAT, GL_FALSE, 12u};
+    }
+}
+
+AttributeFormat getFormat(age::VertexLayout::TextureCoordinates textureCoordinates) {
+    switch (textureCoordinates) {
+        case age::VertexLayout::TextureCoordinates::HALF_FLOAT:
+            return {2, GL_HALF_FLOAT, GL_FALSE, 4u};
+        default:
+            return {2, GL_FLOAT, GL_FALSE, 8u};
+    }
+}
+
+void setAttributePointer(GLuint location, const age::VertexLayout::Attribute &attribute,
+                         GLsizei stride) {
+    glEnableVertexAttribArray(location);
+    glVertexAttribPointer(location, attribute.numComponents, attribute.type,
+                          static_cast<GLboolean>(attribute.normalized), stride,
+                          reinterpret_cast<void *>(attribute.offset_bytes));
+}
+
+} // namespace
+
+namespace age {
+
+constexpr unsigned int VertexLayout::NORMAL_ENCODING_LOCATION;
+
+VertexLayout VertexLayout::compact() {
+    VertexLayout layout;
+    layout.position = Position::NORMALIZED_SHORT;
+    layout.normal = Normal::OCTAHEDRAL;
+    layout.textureCoordinates = TextureCoordinates::HALF_FLOAT;
+    return layout;
+}
+
+VertexLayout::Attribute VertexLayout::getPositionAttribute() const {
+    const auto format = getFormat(this->position);
+    return {format.numComponents, format.type, format.normalized == GL_TRUE, 0u};
+}
+
+VertexLayout::Attribute VertexLayout::getNormalAttribute() const {
+    const auto format = getFormat(this->normal);
+    return {format.numComponents, format.type, format.normalized == GL_TRUE,
+            getFormat(this->position).size_bytes};
+}
+
+VertexLayout::Attribute VertexLayout::getTextureCoordinatesAttribute() const {
+    const auto format = getFormat(this->textureCoordinates);
+    return {format.numComponents, format.type, format.normalized == GL_TRUE,
+            getFormat(this->position).size_bytes + getFormat(this->normal).size_bytes};
+}
+
+unsigned int VertexLayout::getStride() const {
+    return getFormat(this->position).size_bytes + getFormat(this->normal).size_bytes +
+           getFormat(this->textureCoordinates).size_bytes;
+}
+
+void VertexLayout::setAttributePointers() const {
+    const auto stride = static_cast<GLsizei>(this->getStride());
+    setAttributePointer(0u, this->getPositionAttribute(), stride);
+    setAttributePointer(1u, this->getNormalAttribute(), stride);
+    setAttributePointer(2u, this->getTextureCoordinatesAttribute(), stride);
+}
+
+void VertexLayout::setNormalEncoding() const {
+    glVertexAttrib1f(NORMAL_ENCODING_LOCATION, this->normal == Normal::OCTAHEDRAL ? 1.0f : 0.0f);
+}
+
+bool VertexLayout::operator<(const VertexLayout &layout) const {
+    return std::tie(this->position, this->normal, this->textureCoordinates) <
+           std::tie(layout.position, layout.normal, layout.textureCoordinates);
+}
+
+} // namespace age
@@ -0,0 +1,35 @@
+#include <android_game_engine/Asset.h>
+
+#include <utility>
+
+#include <sys/stat.h>
+
+namespace age {
+
+Asset::Asset(std::FILE *file) : file(file), length(0) {
+    std::fseek(file, 0, SEEK_END);
+    this->length = std::ftell(file);
+    std::rewind(file);
+}
+
+Asset::Asset(Asset &&other) noexcept : file(other.file), length(other.length) {
+    other.file = nullptr;
+}
+
+Asset& Asset::operator=(Asset &&other) noexcept {
+    std::swap(this->file, other.file);
+    std::swap(this->length, other.length);
+    return *this;
+}
+
+Asset::~Asset() {
+    if (this->file) std::fclose(this->file);
+}
+
+std::int64_t Asset::getModificationTime() const {
+    struct stat status;
+    if (fstat(fileno(this->file), &status) != 0) return 0;
+    return static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+}
+
+} // namespace age
@@ -0,0 +1,35 @@
+#include <android_game_engine/Log.h>
+
+#include <cstdio>
+
+namespace {
+
+void print(std::FILE *stream, const char *priority, const std::string &msg) {
+    std::fprintf(stream, "%s/%s: %s\n", priority, age::Log::tag.c_str(), msg.c_str());
+}
+
+} // namespace
+
+namespace age {
+namespace Log {
+
+std::string tag = "Game";
+
+void info(const std::string &msg) {
+    print(stdout, "I", msg);
+}
+
+void warn(const std::string &msg) {
+    print(stderr, "W", msg);
+}
+
+void error(const std::string &msg) {
+    print(stderr, "E", msg);
+}
+
+void fatal(const std::string &msg) {
+    print(stderr, "F", msg);
+}
+
+} // namespace log
+} // namespace age
@@ -0,0 +1,44 @@
+#include <android_game_engine/ManagerAssets.h>
+
+#include <cstdio>
+
+#include <android_game_engine/Asset.h>
+#include <android_game_engine/Exception.h>
+
+namespace {
+std::string assetsDirectory;
+} // namespace
+
+namespace age {
+namespace ManagerAssets {
+
+void init(const std::string &directory) {
+    assetsDirectory = directory;
+    if (!assetsDirectory.empty() && assetsDirectory.back() != '/') {
+        assetsDirectory += '/';
+    }
+}
+
+void shutdown() {
+    assetsDirectory.clear();
+}
+
+Asset openAsset(const std::string &filepath) {
+    auto file = std::fopen((assetsDirectory + filepath).c_str(), "rb");
+    if (file == nullptr) {
+        throw LoadError("Failed to open asset: " + filepath);
+    }
+    return Asset(file);
+}
+
+std::vector<unsigned char> readAsset(const std::string &filepath) {
+    auto asset = openAsset(filepath);
+    std::vector<unsigned char> contents(asset.getLength());
+    if (asset.read(contents.data(), contents.size()) != static_cast<int>(contents.size())) {
+        throw LoadError("Failed to read asset: " + filepath);
+    }
+    return contents;
+}
+
+} // namespace ManagerAssets
+} // namespace age
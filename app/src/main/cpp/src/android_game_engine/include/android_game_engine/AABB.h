@@ -0,0 +1,76 @@
+#pragma once
+
+#include <glm/common.hpp>
+#include <glm/vec3.hpp>
+
+namespace age {
+
+///
+/// \brief Axis-aligned bounding box in the world coordinate frame.
+///
+/// The box is stored as center and half extents, which is the form that plane tests need.
+///
+struct AABB {
+    ///
+    /// \brief fromMinMax Creates the box spanning between two corners.
+    ///
+    static AABB fromMinMax(const glm::vec3 &min, const glm::vec3 &max);
+
+    ///
+    /// \brief merge Returns the smallest box enclosing both boxes.
+    ///
+    static AABB merge(const AABB &a, const AABB &b);
+
+    glm::vec3 getMin() const;
+    glm::vec3 getMax() const;
+
+    ///
+    /// \brief getSurfaceArea Returns half of the box's surface area, which is sufficient for
+    ///                       comparing the cost of boxes.
+    ///
+    float getSurfaceArea() const;
+
+    bool contains(const AABB &box) const;
+    bool intersects(const AABB &box) const;
+
+    ///
+    /// \brief expand Returns the box grown by margin along every axis.
+    ///
+    AABB expand(float margin) const;
+
+    glm::vec3 center {0.0f};
+    glm::vec3 halfExtents {0.0f};
+};
+
+inline AABB AABB::fromMinMax(const glm::vec3 &min, const glm::vec3 &max) {
+    return {(min + max) * 0.5f, (max - min) * 0.5f};
+}
+
+inline AABB AABB::merge(const AABB &a, const AABB &b) {
+    return fromMinMax(glm::min(a.getMin(), b.getMin()), glm::max(a.getMax(), b.getMax()));
+}
+
+inline glm::vec3 AABB::getMin() const {return this->center - this->halfExtents;}
+inline glm::vec3 AABB::getMax() const {return this->center + this->halfExtents;}
+
+inline float AABB::getSurfaceArea() const {
+    const auto &e = this->halfExtents;
+    return 4.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+}
+
+inline bool AABB::contains(const AABB &box) const {
+    const auto distance = glm::abs(box.center - this->center) + box.halfExtents;
+    return distance.x <= this->halfExtents.x &&
+           distance.y <= this->halfExtents.y &&
+           distance.z <= this->halfExtents.z;
+}
+
+inline bool AABB::intersects(const AABB &box) const {
+    const auto distance = glm::abs(box.center - this->center);
+    const auto extents = this->halfExtents + box.halfExtents;
+    return distance.x <= extents.x && distance.y <= extents.y && distance.z <= extents.z;
+}
+
+inline AABB AABB::expand(float margin) const {return {this->center, this->halfExtents + margin};}
+
+} // namespace age
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+#include "AABB.h"
+#include "Frustum.h"
+
+namespace age {
+
+class GameObject;
+
+///
+/// \brief Dynamic bounding volume hierarchy over game objects for culling and spatial queries.
+///
+/// Leaves store the bounds of a game object enlarged by a margin so that an object that moves
+/// a little does not have to be reinserted. New leaves are placed next to the sibling that least
+/// increases the surface area of the tree and the tree is kept balanced with AVL rotations, so
+/// queries visit O(log n) nodes for small query volumes.
+///
+/// Queries report every game object whose enlarged bounds pass the test, so callers that need
+/// exact results must test the game object's bounds themselves.
+///
+class AABBTree {
+public:
+    using Proxy = int;
+    static constexpr Proxy NULL_PROXY = -1;
+
+    ///
+    /// \param margin Distance by which the bounds of leaves are enlarged (m).
+    ///
+    explicit AABBTree(float margin = 0.1f);
+
+    Proxy insert(const AABB &bounds, GameObject *gameObject);
+    void remove(Proxy proxy);
+
+    ///
+    /// \brief move Updates the bounds of a leaf.
+    /// \return True if the bounds left the leaf's enlarged bounds and the leaf was reinserted.
+    ///
+    bool move(Proxy proxy, const AABB &bounds);
+
+    void clear();
+
+    GameObject* getGameObject(Proxy proxy) const;
+    const AABB& getFatBounds(Proxy proxy) const;
+
+    ///
+    /// \brief getHeight Returns the number of levels below the root, i.e. 0 for a single leaf.
+    ///
+    int getHeight() const;
+
+    ///
+    /// \brief query Invokes function(GameObject*) for every game object overlapping bounds.
+    ///
+    template <typename Function>
+    void query(const AABB &bounds, const Function &function) const;
+
+    ///
+    /// \brief query Invokes function(GameObject*) for every game object intersecting the frustum.
+    ///
+    /// Game objects of subtrees that are entirely within the frustum are reported without
+    /// testing them any further.
+    ///
+    template <typename Function>
+    void query(const Frustum &frustum, const Function &function) const;
+
+    ///
+    /// \brief raycast Invokes function(GameObject*) for every game object whose bounds are hit
+    ///                by the ray within maxDistance.
+    /// \param direction Normalized direction of the ray.
+    ///
+    template <typename Function>
+    void raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                 const Function &function) const;
+
+private:
+    struct Node {
+        bool isLeaf() const;
+
+        AABB bounds;
+        GameObject *gameObject = nullptr;
+        Proxy parent = NULL_PROXY; ///< Next free node while the node is unused
+        Proxy child1 = NULL_PROXY;
+        Proxy child2 = NULL_PROXY;
+        int height = -1; ///< 0 for leaves and -1 for unused nodes
+    };
+
+    static bool intersectsRay(const AABB &bounds, const glm::vec3 &origin,
+                              const glm::vec3 &inverseDirection, float maxDistance);
+
+    Proxy allocateNode();
+    void freeNode(Proxy node);
+
+    void insertLeaf(Proxy leaf);
+    void removeLeaf(Proxy leaf);
+
+    ///
+    /// \brief refit Recomputes the bounds and heights from a node up to the root, rebalancing
+    ///              the tree along the way.
+    ///
+    void refit(Proxy node);
+    Proxy balance(Proxy node);
+
+    template <typename Function>
+    void visitLeaves(Proxy node, std::vector<Proxy> *stack, const Function &function) const;
+
+    std::vector<Node> nodes;
+    Proxy root;
+    Proxy freeList;
+    float margin;
+};
+
+inline bool AABBTree::Node::isLeaf() const {return this->child1 == NULL_PROXY;}
+
+inline GameObject* AABBTree::getGameObject(Proxy proxy) const {return this->nodes[proxy].gameObject;}
+inline const AABB& AABBTree::getFatBounds(Proxy proxy) const {return this->nodes[proxy].bounds;}
+inline int AABBTree::getHeight() const {return this->root == NULL_PROXY ? 0 : this->nodes[this->root].height;}
+
+template <typename Function>
+void AABBTree::query(const AABB &bounds, const Function &function) const {
+    if (this->root == NULL_PROXY) return;
+
+    std::vector<Proxy> stack;
+    stack.reserve(64u);
+    stack.push_back(this->root);
+
+    while (!stack.empty()) {
+        const auto &node = this->nodes[stack.back()];
+        stack.pop_back();
+
+        if (!node.bounds.intersects(bounds)) continue;
+
+        if (node.isLeaf()) {
+            function(node.gameObject);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template <typename Function>
+void AABBTree::query(const Frustum &frustum, const Function &function) const {
+    if (this->root == NULL_PROXY) return;
+
+    std::vector<Proxy> stack;
+    stack.reserve(64u);
+    stack.push_back(this->root);
+
+    std::vector<Proxy> subtreeStack;
+    while (!stack.empty()) {
+        const auto index = stack.back();
+        const auto &node = this->nodes[index];
+        stack.pop_back();
+
+        if (!frustum.intersects(node.bounds)) continue;
+
+        if (node.isLeaf()) {
+            function(node.gameObject);
+        } else if (frustum.contains(node.bounds)) {
+            this->visitLeaves(index, &subtreeStack, function);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template <typename Function>
+void AABBTree::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                       const Function &function) const {
+    if (this->root == NULL_PROXY) return;
+
+    const auto inverseDirection = 1.0f / direction;
+
+    std::vector<Proxy> stack;
+    stack.reserve(64u);
+    stack.push_back(this->root);
+
+    while (!stack.empty()) {
+        const auto &node = this->nodes[stack.back()];
+        stack.pop_back();
+
+        if (!intersectsRay(node.bounds, origin, inverseDirection, maxDistance)) continue;
+
+        if (node.isLeaf()) {
+            function(node.gameObject);
+        } else {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+template <typename Function>
+void AABBTree::visitLeaves(Proxy node, std::vector<Proxy> *stack, const Function &function) const {
+    stack->clear();
+    stack->push_back(node);
+
+    while (!stack->empty()) {
+        const auto &visited = this->nodes[stack->back()];
+        stack->pop_back();
+
+        if (visited.isLeaf()) {
+            function(visited.gameObject);
+        } else {
+            stack->push_back(visited.child1);
+            stack->push_back(visited.child2);
+        }
+    }
+}
+
+} // namespace age
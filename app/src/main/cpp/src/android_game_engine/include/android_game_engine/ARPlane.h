@@ -18,7 +18,7 @@ public:
     ARPlane(ARPlane &&) = default;
     ARPlane& operator=(ARPlane &&) = default;
 
-    void render(ShaderProgram *shader) override;
+    void render(ShaderProgram *shader);
 
     void setDimensions(const glm::vec2 &dimensions);
     void setCollisionDiameter(float diameter);
@@ -1,46 +1,97 @@
 #pragma once
 
+#include <cstdint>
+
+#ifdef __ANDROID__
 #include <android/asset_manager.h>
+#else
+#include <cstdio>
+#endif
 
 namespace age {
 
 ///
 /// Wrapper class for android AAsset. Takes ownership of the AAsset and closes it on destruction.
 ///
+/// On the host an Asset wraps a file of the assets directory instead.
+///
 class Asset {
 public:
+#ifdef __ANDROID__
     ///
     /// Takes ownership of the AAsset and closes it on destruction.
     /// \param asset
     ///
     explicit Asset(AAsset *asset);
+#else
+    ///
+    /// Takes ownership of the file and closes it on destruction.
+    /// \param file
+    ///
+    explicit Asset(std::FILE *file);
+#endif
     ~Asset();
 
-    Asset(Asset &&) noexcept = default;
-    Asset& operator=(Asset &&) noexcept = default;
-    
+    Asset(const Asset &) = delete;
+    Asset& operator=(const Asset &) = delete;
+
+    Asset(Asset &&other) noexcept;
+    Asset& operator=(Asset &&other) noexcept;
+
     size_t getLength() const;
     size_t getRemainingLength() const;
-    
+
+    ///
+    /// \return Time of the last modification of the asset in nanoseconds. Assets packaged in the
+    ///         APK never change, so this is 0 on Android.
+    ///
+    std::int64_t getModificationTime() const;
+
     int read(void *buffer, size_t count);
-    
+
     template <typename T>
     int read(T *x);
-    
+
+    ///
+    /// \return The new offset from the start of the asset or -1 on failure.
+    ///
     int seek(int offset, int whence);
-    
+
 private:
+#ifdef __ANDROID__
     AAsset *asset;
+#else
+    std::FILE *file;
+#endif
     size_t length;
 };
 
 inline size_t Asset::getLength() const {return this->length;}
+
+#ifdef __ANDROID__
 inline size_t Asset::getRemainingLength() const {return AAsset_getRemainingLength(this->asset);}
+inline std::int64_t Asset::getModificationTime() const {return 0;}
 inline int Asset::read(void *buf, size_t count) {return AAsset_read(this->asset, buf, count);}
 
 template <typename T>
 inline int Asset::read(T *x) {return AAsset_read(this->asset, x, sizeof(T));}
 
 inline int Asset::seek(int offset, int whence) {return AAsset_seek(this->asset, offset, whence);}
+#else
+inline size_t Asset::getRemainingLength() const {return this->length - std::ftell(this->file);}
+
+inline int Asset::read(void *buf, size_t count) {
+    const auto numRead = std::fread(buf, 1, count, this->file);
+    return std::ferror(this->file) ? -1 : static_cast<int>(numRead);
+}
+
+template <typename T>
+inline int Asset::read(T *x) {return this->read(static_cast<void*>(x), sizeof(T));}
+
+inline int Asset::seek(int offset, int whence) {
+    if (std::fseek(this->file, offset, whence) != 0) return -1;
+    return static_cast<int>(std::ftell(this->file));
+}
+#endif
 
-} // namespace age
\ No newline at end of file
+} // namespace age
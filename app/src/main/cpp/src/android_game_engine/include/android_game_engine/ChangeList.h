@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+namespace age {
+
+///
+/// \brief Collects the indices of changed elements without visiting the unchanged ones.
+///
+/// Each index is added at most once until the list is taken. Different indices may be added
+/// concurrently, e.g. by jobs that each update one element, but adding and taking must not
+/// overlap.
+///
+class ChangeList {
+public:
+    ChangeList() = default;
+
+    ChangeList(const ChangeList &) = delete;
+    ChangeList& operator=(const ChangeList &) = delete;
+
+    ///
+    /// \brief resize Sets the number of elements whose changes can be added. Added changes are
+    ///               kept.
+    ///
+    void resize(unsigned int numElements);
+
+    void add(unsigned int index);
+
+    ///
+    /// \brief take Invokes function(unsigned int) for every added index and empties the list.
+    ///
+    template <typename Function>
+    void take(const Function &function);
+
+    void clear();
+
+private:
+    std::vector<unsigned int> indices;
+    std::vector<unsigned char> added; ///< Each element is only ever written by one thread
+    std::atomic<unsigned int> size {0u};
+};
+
+inline void ChangeList::resize(unsigned int numElements) {
+    this->indices.resize(numElements);
+    this->added.resize(numElements, 0u);
+}
+
+inline void ChangeList::add(unsigned int index) {
+    if (this->added[index]) return;
+
+    this->added[index] = 1u;
+    this->indices[this->size.fetch_add(1u, std::memory_order_relaxed)] = index;
+}
+
+template <typename Function>
+void ChangeList::take(const Function &function) {
+    const auto size = this->size.exchange(0u, std::memory_order_relaxed);
+    for (auto i = 0u; i < size; ++i) {
+        this->added[this->indices[i]] = 0u;
+        function(this->indices[i]);
+    }
+}
+
+inline void ChangeList::clear() {
+    this->indices.clear();
+    this->added.clear();
+    this->size = 0u;
+}
+
+} // namespace age
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/fwd.hpp>
+
+#include "AABB.h"
+
+namespace age {
+
+///
+/// \brief The Frustum class represents the view volume of a perspective or orthographic
+///        projection for culling objects that cannot be seen.
+///
+class Frustum {
+public:
+    ///
+    /// \brief Frustum Extracts the clip planes of a view volume.
+    /// \param projectionView Projection matrix multiplied by the view matrix.
+    ///
+    explicit Frustum(const glm::mat4 &projectionView);
+
+    ///
+    /// \brief intersects Conservatively tests whether a box is at least partially within the
+    ///                   frustum.
+    /// \return False if the box is entirely outside of one of the clip planes.
+    ///
+    bool intersects(const AABB &box) const;
+
+    ///
+    /// \brief contains Tests whether a box is entirely within the frustum.
+    ///
+    bool contains(const AABB &box) const;
+
+private:
+    // The 6 clip planes are padded to 8 planes that every box passes. Planes are stored as a
+    // structure of arrays so that the plane tests compile to SIMD instructions.
+    static constexpr auto NUM_PLANES = 8u;
+
+    alignas(16) float normalX[NUM_PLANES];
+    alignas(16) float normalY[NUM_PLANES];
+    alignas(16) float normalZ[NUM_PLANES];
+    alignas(16) float distance[NUM_PLANES];
+};
+
+} // namespace age
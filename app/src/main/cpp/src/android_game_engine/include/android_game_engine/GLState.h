@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * Singleton cache of the GL state of the rendering thread's context.
+ *
+ * The engine changes bindings and fixed function state through these functions instead of
+ * calling GL directly. Calls that would set the state to its current value are dropped before
+ * they reach the driver. The number of issued and dropped calls is counted per frame.
+ *
+ * Objects must be deleted through the delete functions below so that the bindings that GL
+ * resets on deletion are forgotten as well. Code that changes the state by calling GL directly
+ * (e.g. third party libraries) must call GLState::invalidate() afterwards.
+ *
+ * After the context is lost, objects of the lost context are released without deleting them in GL,
+ * see onContextLost().
+ */
+
+#include <GLES3/gl32.h>
+
+namespace age {
+
+namespace GLState {
+
+/**
+ * Number of state changing calls that were passed on to GL or dropped as redundant.
+ */
+struct Stats {
+    unsigned int numIssued = 0u;
+    unsigned int numFiltered = 0u;
+};
+
+/**
+ * Sets up the cache for the current context. Must be called on the rendering thread whenever a
+ * GL context is created.
+ */
+void init();
+
+/**
+ * Stops the delete functions from deleting objects until the next init(). Must be called before
+ * the objects of a lost context are released, since the new context may reuse their names.
+ */
+void onContextLost();
+
+/**
+ * @return Whether the context was lost and init() was not called since.
+ */
+bool isContextLost();
+
+/**
+ * @return Whether the calling thread is the rendering thread that init() was called on. GL must
+ *         not be called on any other thread, e.g. the simulation thread.
+ */
+bool isContextThread();
+
+/**
+ * @return Whether the current context supports the GL extension, e.g. "GL_EXT_buffer_storage".
+ */
+bool hasExtension(const char *extension);
+
+/**
+ * Forgets all cached state so that the next call of every function is issued.
+ */
+void invalidate();
+
+/**
+ * Starts counting the calls of the next frame. Invoked by the GameEngine on the rendering thread
+ * at the end of every frame.
+ */
+void onFrameEnd();
+
+/**
+ * @return Calls of the last finished frame.
+ */
+const Stats& getLastFrameStats();
+
+void useProgram(GLuint program);
+void bindVertexArray(GLuint vertexArray);
+
+/**
+ * GL_ELEMENT_ARRAY_BUFFER bindings are part of the bound vertex array and always issued.
+ */
+void bindBuffer(GLenum target, GLuint buffer);
+void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+
+/**
+ * @param textureUnit GL_TEXTURE0 + index of the texture unit
+ */
+void activeTexture(GLenum textureUnit);
+void bindTexture(GLenum target, GLuint texture);
+
+void bindFramebuffer(GLenum target, GLuint framebuffer);
+void viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+
+void enable(GLenum capability);
+void disable(GLenum capability);
+void cullFace(GLenum mode);
+void depthFunc(GLenum func);
+void depthMask(GLboolean flag);
+void blendFunc(GLenum sourceFactor, GLenum destinationFactor);
+
+void deleteProgram(GLuint program);
+void deleteVertexArrays(GLsizei n, const GLuint *vertexArrays);
+void deleteBuffers(GLsizei n, const GLuint *buffers);
+void deleteTextures(GLsizei n, const GLuint *textures);
+void deleteFramebuffers(GLsizei n, const GLuint *framebuffers);
+void deleteShader(GLuint shader);
+void deleteSync(GLsync sync);
+
+} // namespace GLState
+
+} // namespace age
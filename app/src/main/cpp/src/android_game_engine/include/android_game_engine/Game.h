@@ -1,16 +1,28 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
+#include "AABBTree.h"
 #include "CameraChase.h"
 #include "CameraFPV.h"
+#include "ChangeList.h"
+#include "GameObject.h"
+#include "InputEvent.h"
 #include "LightDirectional.h"
+#include "Model.h"
+#include "PhysicsDebugDrawer.h"
 #include "PhysicsEngine.h"
+#include "RenderQueue.h"
 #include "ShaderProgram.h"
 #include "ShadowMap.h"
 #include "Skybox.h"
+#include "TripleBuffer.h"
 #include "UniformBuffer.h"
 
 namespace age {
@@ -23,7 +35,47 @@ struct Ray {
     glm::vec3 direction;
 };
 
-class GameObject;
+///
+/// \brief Render-relevant state of the game world captured after a simulation tick.
+///
+/// Snapshots are written by the simulation and only read by the renderer so that rendering never
+/// touches state that the simulation may be modifying concurrently. Game objects are drawn from
+/// the render state captured into their pose, which the renderer only completes with the blended
+/// model.
+///
+struct WorldSnapshot {
+    struct GameObjectPose {
+        GameObject *gameObject = nullptr;
+        Model previousModel;
+        Model model;
+        GameObject::RenderState renderState;
+    };
+
+    unsigned long id = 0ul; ///< Increases with every published snapshot
+
+    /// Poses of the world list's game objects at the same indices
+    std::vector<GameObjectPose> gameObjects;
+
+    /// Bounds of the bounded game objects enclosing their poses blended between the last two
+    /// ticks. Game objects without bounds are listed separately as they are never culled.
+    AABBTree spatialIndex;
+    std::vector<AABBTree::Proxy> proxies; ///< AABBTree::NULL_PROXY for game objects without bounds
+    std::vector<GameObject*> unboundedGameObjects;
+    std::unique_ptr<CameraType> cam;
+    std::unique_ptr<LightDirectional> directionalLight;
+
+    /// Empty unless the physics debug drawer is enabled
+    std::vector<PhysicsDebugDrawer::Line> physicsDebugLines;
+};
+
+///
+/// \brief Number of game objects of the world list that were drawn or culled by a render pass
+///        during the last frame. Hidden game objects count as culled.
+///
+struct CullingStats {
+    unsigned int numVisible = 0u;
+    unsigned int numCulled = 0u;
+};
 
 /**
  * Users should subclass Game
@@ -42,8 +94,49 @@ public:
 
     virtual void onWindowChanged(int width, int height, int displayRotation);
 
+    ///
+    /// Advances the game by one fixed simulation tick.
+    ///
+    /// With GameEngine::setSimulationThreaded() this runs on the simulation thread, which has no
+    /// GL context. Game objects that create GL objects, e.g. ones loaded from model files, must
+    /// then be created in onCreate() or on the rendering thread instead. GL calls on other
+    /// threads fail assertions in debug builds.
+    ///
+    /// \param updateDuration Duration of a simulation tick.
+    ///
     virtual void onUpdate(std::chrono::duration<float> updateDuration);
-    virtual void render();
+
+    ///
+    /// Renders the current frame.
+    /// \param interpolation Fraction of a simulation tick elapsed since the last Game::onUpdate,
+    ///                      used to blend game objects between their last two ticked poses.
+    ///
+    virtual void render(float interpolation);
+
+    ///
+    /// Brings the world snapshot up to date with the game objects that changed since the last
+    /// update. The renderer reads this snapshot directly, so nothing is copied. This is invoked by
+    /// the GameEngine after simulation ticks when the simulation is not threaded.
+    ///
+    void updateSnapshot();
+
+    ///
+    /// Captures the render-relevant state of the world into a WorldSnapshot and hands it over to
+    /// the renderer on another thread. Only the game objects that changed since the snapshot was
+    /// last written are copied. This is invoked by the GameEngine after ticks of the simulation
+    /// thread.
+    ///
+    void publishSnapshot();
+
+    ///
+    /// Processes the input received since the last frame. Touch events contain every pointer and
+    /// every sample of a move in order, while consecutive joystick samples are coalesced into the
+    /// latest one.
+    ///
+    /// The base implementation forwards the touch events of the first pointer to the
+    /// onTouch...Event() functions, skipping move samples that are followed by another one.
+    ///
+    virtual void onInput(const std::vector<InputEvent> &events);
 
     virtual bool onTouchDownEvent(float x, float y);
     virtual bool onTouchMoveEvent(float x, float y);
@@ -51,6 +144,28 @@ public:
     
     void enablePhysicsDebugDrawer(bool enable);
 
+    ///
+    /// Runs GameObject::onUpdate() and GameObject::updateFromPhysics() of the game objects in the
+    /// world list in parallel on the JobSystem. Only enable this if these functions only modify
+    /// the game object they are invoked on.
+    ///
+    void enableParallelUpdate(bool enable);
+
+    ///
+    /// Tests the bounds of game objects in the world list against the camera frustum in the
+    /// world pass and against the directional light's volume in the shadow pass and skips the
+    /// game objects that are outside of them. Enabled by default.
+    ///
+    void enableFrustumCulling(bool enable);
+
+    const CullingStats& getWorldPassCullingStats() const;
+    const CullingStats& getShadowPassCullingStats() const;
+
+    ///
+    /// Number of draws and GL state changes of the world pass during the last frame.
+    ///
+    const RenderQueue::Stats& getWorldPassRenderStats() const;
+
 protected:
     void setGravity(const glm::vec3 &gravity);
 
@@ -62,6 +177,12 @@ protected:
     void bindToProjectionViewUBO(ShaderProgram *shaderProgram);
     void bindToLightSpaceUBO(ShaderProgram *shaderProgram);
 
+    ///
+    /// Links the ObjectUB uniform block of a shader (see ObjectUniformBlock) to the per item
+    /// uniforms that the render queues stream each frame.
+    ///
+    void bindToObjectUBO(ShaderProgram *shaderProgram);
+
     ///
     /// Registers a GameObject with the physics engine. This is automatically called for game
     /// objects that are registered to the world list through Game::addToWorldList(). This must be
@@ -72,11 +193,42 @@ protected:
     void registerPhysics(GameObject *gameObject);
 
     void unregisterPhysics(GameObject *gameObject);
+
+    ///
+    /// Invokes function(GameObject*) for the game objects of the world list that may overlap
+    /// bounds without visiting every game object. Game objects without bounds are not reported.
+    /// The spatial index is updated when a snapshot is published, so game objects that were added
+    /// or moved since then may be missed or reported although they no longer overlap bounds.
+    ///
+    template <typename Function>
+    void queryWorldList(const AABB &bounds, const Function &function) const;
     
     virtual void onGameObjectTouched(GameObject *gameObject, const glm::vec3 &touchPoint,
                                      const glm::vec3 &touchDirection, const glm::vec3 &touchNormal);
 
+    ///
+    /// Acquires the most recently published WorldSnapshot for rendering and blends its game
+    /// objects between their last two ticked poses. The game objects are then drawn from their
+    /// render state in the snapshot. This must be called on the rendering thread before any of
+    /// the render functions below.
+    ///
+    void acquireSnapshot(float interpolation);
+
+    ///
+    /// Refreshes the camera and light of the acquired snapshot from their current state. The
+    /// caller must hold GameEngine::lockSimulation().
+    ///
+    void updateSnapshotView();
+
     virtual void updateUBOs();
+
+    ///
+    /// Fills the render queues of the shadow and world pass with the visible game objects of
+    /// the acquired snapshot and uploads their per item uniforms. This must be called after
+    /// Game::updateUBOs() and before the passes are rendered.
+    ///
+    void prepareRenderQueues();
+
     void renderShadowMapSetup();
     void renderShadowMap();
     void renderWorldSetup();
@@ -84,6 +236,14 @@ protected:
 
     void bindShadowMap(ShaderProgram *shaderProgram);
 
+    ///
+    /// Adds custom draws to the world pass in addition to the visible game objects of the world
+    /// list. Items are sorted together with the game objects' draws. Items with a shader other
+    /// than the default shader must have had their per frame uniforms set. The base
+    /// implementation adds nothing.
+    ///
+    virtual void submitRenderItems(RenderQueue *queue);
+
     CameraType* getCam();
     LightDirectional* getDirectionalLight();
 
@@ -91,6 +251,22 @@ private:
     void raycastTouch(const glm::vec2 &windowTouchPosition, float length);
     Ray getTouchRay(const glm::vec2 &windowTouchPosition);
 
+    template <typename Function>
+    void forEachInWorldList(const Function &function);
+
+    ///
+    /// Records the physics debug lines into a snapshot if the physics debug drawer is enabled.
+    ///
+    void drawPhysicsDebug(WorldSnapshot *snapshot);
+
+    ///
+    /// Invokes function(GameObject*) for the game objects of the acquired snapshot that
+    /// intersect the frustum and records the number of visible and culled game objects.
+    ///
+    template <typename Function>
+    void forEachVisibleInSnapshot(const Frustum &frustum, CullingStats *stats,
+                                  const Function &function);
+
     ShaderProgram shadowMapShader;
     ShaderProgram defaultShader;
     ShaderProgram skyboxShader;
@@ -98,6 +274,7 @@ private:
 
     UniformBuffer projectionViewUbo;
     UniformBuffer lightSpaceUbo;
+    UniformBufferRing objectUboRing;
 
     int shadowMapTextureUnit; // Shadow map is placed as the last texture unit to deconflict with game object material textures
     
@@ -106,12 +283,52 @@ private:
     std::unique_ptr<LightDirectional> directionalLight;
     std::unique_ptr<ShadowMap> shadowMap;
     std::vector<std::shared_ptr<GameObject>> worldList;
+
+    /// Indices of the world list's game objects that changed since the last snapshot
+    ChangeList worldListChanges;
+
+    /// Snapshot of the world kept up to date by the simulation, whose spatial index serves
+    /// Game::queryWorldList(). It is rendered directly unless the simulation is threaded.
+    WorldSnapshot simulationSnapshot;
     
     std::unique_ptr<PhysicsEngine> physics;
     bool drawDebugPhysics;
+    bool parallelUpdate;
+    bool frustumCulling;
+
+    CullingStats worldPassCullingStats;
+    CullingStats shadowPassCullingStats;
+
+    RenderQueue shadowPassQueue;
+    RenderQueue worldPassQueue;
+
+    TripleBuffer<WorldSnapshot> snapshots;
+    std::atomic<bool> snapshotsPublished; ///< Whether the renderer reads the triple buffer
+    WorldSnapshot *renderSnapshot;
+    unsigned long nextSnapshotId;
+
+    /// Indices of the game objects that changed in the snapshots published after
+    /// changeLogStartId, which the older snapshots of the triple buffer are brought up to date
+    /// with. Snapshots that are older still are rebuilt.
+    std::deque<std::pair<unsigned long, unsigned int>> changeLog;
+    unsigned long changeLogStartId;
+
+    /// Game objects removed from the world list along with the id of the first snapshot that no
+    /// longer references them. They are destroyed on the rendering thread once that snapshot
+    /// has been acquired.
+    std::mutex removedGameObjectsMutex;
+    std::vector<std::pair<unsigned long, std::shared_ptr<GameObject>>> removedGameObjects;
 };
 
 inline CameraType* Game::getCam() {return this->cam.get();}
 inline LightDirectional* Game::getDirectionalLight() {return this->directionalLight.get();}
+inline const CullingStats& Game::getWorldPassCullingStats() const {return this->worldPassCullingStats;}
+inline const CullingStats& Game::getShadowPassCullingStats() const {return this->shadowPassCullingStats;}
+inline const RenderQueue::Stats& Game::getWorldPassRenderStats() const {return this->worldPassQueue.getStats();}
+
+template <typename Function>
+void Game::queryWorldList(const AABB &bounds, const Function &function) const {
+    this->simulationSnapshot.spatialIndex.query(bounds, function);
+}
 
 } // namespace age
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include <arcore_c_api.h>
 
 #include "ARCameraBackground.h"
+#include "GameEngine.h"
 #include "ShaderProgram.h"
 
 namespace age {
@@ -17,6 +18,13 @@ class ARPlane;
 
 class GameAR : public Game {
 public:
+    /// Ids of the events posted to the Java Activity through GameEngine::postJavaActivityEvent().
+    /// Subclasses number their own events from LAST_EVENT + 1.
+    enum Event : int {
+        AR_PLANE_INITIALIZED_EVENT = 1, ///< The floor plane was found
+        LAST_EVENT = AR_PLANE_INITIALIZED_EVENT
+    };
+
     GameAR();
     ~GameAR();
 
@@ -26,8 +34,7 @@ public:
 
     void onWindowChanged(int width, int height, int displayRotation) override;
 
-    void onUpdate(std::chrono::duration<float> updateDuration) override;
-    void render() override;
+    void render(float interpolation) override;
 
     bool onTouchDownEvent(float x, float y) override;
     bool onTouchMoveEvent(float x, float y) override;
@@ -47,6 +54,7 @@ protected:
     float getFloorAltitude() const;
 
 private:
+    void updateARFrame();
     void updateCamera();
     void updatePlanes();
     void updateDirectionalLight();
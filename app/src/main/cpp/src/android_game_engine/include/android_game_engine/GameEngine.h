@@ -1,8 +1,11 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <string>
 
+#ifdef __ANDROID__
 #include <jni.h>
 
 /**
@@ -16,14 +19,16 @@
 
 #define JNI_METHOD_DECLARATION(return_type, method_name) \
     JNIEXPORT JNI_METHOD_DEFINITION(return_type, method_name)
+#endif
 
 namespace age {
 
 class Game;
+struct InputEvent;
 
 /**
 * Singleton game manager and C++ program entry point. Game callbacks should be run solely on the
- * rendering thread.
+ * rendering thread, with the exception of Game::onUpdate when the simulation is threaded.
 */
 namespace GameEngine {
 
@@ -31,11 +36,24 @@ extern
 
 Game *getGame();
 
+/**
+ * Prepares the engine for a newly created GL context. The game and the resources of a previous
+ * context, e.g. cached textures and shader programs, are released.
+ *
+ * This must be invoked on the rendering thread before the Game for the new surface is constructed,
+ * since Game constructors already create GL objects and change GL state, e.g.:
+ *      age::GameEngine::onContextCreated();
+ *      age::GameEngine::onSurfaceCreated(width, height, displayRotation,
+ *                                        std::make_unique<MyGame>());
+ */
+void onContextCreated();
+
 /**
  * Main entry point for creating and initializing the game.
  *
  * This should be invoked by the onSurfaceCreated JNI C++ call which in turn should be invoked by
- * GLSurfaceView.Renderer.onSurfaceCreated method.
+ * GLSurfaceView.Renderer.onSurfaceCreated method. On the host it is invoked by the headless runner
+ * once its GL context is current.
  *
  * Upon passing in a specialized instance of Game to the parameter 'g', the GameEngine will take
  * over managing the game as well as invoking the following callbacks for the Game via JNI:
@@ -46,11 +64,9 @@ Game *getGame();
  *      - Game::onStop
  *      - Game::onDestroy
  *      - Game::onWindowChanged
- *      - Game::update
+ *      - Game::onUpdate
  *      - Game::render
- *      - Game::onTouchDownEvent
- *      - Game::onTouchMoveEvent
- *      - Game::onTouchUpEvent
+ *      - Game::onInput
  *
  * To create further callbacks via JNI, use the provided JNI_METHOD_DECLARATION and
  * JNI_METHOD_DEFINITION macros along with the getGame() function.
@@ -62,17 +78,160 @@ Game *getGame();
  */
 void onSurfaceCreated(int width, int height, int displayRotation, std::unique_ptr<Game> &&g);
 
+/**
+ * Sets the fixed rate at which Game::onUpdate is ticked.
+ *
+ * The simulation is advanced in fixed steps of 1 / ticksPerSecond regardless of the display
+ * frame rate. Game::render is invoked once per frame with the fraction of a tick left over so
+ * that GameObject transforms can be blended between the last two ticks.
+ *
+ * @param ticksPerSecond Simulation ticks per second (default: 60)
+ */
+void setTickRate(float ticksPerSecond);
+
+/**
+ * Caps the number of simulation ticks that are run within a single frame to catch up with real
+ * time. Any time beyond the cap is dropped so that one slow frame cannot snowball into
+ * progressively slower frames.
+ *
+ * @param maxTicks Maximum simulation ticks per frame (default: 5)
+ */
+void setMaxTicksPerFrame(unsigned int maxTicks);
+
+/**
+ * Runs Game::onUpdate on a dedicated native thread instead of the rendering thread.
+ *
+ * After every tick the simulation publishes a WorldSnapshot that Game::render draws from so that
+ * rendering never waits on the simulation. This takes effect the next time the game is resumed,
+ * so it is best called from Game::onCreate.
+ *
+ * @param threaded Whether to run the simulation on its own thread (default: false)
+ */
+void setSimulationThreaded(bool threaded);
+
+/**
+ * Blocks the simulation thread from ticking while the returned lock is held.
+ *
+ * Game state that is modified outside of Game::onUpdate, e.g. from JNI callbacks, must only be
+ * modified while holding this lock. Without a simulation thread this lock is uncontended.
+ */
+std::unique_lock<std::mutex> lockSimulation();
+
+/**
+ * Platform lifecycle callbacks. On Android these are invoked by the Java Activity through the JNI
+ * while other platforms, e.g. the headless runner on the host, invoke them directly.
+ */
+void onStart();
+void onResume();
+void onPause();
+void onStop();
+void onDestroy();
+void onWindowChanged(int width, int height, int displayRotation);
+
+/**
+ * Runs the simulation ticks that are due since the last frame and renders a frame. This must be
+ * invoked once per display frame on the rendering thread.
+ */
+void update();
+
+/**
+ * Same as update() except that the simulation is advanced by frameDuration instead of the time
+ * that actually passed since the last frame, which makes runs reproducible regardless of how
+ * fast frames are rendered. A threaded simulation ignores frameDuration as it always ticks in
+ * real time.
+ *
+ * @param frameDuration Time to advance the simulation by
+ */
+void update(std::chrono::duration<float> frameDuration);
+
+/**
+ * Checks whether all shader programs finished building as of the start of the frame.
+ *
+ * Shader programs are built in the background, see ProgramBuilder. Until they are, frames are
+ * rendered without the draws of the programs that are not ready, e.g. a game may show a load
+ * screen until this returns true.
+ */
+bool areShadersReady();
+
+/**
+ * Queues an input event to be passed to Game::onInput before the next frame is rendered. Events
+ * must only be pushed from a single thread at a time, e.g. the UI thread.
+ *
+ * @return False if the queue is full and the event was dropped
+ */
+bool pushInputEvent(const InputEvent &event);
+
+#ifdef __ANDROID__
 JNIEnv *getJNIEnv();
 
 jobject getJavaActivity();
 jobject getJavaAppContext();
 
+/**
+ * Method of the owning Java Activity whose ID is resolved once when the native library is loaded.
+ * Instances must have static storage duration so that they exist by the time JNI_OnLoad runs, e.g.
+ *      const age::GameEngine::JavaActivityMethod scoreChanged("scoreChanged", "(I)V");
+ *
+ * Calls of methods that the Java Activity does not implement are dropped.
+ */
+class JavaActivityMethod {
+public:
+    /**
+     * @param name Java Activity method name
+     * @param signature Java Activity method JNI signature
+     */
+    JavaActivityMethod(const char *name, const char *signature);
+
+    JavaActivityMethod(const JavaActivityMethod &) = delete;
+    JavaActivityMethod& operator=(const JavaActivityMethod &) = delete;
+
+    /**
+     * Looks up the method ID in the Java Activity class. Invoked by JNI_OnLoad.
+     */
+    void resolve(JNIEnv *env, jclass activityClass);
+
+    /**
+     * @return The method ID or nullptr if the Java Activity does not implement the method
+     */
+    jmethodID getId() const;
+
+private:
+    const char *name;
+    const char *signature;
+    jmethodID id;
+};
+
 /**
  * Makes calls to the owning Java Activity through the JNI
- * @param methodName Java Activity method name to invoke
- * @param signature Java Activity method JNI signature
+ * @param method Java Activity method
+ * @param args JNI typed arguments (jint, jfloat, jboolean, jobject...) matching the method's
+ *             signature
  */
-void callJavaActivityVoidMethod(const std::string &methodName, const std::string &signature);
+template <typename... Args>
+void callJavaActivityVoidMethod(const JavaActivityMethod &method, Args... args);
+
+/**
+ * Queues an event for the owning Java Activity. This may be called from any thread.
+ *
+ * Events posted during a frame are delivered together after Game::render through a single call
+ * to the Activity method:
+ *      fun onNativeEvents(events: ByteBuffer, numEvents: Int)
+ *
+ * Each event occupies 16 bytes in native byte order: an Int id followed by 3 Float values. The
+ * buffer is reused every frame so it must be read before onNativeEvents returns. Events are
+ * dropped if the Activity does not implement onNativeEvents or more than 256 events are posted
+ * within a frame.
+ */
+void postJavaActivityEvent(int id, float value0 = 0.0f, float value1 = 0.0f, float value2 = 0.0f);
+
+inline jmethodID JavaActivityMethod::getId() const {return this->id;}
+
+template <typename... Args>
+void callJavaActivityVoidMethod(const JavaActivityMethod &method, Args... args) {
+    if (method.getId() == nullptr) return;
+    getJNIEnv()->CallVoidMethod(getJavaActivity(), method.getId(), args...);
+}
+#endif
 
 } // namespace GameEngine
 } // namespace age
\ No newline at end of file
@@ -7,12 +7,15 @@
 #include <BulletCollision/CollisionShapes/btCollisionShape.h>
 #include <glm/fwd.hpp>
 
+#include "AABB.h"
+#include "ChangeList.h"
 #include "Mesh.h"
 #include "Model.h"
 #include "PhysicsRigidBody.h"
 
 namespace age {
 
+class RenderQueue;
 class ShaderProgram;
 
 ///
@@ -21,12 +24,30 @@ class ShaderProgram;
 class GameObject {
 public:
     using Meshes = std::vector<Mesh>;
+
+    ///
+    /// \brief Render-relevant state of a game object.
+    ///
+    /// The Game captures this into its WorldSnapshot whenever the game object changes, so that
+    /// the game object is drawn from a consistent copy while it may be modified concurrently.
+    ///
+    struct RenderState {
+        Model model; ///< Pose blended between the last two ticks by the renderer
+        std::shared_ptr<Meshes> meshes;
+        glm::vec3 unscaledDimensions {0.0f};
+        glm::vec3 color {1.0f};
+        float specularExponent = 32.0f;
+        bool visible = true;
+    };
     
     GameObject();
     
     ///
     /// \brief GameObject Loads vertex and texture data and creates a model
     ///                   for the game object.
+    ///
+    /// Game objects of the same model file share its meshes through the ResourceCache.
+    ///
     /// \param modelFilepath Filepath to the model data.
     /// \exception ge::LoadError Failed to load mesh data from model file.
     /// \exception ge::LoadError Failed to load texture image from file.
@@ -53,10 +74,74 @@ public:
     
     virtual void updateFromPhysics();
 
-    void renderShadow(ShaderProgram *shader);
-    virtual void render(ShaderProgram *shader);
+    ///
+    /// \brief storePreviousTransform Records the current pose as the pose of the previous
+    ///                               simulation tick.
+    ///
+    /// This is called by Game at the start of every tick for objects in the world list.
+    ///
+    void storePreviousTransform();
+
+    ///
+    /// \brief captureRenderState Copies the state needed to draw the game object at its current
+    ///                           pose.
+    ///
+    RenderState captureRenderState() const;
+
+    ///
+    /// \brief setRenderState Sets the state that the game object is drawn from.
+    ///
+    /// This is called by Game on the rendering thread with the state captured in its acquired
+    /// WorldSnapshot before rendering objects in the world list. The state must stay valid
+    /// until the frame is rendered.
+    ///
+    virtual void setRenderState(const RenderState *state);
+    const RenderState* getRenderState() const;
+
+    const Model& getModel() const;
+
+    ///
+    /// \brief getPreviousModel Returns the pose of the previous simulation tick or the current
+    ///                         pose if the game object has not been ticked yet.
+    ///
+    const Model& getPreviousModel() const;
+
+    ///
+    /// \brief submitShadowItems Adds a depth only draw of every mesh of the render state to
+    ///                          queue.
+    ///
+    virtual void submitShadowItems(RenderQueue *queue, ShaderProgram *shader);
+
+    ///
+    /// \brief submitRenderItems Adds a draw of every mesh of the render state to queue.
+    ///
+    /// This is how the game objects of the world list are drawn. Subclasses that draw
+    /// themselves differently should override this along with
+    /// GameObject::submitShadowItems().
+    ///
+    virtual void submitRenderItems(RenderQueue *queue, ShaderProgram *shader);
+
+    ///
+    /// \brief requestTextureSize Requests the mip levels of the textures of every mesh of the
+    ///                           render state for drawing the game object this frame, see
+    ///                           Texture2D::requestSize().
+    /// \param screenSize_pixels Size that the game object covers on the screen.
+    ///
+    void requestTextureSize(float screenSize_pixels);
     
     void setMesh(std::shared_ptr<Meshes> mesh);
+    std::shared_ptr<Meshes> getMesh() const;
+
+    ///
+    /// \brief setVisible Sets whether the game object is drawn when it is in the world list.
+    ///
+    /// Hidden game objects are still simulated, e.g. game objects whose meshes are drawn
+    /// through a StaticBatch.
+    ///
+    /// \param visible Whether to draw the game object (default: true)
+    ///
+    void setVisible(bool visible);
+    bool isVisible() const;
     
     glm::mat4 getModelMatrix() const;
     
@@ -137,8 +222,57 @@ public:
     void setScale(const glm::vec3 &scale);
     
     glm::vec3 getScaledDimensions() const;
+
+    ///
+    /// \brief hasBounds Returns whether the game object's dimensions are known.
+    ///
+    /// Game objects without dimensions, e.g. ones created from a mesh through setMesh(), have no
+    /// bounds and must never be culled.
+    ///
+    bool hasBounds() const;
+
+    ///
+    /// \brief getWorldBounds Returns the box enclosing the game object in its current pose.
+    ///
+    AABB getWorldBounds() const;
+
+    ///
+    /// \brief hasRenderBounds Returns whether the dimensions of the render state are known.
+    ///
+    bool hasRenderBounds() const;
+
+    ///
+    /// \brief getRenderBounds Returns the box enclosing the game object in the render state.
+    ///
+    AABB getRenderBounds() const;
+
+    ///
+    /// \brief getSweptBounds Returns a box enclosing the game object in any pose blended between
+    ///                       its previous and current pose.
+    ///
+    AABB getSweptBounds() const;
+
+    ///
+    /// \brief trackChanges Adds index to changes whenever the game object's previous or current
+    ///                     pose, its dimensions or its render state change. Game objects of
+    ///                     the world list are tracked by the Game.
+    /// \param changes List to add the changes to or nullptr to stop tracking the game object.
+    ///
+    void trackChanges(ChangeList *changes, unsigned int index);
     
     void setSpecularExponent(float specularExponent);
+    float getSpecularExponent() const;
+
+    ///
+    /// \brief setColor Tints the diffuse textures of the game object's meshes.
+    ///
+    /// Game objects that only differ in color share their draw calls, unlike game objects
+    /// with diffuse textures of different solid colors.
+    ///
+    /// \param color RGB values between 0.0 and 1.0 (default: white)
+    ///
+    void setColor(const glm::vec3 &color);
+    glm::vec3 getColor() const;
     
     PhysicsRigidBody* getPhysicsBody();
     
@@ -165,20 +299,33 @@ protected:
     void setUnscaledDimensions(const glm::vec3 &dimensions);
     
 private:
-    void processNode(const aiNode *node, const aiScene *scene, const std::string &dir);
+    void markMoved();
+    void reportChange();
 
     std::string label;
     Model model;
-    glm::vec3 unscaledDimensions;
+    Model previousModel;
+    const RenderState *renderState = nullptr;
+    bool hasPreviousModel = false;
+    bool moved = false;
+    ChangeList *changes = nullptr;
+    unsigned int changeIndex = 0u;
+    glm::vec3 unscaledDimensions {0.0f};
     
     std::shared_ptr<Meshes> meshes;
+    bool visible = true;
     float specularExponent = 32.0f;
+    glm::vec3 color {1.0f};
     
     std::unique_ptr<PhysicsRigidBody> physicsBody = nullptr;
 };
 
 inline void GameObject::setLabel(const std::string &label) {this->label = label;}
 inline std::string GameObject::getLabel() const {return this->label;}
+inline void GameObject::setRenderState(const RenderState *state) {this->renderState = state;}
+inline const GameObject::RenderState* GameObject::getRenderState() const {return this->renderState;}
+inline const Model& GameObject::getModel() const {return this->model;}
+inline const Model& GameObject::getPreviousModel() const {return this->hasPreviousModel ? this->previousModel : this->model;}
 inline glm::mat4 GameObject::getModelMatrix() const {return this->model.getModelMatrix();}
 inline glm::mat3 GameObject::getNormalMatrix() const {return this->model.getNormalMatrix();}
 inline glm::mat4 GameObject::getViewMatrix() const {return this->model.getViewMatrix();}
@@ -189,7 +336,17 @@ inline glm::vec3 GameObject::getOrientationY() const {return this->model.getOrie
 inline glm::vec3 GameObject::getOrientationZ() const {return this->model.getOrientationZ();}
 inline glm::vec3 GameObject::getLookAtDirection() const {return this->model.getLookAtDirection();}
 inline glm::vec3 GameObject::getNormalDirection() const {return this->model.getNormalDirection();}
+inline std::shared_ptr<GameObject::Meshes> GameObject::getMesh() const {return this->meshes;}
+inline void GameObject::setVisible(bool visible) {this->visible = visible; this->reportChange();}
+inline bool GameObject::isVisible() const {return this->visible;}
 inline glm::vec3 GameObject::getScaledDimensions() const {return this->unscaledDimensions * this->model.getScale();}
+inline void GameObject::markMoved() {this->moved = true; this->reportChange();}
+inline void GameObject::reportChange() {if (this->changes != nullptr) this->changes->add(this->changeIndex);}
+inline bool GameObject::hasBounds() const {return this->unscaledDimensions != glm::vec3(0.0f);}
+inline bool GameObject::hasRenderBounds() const {return this->renderState->unscaledDimensions != glm::vec3(0.0f);}
+inline float GameObject::getSpecularExponent() const {return this->specularExponent;}
+inline void GameObject::setColor(const glm::vec3 &color) {this->color = color; this->reportChange();}
+inline glm::vec3 GameObject::getColor() const {return this->color;}
 inline float GameObject::getMass() const {return this->physicsBody->getMass();}
 inline void GameObject::applyCentralForce(const glm::vec3 &force) {this->physicsBody->applyCentralForce(force);}
 inline void GameObject::applyTorque(const glm::vec3 &torque) {this->physicsBody->applyTorque(torque);}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "VertexLayout.h"
+
+namespace age {
+
+///
+/// \brief Stores the vertices and indices of many vertex arrays of the same layout in a single
+///        vertex array object with one vertex and one index buffer.
+///
+/// Vertex arrays are sub-allocated ranges of the buffers and are drawn with a base vertex so
+/// that draws of different meshes share the vertex array object binding. Index ranges may hold
+/// 16 or 32 bit indices. The buffers grow as needed, which compacts the live allocations, and
+/// may be compacted with defragment().
+///
+/// Arenas are only used on the rendering thread. There is one arena per vertex layout while any
+/// vertex array of the layout exists.
+///
+class GeometryArena {
+public:
+    ///
+    /// \brief Vertex and index range of a vertex array. Ranges move when the arena is compacted.
+    ///
+    struct Allocation {
+        unsigned int baseVertex;
+        unsigned int numVertices;
+        std::size_t indexOffset_bytes;
+        std::size_t indexSize_bytes;
+
+    private:
+        friend class GeometryArena;
+        std::size_t slot;
+    };
+
+    struct Stats {
+        unsigned int numAllocations = 0u;
+
+        std::size_t vertexCapacity_bytes = 0u;
+        std::size_t vertexUsed_bytes = 0u;
+        std::size_t vertexLargestFree_bytes = 0u;
+        unsigned int numVertexFreeRanges = 0u;
+
+        std::size_t indexCapacity_bytes = 0u;
+        std::size_t indexUsed_bytes = 0u;
+        std::size_t indexLargestFree_bytes = 0u;
+        unsigned int numIndexFreeRanges = 0u;
+
+        /// Number of times the buffers were compacted, including when they grew
+        unsigned int numCompactions = 0u;
+
+        ///
+        /// \brief getVertexFragmentation Returns the share of the free vertex memory that is not
+        ///                               part of the largest free range.
+        ///
+        float getVertexFragmentation() const;
+        float getIndexFragmentation() const;
+    };
+
+    ///
+    /// \brief get Returns the arena of the layout and creates it if it does not exist.
+    ///
+    static std::shared_ptr<GeometryArena> get(const VertexLayout &layout);
+
+    ///
+    /// \brief getArenas Returns the arenas of all layouts.
+    ///
+    static std::vector<std::shared_ptr<GeometryArena>> getArenas();
+
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena &) = delete;
+    GeometryArena& operator=(const GeometryArena &) = delete;
+
+    ///
+    /// \brief allocate Copies vertices and indices into the arena.
+    /// \param vertexData Vertices in the layout of the arena.
+    /// \param numVertices Number of vertices.
+    /// \param indexData Indices relative to the first vertex.
+    /// \param indexSize_bytes Size of the indices.
+    /// \return Ranges of the data. They are valid until they are freed.
+    ///
+    Allocation* allocate(const void *vertexData, unsigned int numVertices,
+                         const void *indexData, std::size_t indexSize_bytes);
+
+    void free(Allocation *allocation);
+
+    ///
+    /// \brief defragment Moves the allocations to the start of the buffers so that the free
+    ///                   memory is contiguous.
+    ///
+    void defragment();
+
+    ///
+    /// \brief bind Binds the vertex array object of the arena.
+    ///
+    void bind();
+
+    unsigned int getVertexArrayId() const;
+    unsigned int getVertexBuffer() const;
+    unsigned int getIndexBuffer() const;
+    const VertexLayout& getLayout() const;
+
+    Stats getStats() const;
+
+private:
+    ///
+    /// \brief First fit allocator of ranges with coalescing of adjacent free ranges.
+    ///
+    class FreeList {
+    public:
+        void reset(std::size_t capacity, std::size_t used);
+        bool allocate(std::size_t size, std::size_t *offset);
+        void free(std::size_t offset, std::size_t size);
+
+        std::size_t getCapacity() const;
+        std::size_t getUsed() const;
+        std::size_t getLargestFree() const;
+        std::size_t getNumFreeRanges() const;
+
+    private:
+        std::map<std::size_t, std::size_t> freeRanges; ///< Sizes by offset
+        std::size_t capacity = 0u;
+        std::size_t used = 0u;
+    };
+
+    explicit GeometryArena(const VertexLayout &layout);
+
+    ///
+    /// \brief reallocate Copies the allocations into new buffers of the given capacities and
+    ///                   packs them at their start.
+    ///
+    void reallocate(std::size_t vertexCapacity, std::size_t indexCapacity_bytes);
+
+    VertexLayout layout;
+    unsigned int vertexStride;
+
+    unsigned int vao;
+    unsigned int vbo;
+    unsigned int ebo;
+
+    FreeList vertexRanges; ///< In vertices
+    FreeList indexRanges;  ///< In bytes
+
+    std::vector<std::unique_ptr<Allocation>> allocations;
+    unsigned int numCompactions = 0u;
+};
+
+inline unsigned int GeometryArena::getVertexArrayId() const {return this->vao;}
+inline unsigned int GeometryArena::getVertexBuffer() const {return this->vbo;}
+inline unsigned int GeometryArena::getIndexBuffer() const {return this->ebo;}
+inline const VertexLayout& GeometryArena::getLayout() const {return this->layout;}
+
+inline std::size_t GeometryArena::FreeList::getCapacity() const {return this->capacity;}
+inline std::size_t GeometryArena::FreeList::getUsed() const {return this->used;}
+inline std::size_t GeometryArena::FreeList::getNumFreeRanges() const {return this->freeRanges.size();}
+
+} // namespace age
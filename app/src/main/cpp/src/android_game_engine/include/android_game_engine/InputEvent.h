@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+namespace age {
+
+///
+/// \brief An input sample delivered to Game::onInput().
+///
+/// The memory layout is shared with InputEventBuffer.kt which writes the events on the UI thread.
+///
+struct InputEvent {
+    enum class Type : std::int32_t {
+        TOUCH_DOWN,
+        TOUCH_MOVE,
+        TOUCH_UP,
+        JOYSTICK
+    };
+
+    Type type;
+    std::int32_t source;        ///< Touch pointer ID or joystick index
+    float x;                    ///< Window position (px) or joystick axis in [-1, 1]
+    float y;                    ///< Window position (px) or joystick axis in [-1, 1]
+    std::int64_t timestamp_ns;  ///< Event time in the time base of SystemClock.uptimeMillis()
+};
+
+static_assert(sizeof(InputEvent) == 24, "InputEvent layout must match InputEventBuffer.kt");
+
+} // namespace age
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "GameObject.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace age {
+
+///
+/// \brief Draws many copies of the same meshes that are not simulated individually, e.g.
+///        vegetation, debris or crowds.
+///
+/// Each instance has its own pose and color. The instances of every mesh are drawn together
+/// through instanced draw calls by the render queues. Only the instances are drawn and not the
+/// game object itself. The instances have no physics and are not culled individually.
+///
+/// Instances may be changed on the simulation thread while frames are rendered. Changes are
+/// picked up by the next rendered frame.
+///
+class InstancedGameObject : public GameObject {
+public:
+    ///
+    /// \brief InstancedGameObject Draws instances of meshes.
+    /// \param meshes Meshes to instance, e.g. the meshes of another game object obtained through
+    ///               GameObject::getMesh().
+    ///
+    explicit InstancedGameObject(std::shared_ptr<Meshes> meshes);
+
+    ///
+    /// \brief addInstance Adds an instance.
+    /// \param model Pose of the instance in the world coordinate frame.
+    /// \param color Tint of the diffuse textures of the instance.
+    /// \return Index of the instance.
+    ///
+    std::size_t addInstance(const Model &model, const glm::vec3 &color = glm::vec3(1.0f));
+
+    void setInstance(std::size_t i, const Model &model, const glm::vec3 &color = glm::vec3(1.0f));
+    void clearInstances();
+    std::size_t getNumInstances() const;
+
+    void setRenderState(const RenderState *state) override;
+
+    void submitShadowItems(RenderQueue *queue, ShaderProgram *shader) override;
+    void submitRenderItems(RenderQueue *queue, ShaderProgram *shader) override;
+
+private:
+    struct Instance {
+        Model model;
+        glm::vec3 color;
+    };
+
+    mutable std::mutex instancesMutex;
+    std::vector<Instance> instances;
+    bool instancesChanged = false;
+
+    /// Copy of the instances that is only accessed on the rendering thread
+    std::vector<Instance> renderInstances;
+};
+
+} // namespace age
@@ -0,0 +1,133 @@
+#pragma once
+
+/**
+ * Singleton work-stealing job system.
+ *
+ * Every worker thread owns a deque of jobs. Threads push and pop jobs at the back of their own
+ * deque and steal from the front of the other deques when they run out of work. Threads that
+ * are not workers (e.g. the rendering thread) share deque 0 and help execute jobs while they
+ * wait on a JobCounter.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace age {
+
+namespace JobSystem {
+using Job = std::function<void()>;
+} // namespace JobSystem
+
+///
+/// \brief Tracks the number of outstanding jobs in a group.
+///
+/// Jobs can be made to depend on a JobCounter through JobSystem::runAfter() in which case they
+/// are only scheduled once the counter drops to zero.
+///
+class JobCounter {
+public:
+    JobCounter() = default;
+
+    JobCounter(const JobCounter &) = delete;
+    JobCounter& operator=(const JobCounter &) = delete;
+
+    bool isDone() const;
+
+private:
+    friend void incrementJobCounter(JobCounter *counter);
+    friend void decrementJobCounter(JobCounter *counter);
+    friend bool addJobCounterDependent(JobCounter *counter, JobSystem::Job *job);
+
+    std::atomic<unsigned int> count {0u};
+
+    mutable std::mutex mutex;
+    std::vector<JobSystem::Job> dependents;
+};
+
+namespace JobSystem {
+
+///
+/// \brief init Starts the worker threads.
+///
+/// Until the job system is initialized all jobs are executed immediately on the calling thread.
+///
+/// \param numWorkerThreads Number of worker threads to start in addition to the calling thread.
+///                         Without it one worker is started per additional hardware thread.
+///
+void init(unsigned int numWorkerThreads);
+void init();
+void shutdown();
+
+///
+/// \brief getNumThreads Returns the number of threads executing jobs, including the thread that
+///                      initialized the job system.
+///
+unsigned int getNumThreads();
+
+///
+/// \brief run Schedules a job.
+/// \param job Job to execute.
+/// \param counter Optional counter that is incremented now and decremented once the job is done.
+///
+void run(Job job, JobCounter *counter = nullptr);
+
+///
+/// \brief runAfter Schedules a job once all jobs tracked by dependency are done.
+/// \param dependency Counter that must drop to zero before the job is scheduled.
+/// \param job Job to execute.
+/// \param counter Optional counter that is incremented now and decremented once the job is done.
+///
+void runAfter(JobCounter *dependency, Job job, JobCounter *counter = nullptr);
+
+///
+/// \brief wait Blocks until all jobs tracked by counter are done.
+///
+/// The calling thread executes other jobs while it waits so it is safe to wait from inside a job.
+///
+void wait(JobCounter *counter);
+
+///
+/// \brief parallelFor Invokes function(i) for every i in [begin, end) across all threads and
+///                    waits for them to finish.
+/// \param grainSize Number of consecutive indices processed by a single job.
+///
+template <typename Function>
+void parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function &function);
+
+///
+/// \brief parallelFor Invokes function(i) for every i in [begin, end) across all threads and
+///                    waits for them to finish, choosing a grain size that gives each thread a
+///                    few jobs to balance uneven work between fast and slow cores.
+///
+template <typename Function>
+void parallelFor(std::size_t begin, std::size_t end, const Function &function);
+
+template <typename Function>
+void parallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function &function) {
+    grainSize = std::max<std::size_t>(grainSize, 1u);
+
+    JobCounter counter;
+    for (auto first = begin; first < end; first += grainSize) {
+        const auto last = std::min(first + grainSize, end);
+        run([&function, first, last]{
+            for (auto i = first; i < last; ++i) {
+                function(i);
+            }
+        }, &counter);
+    }
+    wait(&counter);
+}
+
+template <typename Function>
+void parallelFor(std::size_t begin, std::size_t end, const Function &function) {
+    const auto jobsPerThread = 4u;
+    const auto numJobs = static_cast<std::size_t>(getNumThreads() * jobsPerThread);
+    parallelFor(begin, end, (end - begin + numJobs - 1u) / numJobs, function);
+}
+
+} // namespace JobSystem
+} // namespace age
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * Loading of KTX2 (Khronos Texture 2.0) files whose mip levels were block compressed offline
+ * with ETC2/EAC or ASTC, e.g. by texture_converter of the headless runner or by toktx. The
+ * compressed levels are uploaded to the GPU as is, without decoding or mipmap generation.
+ *
+ * Only files without supercompression are supported. ETC2/EAC and ASTC LDR are core in
+ * OpenGL ES 3.2.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace age {
+namespace KTX2 {
+
+/// Identifier at the start of every KTX2 file
+constexpr std::size_t IDENTIFIER_SIZE = 12u;
+extern const unsigned char IDENTIFIER[IDENTIFIER_SIZE];
+
+/// Sizes of the header and of an entry of the level index that follows it
+constexpr std::size_t HEADER_SIZE_bytes = 80u;
+constexpr std::size_t LEVEL_INDEX_ENTRY_SIZE_bytes = 24u;
+
+/// Vulkan formats of the block compressions as stored in the header
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK = 147u;
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK = 148u;
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK = 149u;
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK = 150u;
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK = 151u;
+constexpr std::uint32_t VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK = 152u;
+constexpr std::uint32_t VK_FORMAT_EAC_R11_UNORM_BLOCK = 153u;
+constexpr std::uint32_t VK_FORMAT_EAC_R11_SNORM_BLOCK = 154u;
+constexpr std::uint32_t VK_FORMAT_EAC_R11G11_UNORM_BLOCK = 155u;
+constexpr std::uint32_t VK_FORMAT_EAC_R11G11_SNORM_BLOCK = 156u;
+
+/// The 14 ASTC block sizes from 4x4 to 12x12, each as UNORM followed by SRGB
+constexpr std::uint32_t VK_FORMAT_ASTC_4x4_UNORM_BLOCK = 157u;
+constexpr std::uint32_t VK_FORMAT_ASTC_12x12_SRGB_BLOCK = 184u;
+
+///
+/// \brief Block compressed texture with all faces and mip levels.
+///
+struct Image {
+    /// Location of the data of all faces of a mip level
+    struct Level {
+        std::size_t offset_bytes;
+        std::size_t size_bytes;
+    };
+
+    std::uint32_t vkFormat;
+
+    /// Compressed OpenGL format of the data
+    unsigned int internalFormat;
+
+    int width;
+    int height;
+
+    /// 1 for 2D textures or 6 for cubemaps in the face order of OpenGL
+    unsigned int numFaces;
+
+    /// Mip levels from the largest. Faces of a level are stored one after another.
+    std::vector<Level> levels;
+
+    /// Contents of the file
+    std::vector<unsigned char> data;
+};
+
+///
+/// \brief isKTX2File Checks whether a filepath has the extension of KTX2 files.
+///
+bool isKTX2File(const std::string &filepath);
+
+///
+/// \brief load Loads a KTX2 file from the assets and validates it.
+/// \exception age::LoadError Failed to read the file or its format is not supported.
+///
+Image load(const std::string &filepath);
+
+///
+/// \brief parse Validates the contents of a KTX2 file and locates its mip levels.
+/// \param filepath Filepath that errors refer to.
+/// \exception age::LoadError The contents are not a supported KTX2 file.
+///
+Image parse(std::vector<unsigned char> data, const std::string &filepath);
+
+///
+/// \brief getFaceSize Returns the size of a face of a mip level of the image.
+///
+std::size_t getFaceSize(const Image &image, unsigned int level);
+
+///
+/// \brief upload Uploads the mip levels of a face to the texture that is bound to target.
+///
+/// GL_TEXTURE_MAX_LEVEL of the texture should be set to the last uploaded level.
+///
+/// \param target GL_TEXTURE_2D or a face of GL_TEXTURE_CUBE_MAP.
+/// \param face Face of the image to upload.
+/// \param firstLevel First mip level of the image to upload, which becomes level 0 of the
+///                   texture.
+///
+void upload(const Image &image, unsigned int target, unsigned int face = 0u,
+            unsigned int firstLevel = 0u);
+
+} // namespace KTX2
+} // namespace age
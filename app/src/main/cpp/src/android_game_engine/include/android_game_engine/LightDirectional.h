@@ -20,6 +20,8 @@ public:
     /// \return The orthonormal projection matrix of the light.
     ///
     glm::mat4 getProjectionMatrix() const override;
+
+    float getFarPlane() const;
     
     void render(ShaderProgram *shader) override;
 
@@ -32,4 +34,6 @@ private:
     float farPlane;
 };
 
+inline float LightDirectional::getFarPlane() const {return this->farPlane;}
+
 } // namespace age
\ No newline at end of file
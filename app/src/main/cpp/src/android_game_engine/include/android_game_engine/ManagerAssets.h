@@ -8,10 +8,13 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#ifdef __ANDROID__
 #include <jni.h>
 
 #include <android/asset_manager.h>
+#endif
 
 namespace age {
 
@@ -19,10 +22,24 @@ class Asset;
 
 namespace ManagerAssets {
 
+#ifdef __ANDROID__
 void init(JNIEnv *env, jobject jAssetManager);
+#else
+///
+/// \brief init Loads assets from a directory of the host's filesystem.
+/// \param assetsDirectory Directory that asset filepaths are relative to, i.e. app/src/main/assets
+///
+void init(const std::string &assetsDirectory);
+#endif
 void shutdown();
 
 Asset openAsset(const std::string &filepath);
 
+///
+/// \brief readAsset Reads the whole contents of an asset.
+/// \exception age::LoadError Failed to open or read the asset.
+///
+std::vector<unsigned char> readAsset(const std::string &filepath);
+
 } // namespace ManagerAssets
 } // namespace age
\ No newline at end of file
@@ -25,9 +25,47 @@ public:
          const std::vector<Texture2D> &diffuseTextures,
          const std::vector<Texture2D> &specularTextures);
 
-    void bindTextures(ShaderProgram *shader);
+    /// \name Texture units
+    /// Material textures are bound to fixed texture units so that the samplers of a shader
+    /// program only have to be set once. Textures beyond MAX_TEXTURES of each kind are not bound.
+    ///@{
+    static constexpr int MAX_TEXTURES = 4;
+    static constexpr int DIFFUSE_TEXTURE_UNIT = 0;
+    static constexpr int SPECULAR_TEXTURE_UNIT = DIFFUSE_TEXTURE_UNIT + MAX_TEXTURES;
+    ///@}
+
+    ///
+    /// \brief setTextureUnits Sets the units of the material samplers "material.diffuseTextureN"
+    ///                        and "material.specularTextureN" of a shader program. Must be called
+    ///                        once for every shader program that renders meshes.
+    ///
+    static void setTextureUnits(ShaderProgram *shader);
+
+    void bindTextures();
     void renderVAO(ShaderProgram *shader);
 
+    ///
+    /// \brief requestTextureSize Requests the mip levels of every texture, see
+    ///                           Texture2D::requestSize().
+    ///
+    void requestTextureSize(float screenSize_pixels);
+
+    VertexArray* getVertexArray() const;
+    const std::vector<Texture2D>& getDiffuseTextures() const;
+    const std::vector<Texture2D>& getSpecularTextures() const;
+
+    ///
+    /// \brief hasSameTextures Checks whether binding the textures of mesh would leave the
+    ///                        currently bound textures of this mesh unchanged.
+    ///
+    bool hasSameTextures(const Mesh &mesh) const;
+
+    ///
+    /// \brief getTextureHash Returns a hash of the texture ids that is equal for meshes
+    ///                       with the same textures.
+    ///
+    unsigned int getTextureHash() const;
+
 private:
     void init();
 
@@ -37,4 +75,8 @@ private:
     std::vector<Texture2D> specularTextures;
 };
 
+inline VertexArray* Mesh::getVertexArray() const {return this->vao.get();}
+inline const std::vector<Texture2D>& Mesh::getDiffuseTextures() const {return this->diffuseTextures;}
+inline const std::vector<Texture2D>& Mesh::getSpecularTextures() const {return this->specularTextures;}
+
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+/**
+ * Import time optimizations of indexed triangle lists for the post-transform vertex cache,
+ * overdraw and vertex fetch of the GPU.
+ */
+
+#include <cstddef>
+#include <vector>
+
+namespace age {
+
+struct Vertex;
+
+namespace MeshOptimizer {
+
+/// Size of the FIFO post-transform vertex cache that is optimized for and simulated
+constexpr unsigned int CACHE_SIZE = 16u;
+
+struct Stats {
+    std::size_t numTriangles = 0u;
+    std::size_t numVerticesBefore = 0u;
+    std::size_t numVerticesAfter = 0u;
+
+    /// Number of vertices that are transformed when drawing the mesh
+    std::size_t numCacheMissesBefore = 0u;
+    std::size_t numCacheMissesAfter = 0u;
+
+    Stats& operator+=(const Stats &stats);
+
+    ///
+    /// \brief getACMRBefore Returns the average cache miss ratio, i.e. the number of vertices
+    ///                      that are transformed per triangle, before the optimization.
+    ///
+    float getACMRBefore() const;
+    float getACMRAfter() const;
+};
+
+///
+/// \brief optimize Runs all optimizations in order.
+///
+/// Indices that are not a triangle list are left unchanged.
+///
+/// \return Vertex and cache miss counts before and after the optimizations.
+///
+Stats optimize(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices);
+
+///
+/// \brief deduplicateVertices Merges vertices with identical attributes, e.g. the copies that
+///                            some file formats store for every face of a vertex.
+///
+void deduplicateVertices(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices);
+
+///
+/// \brief optimizeVertexCache Reorders the triangles for post-transform vertex cache locality
+///                            with Tipsify (Sander et al. 2007).
+///
+/// \param indices Triangle list to reorder.
+/// \param numVertices Number of vertices referenced by the indices.
+/// \return First triangle of every cluster, i.e. of every run of triangles that starts after
+///         Tipsify ran into a dead end. Clusters may be reordered with little effect on the
+///         vertex cache.
+///
+std::vector<std::size_t> optimizeVertexCache(std::vector<unsigned int> *indices,
+                                             std::size_t numVertices);
+
+///
+/// \brief optimizeOverdraw Reorders the clusters of a vertex cache optimized triangle list so
+///                         that triangles that face outward from the mesh are drawn first.
+///
+/// Clusters are merged until drawing them from an empty vertex cache costs at most threshold
+/// times the ACMR of the whole mesh, which bounds the loss of vertex cache locality.
+///
+/// \param clusters Clusters returned by optimizeVertexCache().
+/// \param threshold Tolerated increase of the ACMR.
+///
+void optimizeOverdraw(const std::vector<Vertex> &vertices, std::vector<unsigned int> *indices,
+                      const std::vector<std::size_t> &clusters, float threshold = 1.05f);
+
+///
+/// \brief optimizeVertexFetch Reorders the vertices in the order of their first use by the
+///                            indices and removes unused vertices.
+///
+void optimizeVertexFetch(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices);
+
+///
+/// \brief countCacheMisses Simulates a FIFO vertex cache and returns the number of vertices
+///                         that are transformed when drawing the triangle list.
+///
+std::size_t countCacheMisses(const std::vector<unsigned int> &indices, std::size_t numVertices,
+                             unsigned int cacheSize = CACHE_SIZE);
+
+} // namespace MeshOptimizer
+} // namespace age
@@ -16,6 +16,19 @@ namespace age {
 class Model
 {
 public:
+    ///
+    /// \brief interpolate Blends between two poses.
+    ///
+    /// Positions and scales are linearly interpolated while orientations are spherically
+    /// interpolated.
+    ///
+    /// \param from Pose at an interpolation of 0.
+    /// \param to Pose at an interpolation of 1.
+    /// \param interpolation Blend factor between 0 and 1.
+    /// \return The blended pose.
+    ///
+    static Model interpolate(const Model &from, const Model &to, float interpolation);
+
     glm::mat4 getModelMatrix() const;
     
     ///
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include <LinearMath/btIDebugDraw.h>
+#include <glm/vec3.hpp>
 
 namespace age {
 
@@ -9,8 +12,17 @@ class ShaderProgram;
 ///
 /// \brief Draws debugging objects for the Physics Engine
 ///
+/// The lines that the physics world draws are recorded on the simulation thread and rendered
+/// later through PhysicsDebugDrawer::render() on the rendering thread.
+///
 class PhysicsDebugDrawer : public btIDebugDraw {
 public:
+    struct Line {
+        glm::vec3 from;
+        glm::vec3 to;
+        glm::vec3 color;
+    };
+
     explicit PhysicsDebugDrawer(ShaderProgram *shader);
     ~PhysicsDebugDrawer();
 
@@ -27,8 +39,16 @@ public:
     
     void setDebugMode(int debugMode) override;
     int getDebugMode() const override;
+
+    ///
+    /// \brief takeLines Moves the lines drawn since the last call into lines.
+    ///
+    void takeLines(std::vector<Line> *lines);
+
+    void render(const std::vector<Line> &lines);
     
 private:
+    std::vector<Line> lines;
     ShaderProgram *shader;
     unsigned int vao;
     unsigned int vbo;
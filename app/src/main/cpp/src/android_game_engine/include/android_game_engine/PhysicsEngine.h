@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <memory>
+#include <vector>
 
 #include <BulletCollision/BroadphaseCollision/btBroadphaseInterface.h>
 #include <BulletCollision/CollisionDispatch/btCollisionDispatcher.h>
@@ -10,10 +11,11 @@
 #include <BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
 #include <glm/vec3.hpp>
 
+#include "PhysicsDebugDrawer.h"
+
 namespace age {
 
 class GameObject;
-class PhysicsDebugDrawer;
 class PhysicsRigidBody;
 class ShaderProgram;
 
@@ -39,6 +41,10 @@ public:
     PhysicsEngine(const PhysicsEngine&) = delete;
     PhysicsEngine& operator=(const PhysicsEngine&) = delete;
     
+    ///
+    /// Steps the simulation forward by exactly one fixed step of the given duration.
+    /// \param updateDuration Duration of the simulation tick.
+    ///
     void onUpdate(std::chrono::duration<float> updateDuration);
 
     void setGravity(const glm::vec3 &gravity);
@@ -54,9 +60,17 @@ public:
     RaycastResult raycastClosest(const glm::vec3 &from, const glm::vec3 &to) const;
     
     ///
-    /// Draw registered physics body collision objects and bounding boxes.
+    /// Records the lines outlining the registered physics bodies' collision objects and bounding
+    /// boxes. This reads the physics world so it must be called by the simulation.
+    /// \param lines Replaced by the recorded lines.
+    ///
+    void drawDebug(std::vector<PhysicsDebugDrawer::Line> *lines);
+
+    ///
+    /// Draws lines recorded by PhysicsEngine::drawDebug() on the rendering thread. The debug
+    /// shader must be in use.
     ///
-    void renderDebug();
+    void renderDebug(const std::vector<PhysicsDebugDrawer::Line> &lines);
 
 private:
     std::unique_ptr<PhysicsDebugDrawer> debugDrawer;
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * Singleton frame profiler.
+ *
+ * CPU zones are recorded per thread and GPU zones are timed with the timestamp queries of
+ * GL_EXT_disjoint_timer_query when the extension supports them. Recorded zones are kept in a ring
+ * buffer that any thread may write while it is exported as a Chrome/Perfetto JSON trace. CPU zones are additionally forwarded to ATrace so that they show up
+ * in systrace/Perfetto captures of the device even while recording is disabled. ATrace is not
+ * available on the host.
+ *
+ * Zones are added with the PROFILE_ZONE and PROFILE_GPU_ZONE macros.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include <GLES3/gl32.h>
+
+#define PROFILE_CONCAT_IMPL(a, b) a ## b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#define PROFILE_ZONE(name) age::ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_GPU_ZONE(name) age::GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(name)
+
+namespace age {
+
+namespace Profiler {
+
+/**
+ * Checks for GPU timer query support. Must be called on the rendering thread whenever a GL
+ * context is created.
+ */
+void init();
+
+/**
+ * Enables recording of zones into the ring buffer.
+ * @param enabled Whether to record zones (default: false)
+ */
+void setEnabled(bool enabled);
+bool isEnabled();
+
+bool isGpuTimingSupported();
+
+/**
+ * Collects the results of finished GPU queries. Invoked by the GameEngine on the rendering thread
+ * at the end of every frame.
+ */
+void onFrameEnd();
+
+/**
+ * Writes the recorded zones in the Chrome trace event JSON format that can be opened with
+ * chrome://tracing or ui.perfetto.dev. Zones that are overwritten during the export are left out.
+ * @param filepath Output file, e.g. within the app's files directory
+ * @return False if the file could not be written
+ */
+bool writeChromeTrace(const std::string &filepath);
+std::string exportChromeTrace();
+
+/**
+ * Discards all recorded zones.
+ */
+void clear();
+
+std::int64_t now_ns();
+
+/**
+ * Records a finished zone. Names must outlive the Profiler, e.g. be string literals.
+ */
+void recordCpuZone(const char *name, std::int64_t start_ns, std::int64_t end_ns);
+
+GLuint beginGpuZone(const char *name);
+void endGpuZone(GLuint query);
+
+} // namespace Profiler
+
+///
+/// \brief Times the CPU work of the enclosing scope.
+///
+class ProfileZone {
+public:
+    explicit ProfileZone(const char *name);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone& operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;
+    std::int64_t start_ns;
+};
+
+///
+/// \brief Times the GPU work submitted in the enclosing scope.
+///
+class GpuProfileZone {
+public:
+    explicit GpuProfileZone(const char *name);
+    ~GpuProfileZone();
+
+    GpuProfileZone(const GpuProfileZone &) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone &) = delete;
+
+private:
+    GLuint query;
+};
+
+} // namespace age
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * Singleton cache of linked shader program binaries in app-private storage.
+ *
+ * Programs compiled from source are stored through glGetProgramBinary() and loaded through
+ * glProgramBinary() on later launches, which skips compiling and linking their shaders. Binaries
+ * are keyed by a hash of the shader sources and are only loaded by the GL vendor, renderer and
+ * driver version that stored them. Binaries that the driver rejects, e.g. after a driver update,
+ * are deleted and compiled from source again.
+ *
+ * Binaries are only loaded and stored on the rendering thread.
+ */
+
+#include <cstdint>
+#include <string>
+
+namespace age {
+namespace ProgramBinaryCache {
+
+struct Stats {
+    /// Programs loaded from binaries
+    unsigned int numLoaded = 0u;
+
+    /// Binaries that did not match the driver or failed to link
+    unsigned int numRejected = 0u;
+
+    /// Programs compiled from source whose binaries were stored
+    unsigned int numStored = 0u;
+};
+
+///
+/// \brief init Sets the directory that binaries are stored in, e.g. the app's code cache
+///             directory. Programs are always compiled from source until init() is called.
+///
+void init(const std::string &directory);
+
+///
+/// \brief load Starts linking a program from its stored binary.
+///
+/// Whether the driver accepted the binary is only known from the link status of the program,
+/// which must be passed to finishLoad().
+///
+/// \param program Program without attached shaders.
+/// \param sourceHash Hash of the sources of the program's shaders.
+/// \return Whether a binary of this driver was found. Otherwise the program is left unlinked and
+///         must be compiled from source.
+///
+bool load(unsigned int program, std::uint64_t sourceHash);
+
+///
+/// \brief finishLoad Deletes the binary of a program that failed to link from it, so that the
+///                   program is compiled from source and stored again.
+///
+void finishLoad(std::uint64_t sourceHash, bool linked);
+
+///
+/// \brief store Stores the binary of a program that was linked from source. The program must
+///              have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+///
+void store(unsigned int program, std::uint64_t sourceHash);
+
+Stats getStats();
+
+} // namespace ProgramBinaryCache
+} // namespace age
@@ -0,0 +1,98 @@
+#pragma once
+
+/**
+ * Singleton builder of shader programs that compiles and links them without blocking.
+ *
+ * build() submits the compiles and the link of a program to the driver and returns right away,
+ * so that all programs of a game are compiled at the same time. Drivers with
+ * GL_KHR_parallel_shader_compile compile them in the background. update(), which the
+ * GameEngine invokes at the start of every frame, polls the programs without blocking and
+ * invokes the callbacks of the programs that finished. Without the extension, checking whether
+ * a program finished blocks until it did, so update() only finishes one program per frame.
+ *
+ * Programs are only built on the rendering thread.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace age {
+namespace ProgramBuilder {
+
+///
+/// \brief Shader program that is being built.
+///
+class Build;
+
+///
+/// \brief Invoked on the rendering thread once a program is linked.
+///
+using Callback = std::function<void()>;
+
+struct Stats {
+    unsigned int numPending = 0u;
+    unsigned int numBuilt = 0u;
+
+    /// Whether the driver builds programs in the background
+    bool parallel = false;
+};
+
+///
+/// \brief build Starts loading the program binary of the shaders or compiling and linking the
+///              shaders into a program, see ProgramBinaryCache.
+/// \param sourceHash Hash of the shader sources that the program binary is stored by.
+///
+std::shared_ptr<Build> build(const std::string &vertexShaderPath,
+                             std::vector<unsigned char> vertexShaderSource,
+                             const std::string &fragmentShaderPath,
+                             std::vector<unsigned char> fragmentShaderSource,
+                             std::uint64_t sourceHash);
+
+///
+/// \brief getId Returns the OpenGL program, which is deleted with the build.
+///
+unsigned int getId(const Build &build);
+
+///
+/// \brief isReady Checks whether the program is linked without blocking. Without the extension,
+///                programs are only finished by update() and wait().
+/// \exception age::BuildError Failed to compile or link the shaders.
+///
+bool isReady(Build *build);
+
+///
+/// \brief wait Finishes building the program.
+/// \exception age::BuildError Failed to compile or link the shaders.
+///
+void wait(Build *build);
+
+///
+/// \brief onReady Invokes callback once the program is linked, or right away if it already is.
+///
+void onReady(Build *build, Callback callback);
+
+///
+/// \brief update Finishes the programs that the driver finished building.
+/// \return Whether all programs are ready, e.g. to show a load screen until they are.
+/// \exception age::BuildError Failed to compile or link the shaders of a program.
+///
+bool update();
+
+///
+/// \brief areAllReady Checks whether all programs are linked as of the last update().
+///
+bool areAllReady();
+
+///
+/// \brief waitAll Finishes building all programs.
+/// \exception age::BuildError Failed to compile or link the shaders of a program.
+///
+void waitAll();
+
+Stats getStats();
+
+} // namespace ProgramBuilder
+} // namespace age
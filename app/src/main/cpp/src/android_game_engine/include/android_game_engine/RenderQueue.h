@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace age {
+
+class Mesh;
+class Model;
+class ShaderProgram;
+class UniformBufferRing;
+class VertexArray;
+
+///
+/// \brief std140 layout of the per item uniforms when they are streamed through a
+///        UniformBufferRing.
+///
+/// The ObjectUB uniform block of the shaders holds an array of these that is indexed by
+/// gl_InstanceID.
+///
+struct ObjectUniformBlock {
+    glm::mat4 model; ///< Includes the position transform of the item's vertex array
+    glm::vec4 normal[3]; // Columns of a mat3 are padded to a vec4
+    glm::vec3 color;
+    float specularExponent;
+};
+
+///
+/// \brief A single draw submitted to a RenderQueue.
+///
+struct RenderItem {
+    ShaderProgram *shader = nullptr;
+    VertexArray *vertexArray = nullptr;
+
+    /// Mesh whose textures are bound for the draw or nullptr for depth only passes. The normal
+    /// matrix, color and specular exponent are only set for items with a material.
+    Mesh *material = nullptr;
+    glm::vec3 color {1.0f}; ///< Tint of the diffuse textures
+    float specularExponent = 0.0f;
+
+    /// Pose of the draw. Must stay valid until the queue is rendered.
+    const Model *model = nullptr;
+
+    /// Items of lower layers are drawn first, e.g. opaque before transparent geometry.
+    std::uint8_t layer = 0u;
+};
+
+///
+/// \brief Collects the draws of a render pass and submits them in an order that minimises
+///        GL state changes.
+///
+/// Items are sorted by a 64-bit key made of, from the most to the least significant bits, the
+/// layer, shader, textures, vertex array and distance to the viewer. Draws that share state
+/// are therefore adjacent and only the state that differs from the previous draw is bound.
+/// Within the same state nearer items are drawn first to benefit from early depth testing.
+///
+/// Once their uniforms are streamed through RenderQueue::writeObjectUniforms(), adjacent items
+/// with the same shader, vertex array, textures and layer are drawn as instances of a single
+/// draw call.
+///
+class RenderQueue {
+public:
+    static constexpr unsigned int MAX_LAYER = 15u;
+
+    /// Length of the object array of the ObjectUB uniform block in the engine's shaders and
+    /// therefore the maximum number of items drawn by a single draw call.
+    static constexpr unsigned int MAX_INSTANCES = 64u;
+
+    ///
+    /// \brief Number of draws and state changes of the last RenderQueue::render().
+    ///
+    struct Stats {
+        unsigned int numItems = 0u;
+        unsigned int numDrawCalls = 0u;
+        unsigned int numShaderChanges = 0u;
+        unsigned int numTextureChanges = 0u;
+        unsigned int numVertexArrayChanges = 0u;
+    };
+
+    ///
+    /// \brief begin Discards the items of the previous pass.
+    /// \param viewPosition Position that items are sorted front to back from.
+    /// \param maxDepth Distance from viewPosition beyond which items are no longer ordered.
+    ///
+    void begin(const glm::vec3 &viewPosition, float maxDepth);
+
+    ///
+    /// \brief submit Adds an item to the pass. Items whose shader program is still being built are
+    ///               dropped so that drawing the pass does not wait for the program.
+    ///
+    void submit(const RenderItem &item);
+
+    ///
+    /// \brief writeObjectUniforms Writes the per item uniforms of the items submitted to the
+    ///                            queues into a frame of the ring.
+    ///
+    /// Items are then drawn with their block of the ring bound instead of setting their
+    /// uniforms individually if their shader has the ring's uniform block. The ring must be
+    /// able to bind as many blocks at once as the shaders' uniform block arrays hold. Items
+    /// drawn on their own with the same pose and vertex array share a block, including items of
+    /// different queues, so that e.g. a game object in the shadow and world pass is only
+    /// uploaded once. The blocks are gathered in containers of the queue this is called on,
+    /// which may be one of the queues.
+    ///
+    void writeObjectUniforms(const std::vector<RenderQueue*> &queues, UniformBufferRing *ring);
+
+    ///
+    /// \brief render Sorts and draws the submitted items.
+    ///
+    /// Uniforms that are common to all items (e.g. lighting) must have been set on the shaders
+    /// beforehand. Uniform values are kept by the shader programs so this may be done before
+    /// any of them is used by the queue.
+    ///
+    void render();
+
+    std::size_t getNumItems() const;
+    const Stats& getStats() const;
+
+private:
+    struct SortEntry {
+        std::uint64_t key;
+        std::uint32_t item;
+    };
+
+    /// Consecutive sorted entries drawn by a single draw call
+    struct Draw {
+        std::uint32_t firstEntry;
+        std::uint32_t numInstances;
+
+        /// Blocks of objectUniforms bound for the draw. No blocks are bound if the uniforms are
+        /// set individually.
+        unsigned int firstBlock;
+        unsigned int numBoundBlocks;
+    };
+
+    /// Items share their object uniforms if they have the same pose and vertex array since the
+    /// model matrix includes the position transform of the vertex array
+    using ObjectKey = std::pair<const Model*, const VertexArray*>;
+
+    struct ObjectKeyHash {
+        std::size_t operator()(const ObjectKey &key) const;
+    };
+
+    std::uint64_t getSortKey(const RenderItem &item) const;
+    void sort();
+
+    ///
+    /// \brief buildDraws Sorts the items and merges the ones that can be instanced through
+    ///                   ring into draws.
+    ///
+    void buildDraws(const UniformBufferRing *ring);
+
+    glm::vec3 viewPosition {0.0f};
+    float maxDepth = 1.0f;
+
+    std::vector<RenderItem> items;
+    std::vector<SortEntry> entries;
+    std::vector<SortEntry> sortBuffer;
+
+    std::vector<Draw> draws;
+
+    /// Ring that the blocks of the draws have been written to
+    UniformBufferRing *objectUniforms = nullptr;
+
+    /// Blocks gathered by writeObjectUniforms(), kept to reuse their memory
+    std::unordered_map<ObjectKey, unsigned int, ObjectKeyHash> objectBlocks;
+    std::vector<const RenderItem*> blockItems;
+
+    Stats stats;
+};
+
+inline std::size_t RenderQueue::getNumItems() const {return this->items.size();}
+inline const RenderQueue::Stats& RenderQueue::getStats() const {return this->stats;}
+
+} // namespace age
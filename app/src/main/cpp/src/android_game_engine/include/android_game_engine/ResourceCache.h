@@ -0,0 +1,131 @@
+#pragma once
+
+/**
+ * Singleton cache of GPU resources loaded from files, i.e. textures, meshes and shader programs.
+ *
+ * Resources are keyed by the full filepath and a hash of the file contents, so files of the same
+ * name in different directories do not alias and changed files are reloaded. The content hash of an
+ * asset is remembered by its filepath, size and modification time, so that looking up a resource
+ * only reads and hashes its files the first time they are seen or after they changed. The cache
+ * holds a reference to every resource, which keeps resources that are no longer used by the game
+ * warm until the GPU memory of the unused resources exceeds the budget. trim() then evicts the
+ * least recently used of them. The GameEngine trims the cache at the start of every frame.
+ *
+ * Resources are only cached and evicted on the rendering thread.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace age {
+namespace ResourceCache {
+
+/// Initial value of a content hash (64 bit FNV-1a)
+constexpr std::uint64_t HASH_SEED = 0xCBF29CE484222325u;
+
+///
+/// \brief Identifies a resource by the file it was loaded from.
+///
+struct Key {
+    /// Full filepath in the assets. Resources loaded from several files join their filepaths.
+    std::string filepath;
+
+    /// Hash of the contents of the files
+    std::uint64_t contentHash;
+
+    bool operator==(const Key &other) const;
+};
+
+struct Stats {
+    unsigned int numResources = 0u;
+
+    /// Resources that are only referenced by the cache
+    unsigned int numUnused = 0u;
+
+    std::size_t used_bytes = 0u;
+    std::size_t unused_bytes = 0u;
+
+    unsigned int numHits = 0u;
+    unsigned int numMisses = 0u;
+    unsigned int numEvictions = 0u;
+};
+
+///
+/// \brief hash Hashes the contents of a file.
+/// \param hash Hash to continue, e.g. of the previous file of a resource loaded from several
+///             files.
+///
+std::uint64_t hash(const void *data, std::size_t size_bytes, std::uint64_t hash = HASH_SEED);
+
+///
+/// \brief hashAsset Returns the content hash of an asset, reading and hashing the asset only if
+///                  its hash is not known for its current size and modification time.
+/// \param contents Receives the contents of the asset if it was read and is left empty otherwise,
+///                 so that a resource that is not cached can be loaded from them.
+/// \exception age::LoadError Failed to open or read the asset.
+///
+std::uint64_t hashAsset(const std::string &filepath,
+                        std::vector<unsigned char> *contents = nullptr);
+
+///
+/// \brief find Returns the cached resource or nullptr if it is not cached.
+///
+template <typename T>
+std::shared_ptr<T> find(const Key &key);
+
+///
+/// \brief insert Caches a resource, replacing a resource of the same key.
+///
+/// The resource counts as used as long as anything else shares ownership of it. Handles to parts
+/// of the resource must share its ownership, e.g. through the aliasing constructor of
+/// std::shared_ptr, to keep it from being evicted.
+///
+/// \param size_bytes GPU memory of the resource.
+///
+template <typename T>
+void insert(const Key &key, const std::shared_ptr<T> &resource, std::size_t size_bytes);
+
+///
+/// \brief setSize Updates the GPU memory of a cached resource, e.g. once it finished loading.
+///
+void setSize(const Key &key, std::size_t size_bytes);
+
+///
+/// \brief setBudget Sets the GPU memory that unused resources may keep (default: 64 MiB).
+///
+void setBudget(std::size_t budget_bytes);
+
+///
+/// \brief trim Evicts the least recently used of the unused resources until their GPU memory is
+///             within the budget.
+///
+void trim();
+
+Stats getStats();
+
+///
+/// \brief clear Releases all resources, e.g. before the GL context is destroyed.
+///
+void clear();
+
+std::shared_ptr<void> findResource(const Key &key, std::type_index type);
+void insertResource(const Key &key, std::shared_ptr<void> resource, std::type_index type,
+                    std::size_t size_bytes);
+
+template <typename T>
+std::shared_ptr<T> find(const Key &key) {
+    return std::static_pointer_cast<T>(findResource(key, typeid(T)));
+}
+
+template <typename T>
+void insert(const Key &key, const std::shared_ptr<T> &resource, std::size_t size_bytes) {
+    insertResource(key, resource, typeid(T), size_bytes);
+}
+
+} // namespace ResourceCache
+} // namespace age
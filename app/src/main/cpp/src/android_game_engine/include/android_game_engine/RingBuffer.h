@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace age {
+
+///
+/// \brief Lock-free bounded queue for handing data from a single producer thread to a single
+///        consumer thread.
+///
+template <typename T, std::size_t Capacity>
+class RingBuffer {
+    static_assert(Capacity > 0u && (Capacity & (Capacity - 1u)) == 0u,
+                  "RingBuffer capacity must be a power of two");
+
+public:
+    RingBuffer() = default;
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer& operator=(const RingBuffer &) = delete;
+
+    ///
+    /// \brief push Appends a value. Must only be called from the producer thread.
+    /// \return False if the ring buffer is full and the value was dropped.
+    ///
+    bool push(const T &value);
+
+    ///
+    /// \brief pop Removes the oldest value. Must only be called from the consumer thread.
+    /// \return False if the ring buffer is empty.
+    ///
+    bool pop(T *value);
+
+private:
+    static constexpr std::size_t INDEX_MASK = Capacity - 1u;
+
+    std::array<T, Capacity> buffer;
+
+    // Kept on separate cache lines so that the producer and consumer don't contend
+    alignas(64) std::atomic<std::size_t> head {0u}; ///< Next value to pop
+    alignas(64) std::atomic<std::size_t> tail {0u}; ///< Next slot to push to
+};
+
+template <typename T, std::size_t Capacity>
+bool RingBuffer<T, Capacity>::push(const T &value) {
+    const auto tail = this->tail.load(std::memory_order_relaxed);
+    if (tail - this->head.load(std::memory_order_acquire) == Capacity) return false;
+
+    this->buffer[tail & INDEX_MASK] = value;
+    this->tail.store(tail + 1u, std::memory_order_release);
+    return true;
+}
+
+template <typename T, std::size_t Capacity>
+bool RingBuffer<T, Capacity>::pop(T *value) {
+    const auto head = this->head.load(std::memory_order_relaxed);
+    if (head == this->tail.load(std::memory_order_acquire)) return false;
+
+    *value = this->buffer[head & INDEX_MASK];
+    this->head.store(head + 1u, std::memory_order_release);
+    return true;
+}
+
+} // namespace age
@@ -3,6 +3,7 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <GLES3/gl32.h>
 
@@ -12,10 +13,27 @@ class Shader {
 public:
     Shader(const std::string &filepath, GLenum type);
 
+    ///
+    /// \brief Starts compiling source code that was already read from a file.
+    ///
+    /// The driver may compile the shader in the background. Compile errors are only checked by
+    /// checkCompileStatus(), e.g. once linking a program of the shader failed.
+    ///
+    /// \param filepath Filepath that errors refer to.
+    ///
+    Shader(const std::string &filepath, const std::vector<unsigned char> &source, GLenum type);
+
     void attachToProgram(unsigned int program);
     void detachFromProgram(unsigned int program);
 
+    ///
+    /// \brief checkCompileStatus Waits for the shader to compile.
+    /// \exception age::BuildError Failed to compile the shader.
+    ///
+    void checkCompileStatus() const;
+
 private:
+    std::string filepath;
     std::unique_ptr<GLuint, std::function<void(GLuint *)>> shader;
 };
 
@@ -2,14 +2,43 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <GLES3/gl32.h>
 
 #include <glm/fwd.hpp>
 
+#include "ProgramBuilder.h"
+
 namespace age {
 
 class UniformBuffer;
+class UniformBufferRing;
+
+///
+/// \brief Location of a uniform of type T that was resolved once through
+///        ShaderProgram::getUniformHandle() so that setting it does not look up its name.
+///
+/// Default constructed handles and handles of uniforms that are not active in the shader
+/// program are invalid. Setting an invalid handle is silently ignored like setting a uniform
+/// name that does not exist.
+///
+template <typename T>
+class UniformHandle {
+public:
+    UniformHandle() = default;
+
+    bool isValid() const;
+    int getLocation() const;
+
+private:
+    friend class ShaderProgram;
+    explicit UniformHandle(int location);
+
+    int location = -1;
+};
 
 ///
 /// \brief Manages loading, compiling, linking and working with shader programs.
@@ -18,10 +47,21 @@ class ShaderProgram
 {
 public:
     ///
-    /// \brief Loads, compiles, and links given shaders into an OpenGL shader program.
+    /// \brief Loads given shaders and starts compiling and linking them into an OpenGL shader
+    ///        program.
+    ///
+    /// Programs are cached by the filepaths and contents of their shaders in the ResourceCache.
+    /// Shader programs of the same shaders share their OpenGL program and thus their uniform
+    /// values. Linked programs are also stored in the ProgramBinaryCache, which skips compiling
+    /// and linking the shaders on later launches.
+    ///
+    /// The program is built in the background by the ProgramBuilder. Uniform block bindings are
+    /// deferred until it is linked. Using the program or querying its uniforms before then waits
+    /// for it, and throws age::BuildError if the shaders fail to compile or link.
+    ///
     /// \param[in] vertexShaderPath Filepath of the vertex shader.
     /// \param[in] fragmentShaderPath Filepath of the fragment shader.
-    /// \exception age::BuildError Failed to compile or link shaders.
+    /// \exception age::LoadError Failed to read shaders.
     ///
     ShaderProgram(const std::string &vertexShaderPath,
                   const std::string &fragmentShaderPath);
@@ -35,12 +75,31 @@ public:
     /// This is a helper function that calls glUseProgram() on this shader program.
     ///
     void use();
+
+    ///
+    /// \brief isReady Checks whether the program is linked without waiting for it. Passes skip
+    ///                drawing with programs that are not ready so that frames are not held up by
+    ///                programs that are still being built.
+    /// \exception age::BuildError Failed to compile or link shaders.
+    ///
+    bool isReady() const;
+
+    unsigned int getId() const;
     
     /// \name Uniforms
     /// Sets uniform value on this shader program. User must call ShaderProgram::use() before
     /// the 1st call to a ShaderProgram::setUniform() function to ensure that they are
-    /// setting the uniform on the right active shader program.
+    /// setting the uniform on the right active shader program. Names are looked up without
+    /// allocating, but uniforms that are set for every draw should use a UniformHandle.
     ///@{
+    void setUniform(const char *name, bool value);
+    void setUniform(const char *name, int value);
+    void setUniform(const char *name, float value);
+    void setUniform(const char *name, const glm::vec2 &v);
+    void setUniform(const char *name, const glm::vec3 &v);
+    void setUniform(const char *name, const glm::vec4 &v);
+    void setUniform(const char *name, const glm::mat3 &m);
+    void setUniform(const char *name, const glm::mat4 &m);
     void setUniform(const std::string &name, bool value);
     void setUniform(const std::string &name, int value);
     void setUniform(const std::string &name, float value);
@@ -51,15 +110,126 @@ public:
     void setUniform(const std::string &name, const glm::mat4 &m);
     ///@}
 
+    ///
+    /// \brief getUniformHandle Returns the handle of an active uniform.
+    ///
+    /// All active uniforms are reflected once the program is linked. Elements of uniform arrays
+    /// are looked up as "name[i]".
+    ///
+    /// \param name Name of the uniform, e.g. "material.specularExponent".
+    ///
+    template <typename T>
+    UniformHandle<T> getUniformHandle(const std::string &name) const;
+
+    bool hasUniform(const std::string &name) const;
+
+    /// \name Uniform handles
+    /// Sets uniform value through a handle of this shader program with a single glUniform*()
+    /// call. The same requirements as for setting uniforms by name apply.
+    ///@{
+    void setUniform(UniformHandle<bool> handle, bool value);
+    void setUniform(UniformHandle<int> handle, int value);
+    void setUniform(UniformHandle<float> handle, float value);
+    void setUniform(UniformHandle<glm::vec2> handle, const glm::vec2 &v);
+    void setUniform(UniformHandle<glm::vec3> handle, const glm::vec3 &v);
+    void setUniform(UniformHandle<glm::vec4> handle, const glm::vec4 &v);
+    void setUniform(UniformHandle<glm::mat3> handle, const glm::mat3 &m);
+    void setUniform(UniformHandle<glm::mat4> handle, const glm::mat4 &m);
+    ///@}
+
     ///
     /// \brief setUniformBlockBinding Links the uniform block of this shader to the binding point
     ///                               of the specified ubo.
     /// \param ubo Uniform Buffer Object to link against.
     ///
     void setUniformBlockBinding(const UniformBuffer &ubo);
+    void setUniformBlockBinding(const UniformBufferRing &uboRing);
+
+    ///
+    /// \brief setTextureUnit Sets the texture unit that a sampler uniform reads from once instead
+    ///                       of on every bind. Like uniform block bindings, units of programs that
+    ///                       are not linked yet are set once they are.
+    /// \param samplerName Name of the sampler uniform, e.g. "material.diffuseTexture0".
+    ///
+    void setTextureUnit(const std::string &samplerName, int textureUnit);
+
+    bool hasUniformBlock(const std::string &name) const;
+
+    ///
+    /// \brief getUniformBlockSize Returns the size of an active uniform block in bytes or 0 if
+    ///                            the shader has no such block.
+    ///
+    unsigned int getUniformBlockSize(const std::string &name) const;
     
 private:
-    std::unique_ptr<unsigned int, std::function<void(unsigned int *)>> program;
+    struct UniformBlock {
+        unsigned int index;
+        unsigned int size_bytes;
+    };
+
+    ///
+    /// \brief OpenGL program shared by the shader programs of the same shaders and its
+    ///        uniforms, which are reflected once it is linked.
+    ///
+    struct Program {
+        std::shared_ptr<ProgramBuilder::Build> build;
+
+        /// Sorted by name so that names can be looked up without constructing a std::string
+        std::vector<std::pair<std::string, int>> uniformLocations;
+        std::unordered_map<std::string, UniformBlock> uniformBlocks;
+
+        /// Uniform block bindings and texture units set before the program was linked
+        std::vector<std::pair<std::string, unsigned int>> blockBindings;
+        std::vector<std::pair<std::string, int>> textureUnits;
+    };
+
+    static void reflectUniforms(Program *program);
+    static int findUniformLocation(const Program &program, const char *name);
+    static void bindUniformBlock(const Program &program, const std::string &uniformBlockName,
+                                 unsigned int bindingPoint);
+    static void bindTextureUnit(const Program &program, const std::string &samplerName,
+                                int textureUnit);
+
+    void setUniformBlockBinding(const std::string &uniformBlockName, unsigned int bindingPoint);
+    int getUniformLocation(const char *name) const;
+
+    ///
+    /// \brief getProgram Returns the program once it is linked, waiting for it if necessary.
+    ///
+    const Program& getProgram() const;
+
+    std::shared_ptr<Program> program;
 };
 
+template <typename T>
+inline UniformHandle<T>::UniformHandle(int location) : location(location) {}
+
+template <typename T>
+inline bool UniformHandle<T>::isValid() const {return this->location >= 0;}
+
+template <typename T>
+inline int UniformHandle<T>::getLocation() const {return this->location;}
+
+inline unsigned int ShaderProgram::getId() const {return ProgramBuilder::getId(*this->program->build);}
+
+template <typename T>
+inline UniformHandle<T> ShaderProgram::getUniformHandle(const std::string &name) const {
+    return UniformHandle<T>(this->getUniformLocation(name.c_str()));
+}
+
+inline bool ShaderProgram::hasUniform(const std::string &name) const {
+    return this->getUniformLocation(name.c_str()) >= 0;
+}
+
+inline bool ShaderProgram::hasUniformBlock(const std::string &name) const {
+    const auto &uniformBlocks = this->getProgram().uniformBlocks;
+    return uniformBlocks.find(name) != uniformBlocks.cend();
+}
+
+inline unsigned int ShaderProgram::getUniformBlockSize(const std::string &name) const {
+    const auto &uniformBlocks = this->getProgram().uniformBlocks;
+    const auto block = uniformBlocks.find(name);
+    return block == uniformBlocks.cend() ? 0u : block->second.size_bytes;
+}
+
 } // namespace age
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <string>
 
 namespace age {
@@ -15,9 +16,18 @@ public:
     /// \brief Skybox Creates a cubemap for a skybox.
     /// \param imageFilepaths 6 images for each side of the skybox in the order of:
     ///                       front, back, right, left, top, bottom
+    ///                       Either all or none of them are KTX2 files, see KTX2.h.
     /// \exception age::LoadError Failed to load texture data from image file.
     ///
     explicit Skybox(const std::array<std::string, 6> &imageFilepaths);
+
+    ///
+    /// \brief Skybox Creates a skybox from a KTX2 cubemap with compressed mip levels.
+    /// \param cubemapFilepath KTX2 file with 6 faces.
+    /// \exception age::LoadError Failed to load the KTX2 file.
+    ///
+    explicit Skybox(const std::string &cubemapFilepath);
+
     ~Skybox();
 
     Skybox(Skybox &&) noexcept = default;
@@ -26,6 +36,8 @@ public:
     void render(ShaderProgram *shader);
 
 private:
+    void init();
+
     unsigned int vao;
     unsigned int vbo;
     unsigned int texture;
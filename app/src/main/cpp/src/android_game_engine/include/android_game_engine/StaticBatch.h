@@ -0,0 +1,40 @@
+#pragma once
+
+#include "GameObject.h"
+
+#include <memory>
+#include <vector>
+
+#include "AABB.h"
+
+namespace age {
+
+///
+/// \brief Draws the merged meshes of game objects that never move, e.g. floors, walls or props
+///        with a mass of 0.
+///
+/// The meshes are transformed into the world coordinate frame at load time and merged into a
+/// single vertex array per material, so that the game objects of a batch are drawn with one
+/// draw call per material. Game objects are grouped into cubic chunks by the center of their
+/// bounds and every chunk is batched separately so that batches are still culled.
+///
+class StaticBatch : public GameObject {
+public:
+    ///
+    /// \brief build Merges the meshes of game objects into batches.
+    ///
+    /// The game objects are hidden so that only the batches are drawn. They keep their physics
+    /// and must not be moved afterwards. Game objects without bounds are not batched.
+    ///
+    /// \param gameObjects Game objects to batch in their current pose.
+    /// \param chunkSize Edge length of the chunks.
+    /// \return Batches to add to the world list.
+    ///
+    static std::vector<std::shared_ptr<StaticBatch>> build(const std::vector<GameObject*> &gameObjects,
+                                                           float chunkSize = 16.0f);
+
+private:
+    StaticBatch(std::shared_ptr<Meshes> meshes, const AABB &bounds);
+};
+
+} // namespace age
@@ -5,6 +5,9 @@
 
 #include <glm/fwd.hpp>
 
+#include "TextureLoader.h"
+#include "TextureStreamer.h"
+
 namespace age {
 
 ///
@@ -16,16 +19,26 @@ public:
     ///
     /// \brief loadTexture Loads and caches texture data from image file.
     ///
-    /// Texture2D object will automatically clean up cache and GPU data on
-    /// destruction. Do NOT call glDeleteTextures on this texture's id.
+    /// Textures are cached by their filepath and contents in the ResourceCache, which deletes
+    /// the GPU data once the texture is no longer used and evicted. Do NOT call
+    /// glDeleteTextures on this texture's id.
+    ///
+    /// The image is loaded asynchronously by the TextureLoader. Until it is uploaded the texture
+    /// is white. Images that fail to decode are logged and stay white. The texture is first
+    /// loaded with its small mip levels only. The TextureStreamer loads the larger ones once the
+    /// texture is requested with a larger size, see requestSize().
     ///
-    /// \param imageFilepath Filepath to the image.
-    /// \exception age::LoadError Failed to load image data from file.
+    /// \param imageFilepath Filepath to the image. KTX2 files (.ktx2) are uploaded with their
+    ///                      compressed mip levels, see KTX2.h.
+    /// \exception age::LoadError Failed to read the image file.
     ///
     explicit Texture2D(const std::string &imageFilepath);
     
     ///
-    /// \brief Creates a 2D texture of a solid color.
+    /// \brief Creates or reuses a 2D texture of a solid color.
+    ///
+    /// Textures of colors that are equal in 8 bits per channel share their GPU data, so meshes
+    /// that only use solid colors have the same texture ids and are drawn together.
     ///
     /// \param color RGB values between 0.0 and 1.0
     ///
@@ -36,8 +49,38 @@ public:
     ///
     void bind();
 
+    ///
+    /// \brief requestSize Requests the mip levels for drawing the texture this frame.
+    /// \param screenSize_pixels Size that the texture covers on the screen.
+    ///
+    void requestSize(float screenSize_pixels);
+
+    ///
+    /// \brief isLoaded Checks whether the small mip levels of the image have been uploaded. Solid
+    ///                 color textures are always loaded.
+    ///
+    bool isLoaded() const;
+
+    ///
+    /// \brief wait Finishes loading the small mip levels of the image on the rendering thread.
+    ///
+    void wait();
+
+    ///
+    /// \brief onLoaded Invokes callback on the rendering thread once loading finished.
+    ///
+    void onLoaded(TextureLoader::Callback callback);
+
+    unsigned int getId() const;
+
 private:
     std::shared_ptr<unsigned int> id;
+
+    /// Initial load and streaming of the image, if the texture is loaded from a file
+    std::shared_ptr<TextureLoader::Load> load;
+    std::shared_ptr<TextureStreamer::Stream> stream;
 };
 
+inline unsigned int Texture2D::getId() const {return *this->id;}
+
 } // namespace age
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+/**
+ * Asynchronous loading of image and KTX2 files into textures.
+ *
+ * Files are read and decoded by jobs of the JobSystem. The decoded images are uploaded on the
+ * rendering thread by update(), which the GameEngine invokes at the start of every frame and
+ * which stops uploading once the upload budget of the frame is spent. Decoded images are staged
+ * in pixel unpack buffers that jobs copy them into, and are transferred to their textures by a
+ * later update() once the copy is done. The rendering thread therefore neither copies pixels
+ * nor waits for the transfer.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace age {
+namespace TextureLoader {
+
+///
+/// \brief Load of a file into a texture. Shared by the textures of the same file.
+///
+class Load;
+
+///
+/// \brief Invoked on the rendering thread once a load finished.
+/// \param loaded Whether the image was uploaded or failed to load.
+///
+using Callback = std::function<void(bool loaded)>;
+
+/// Maximum resolution of loads that upload all mip levels of the file
+constexpr unsigned int FULL_RESOLUTION = ~0u;
+
+///
+/// \brief load Starts decoding a file into a texture and returns immediately.
+///
+/// The texture keeps its current contents until the image is uploaded. The upload is skipped if
+/// the texture was deleted by then.
+///
+/// \param textureId 2D texture to upload the image to.
+/// \param imageFilepath Image or KTX2 file that errors refer to.
+/// \param contents Contents of the file.
+/// \param maxResolution Largest width or height to upload. Mip levels above it are skipped, so
+///                      the first uploaded level becomes level 0 of the texture.
+///
+std::shared_ptr<Load> load(const std::shared_ptr<unsigned int> &textureId,
+                           const std::string &imageFilepath,
+                           std::vector<unsigned char> contents,
+                           unsigned int maxResolution = FULL_RESOLUTION);
+
+///
+/// \brief load Starts reading and decoding a file of the assets into a texture, e.g. to upload
+///             other mip levels of a texture. Errors of reading the file are logged.
+///
+std::shared_ptr<Load> load(const std::shared_ptr<unsigned int> &textureId,
+                           const std::string &imageFilepath,
+                           unsigned int maxResolution);
+
+///
+/// \brief isLoaded Checks whether the image has been uploaded.
+///
+bool isLoaded(const Load &load);
+
+///
+/// \brief getSize Returns the GPU memory of the uploaded image including its mip levels or 0 if
+///                it has not been uploaded.
+///
+std::size_t getSize(const Load &load);
+
+///
+/// \brief getResolution Returns the largest width or height of the uploaded image or 0 if it has
+///                      not been uploaded.
+///
+unsigned int getResolution(const Load &load);
+
+///
+/// \brief getFullResolution Returns the largest width or height of the image in the file or 0
+///                          if it has not been decoded.
+///
+unsigned int getFullResolution(const Load &load);
+
+///
+/// \brief wait Finishes a load on the calling thread, which must be the rendering thread,
+///             regardless of the upload budget.
+///
+void wait(Load *load);
+
+///
+/// \brief onLoaded Invokes callback once the load finished, immediately if it already has.
+///
+void onLoaded(Load *load, Callback callback);
+
+///
+/// \brief update Uploads staged images and stages decoded images until the upload budget is
+///               spent. At least one image is staged or uploaded per call.
+///
+void update();
+
+///
+/// \brief setUploadBudget Sets the time that update() may spend on uploads (default: 2 ms).
+///
+void setUploadBudget(std::chrono::duration<float> budget);
+
+///
+/// \brief getNumPending Returns the number of loads that have not finished yet.
+///
+unsigned int getNumPending();
+
+///
+/// \brief shutdown Discards the decoded images and the pixel unpack buffers of the current GL
+///                 context. Loads that are still decoding are discarded when they finish.
+///
+void shutdown();
+
+} // namespace TextureLoader
+} // namespace age
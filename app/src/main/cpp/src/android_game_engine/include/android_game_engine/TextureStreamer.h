@@ -0,0 +1,107 @@
+#pragma once
+
+/**
+ * Streaming of the mip levels of textures loaded from files under a GPU memory budget.
+ *
+ * Textures are first loaded with their small mip levels only. While rendering, the textures of
+ * visible objects are requested with the size that the objects cover on the screen. update(),
+ * which the GameEngine invokes at the start of every frame, then reloads textures with the
+ * larger mip levels that are needed. Once the resident textures exceed the budget, the mip
+ * levels of the textures with the least screen coverage for their resolution are dropped,
+ * starting with textures that are no longer visible.
+ *
+ * Reloads read and decode the file through the TextureLoader again, so no copies of the images
+ * are kept in memory.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TextureLoader.h"
+
+namespace age {
+namespace TextureStreamer {
+
+/// Largest width or height of the mip level that textures are first loaded with and that
+/// textures are never reduced below
+constexpr unsigned int MIN_RESOLUTION = 64u;
+
+/// Number of reloads that are decoded at the same time
+constexpr unsigned int MAX_NUM_RELOADS = 2u;
+
+///
+/// \brief Streaming state of a texture loaded from a file.
+///
+class Stream;
+
+///
+/// \brief Invoked on the rendering thread with the GPU memory of a texture whenever other mip
+///        levels of it were uploaded.
+///
+using ResizeCallback = std::function<void(std::size_t size_bytes)>;
+
+struct Stats {
+    unsigned int numStreams = 0u;
+    unsigned int numReloading = 0u;
+
+    std::size_t resident_bytes = 0u;
+    std::size_t budget_bytes = 0u;
+
+    /// Reloads since the start that added or dropped mip levels
+    unsigned int numUpgrades = 0u;
+    unsigned int numDowngrades = 0u;
+};
+
+///
+/// \brief create Starts loading the small mip levels of a file into a texture and streams the
+///               texture from then on.
+/// \param textureId 2D texture to stream the image to.
+/// \param imageFilepath Image or KTX2 file in the assets.
+/// \param contents Contents of the file.
+///
+std::shared_ptr<Stream> create(const std::shared_ptr<unsigned int> &textureId,
+                               const std::string &imageFilepath,
+                               std::vector<unsigned char> contents);
+
+///
+/// \brief getInitialLoad Returns the load of the small mip levels.
+///
+const std::shared_ptr<TextureLoader::Load>& getInitialLoad(const Stream &stream);
+
+///
+/// \brief onResized Invokes callback whenever other mip levels of the texture were uploaded.
+///
+void onResized(Stream *stream, ResizeCallback callback);
+
+///
+/// \brief request Requests the resolution for a texture that is drawn this frame.
+/// \param screenSize_pixels Size that the texture covers on the screen. The largest request of
+///                          a frame is used.
+///
+void request(Stream *stream, float screenSize_pixels);
+
+///
+/// \brief update Chooses the mip levels of the textures from the requests of the last frame and
+///               starts the reloads of the textures whose mip levels change.
+///
+void update();
+
+///
+/// \brief setBudget Sets the GPU memory of the streamed textures. The default depends on the
+///                  memory of the device, see getDefaultBudget().
+///
+void setBudget(std::size_t budget_bytes);
+
+///
+/// \brief getDefaultBudget Returns a sixteenth of the physical memory of the device, but at
+///                         least 64 MiB and at most 512 MiB.
+///
+std::size_t getDefaultBudget();
+
+Stats getStats();
+
+} // namespace TextureStreamer
+} // namespace age
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace age {
+
+///
+/// \brief Lock-free triple buffer for handing data from a single writer thread to a single
+///        reader thread.
+///
+/// The writer fills the buffer returned by TripleBuffer::getWriteBuffer() and then calls
+/// TripleBuffer::publish(). The reader always gets the most recently published buffer from
+/// TripleBuffer::getReadBuffer(). Neither side ever waits on the other and each side has
+/// exclusive access to its buffer until its next call.
+///
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer& operator=(const TripleBuffer &) = delete;
+
+    T* getWriteBuffer();
+
+    ///
+    /// \brief publish Hands the write buffer over to the reader and gives the writer a new one.
+    ///
+    void publish();
+
+    ///
+    /// \brief getReadBuffer Returns the most recently published buffer.
+    ///
+    T* getReadBuffer();
+
+private:
+    static constexpr unsigned int INDEX_MASK = 0x3u;
+    static constexpr unsigned int FRESH_BIT = 0x4u;
+
+    std::array<T, 3> buffers;
+
+    unsigned int writeIndex = 0u;
+    std::atomic<unsigned int> middleIndex {1u};
+    unsigned int readIndex = 2u;
+};
+
+template <typename T>
+inline T* TripleBuffer<T>::getWriteBuffer() {return &this->buffers[this->writeIndex];}
+
+template <typename T>
+void TripleBuffer<T>::publish() {
+    this->writeIndex = this->middleIndex.exchange(this->writeIndex | FRESH_BIT,
+                                                  std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+template <typename T>
+T* TripleBuffer<T>::getReadBuffer() {
+    if (this->middleIndex.load(std::memory_order_acquire) & FRESH_BIT) {
+        this->readIndex = this->middleIndex.exchange(this->readIndex,
+                                                     std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    return &this->buffers[this->readIndex];
+}
+
+} // namespace age
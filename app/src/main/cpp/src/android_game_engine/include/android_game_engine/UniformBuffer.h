@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
+
+#include <GLES3/gl32.h>
 
 namespace age {
 
@@ -48,4 +51,111 @@ private:
     unsigned int bindingPoint;
 };
 
+///
+/// \brief Streams many instances of a uniform block per frame, e.g. the per object data of
+///        every draw.
+///
+/// Blocks are written linearly into the region of the buffer that belongs to the current frame
+/// and bound with glBindBufferRange(). They are packed like the elements of an std140 array so
+/// that consecutive blocks can be bound at once as an array of blocks. Each frame region is
+/// guarded by a fence so that it is only rewritten once the GPU has finished reading it. With
+/// GL_EXT_buffer_storage the buffer is mapped persistently. Otherwise the region of a frame is
+/// mapped unsynchronized and must be unmapped through UniformBufferRing::endFrame() before
+/// drawing. If the driver fails to map the region, the blocks are uploaded by endFrame() instead.
+///
+class UniformBufferRing {
+public:
+    ///
+    /// \param uniformBlockName Name of the uniform block within the shaders.
+    /// \param blockSize_bytes Size of a single block.
+    /// \param maxBlocksPerBinding Maximum number of consecutive blocks bound at once.
+    /// \param numFrames Number of frames whose blocks may be in flight on the GPU.
+    ///
+    UniformBufferRing(const std::string &uniformBlockName, unsigned int blockSize_bytes,
+                      unsigned int maxBlocksPerBinding = 1u, unsigned int numFrames = 3u);
+    ~UniformBufferRing();
+
+    UniformBufferRing(const UniformBufferRing &) = delete;
+    UniformBufferRing& operator=(const UniformBufferRing &) = delete;
+
+    std::string getUniformBlockName() const;
+    unsigned int getBindingPoint() const;
+    unsigned int getBlockStride() const;
+    unsigned int getMaxBlocksPerBinding() const;
+
+    ///
+    /// \brief alignBlock Returns the first block from the i-th block on that can be bound.
+    ///
+    /// Bindings must start at a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, which may be
+    /// larger than a block.
+    ///
+    unsigned int alignBlock(unsigned int i) const;
+
+    ///
+    /// \brief beginFrame Waits until the GPU has finished reading the region of the next frame
+    ///                   and makes it writable.
+    /// \param numBlocks Number of blocks that will be written this frame. The buffer grows if
+    ///                  they do not fit.
+    ///
+    void beginFrame(unsigned int numBlocks);
+
+    ///
+    /// \brief getBlock Returns the memory to write the i-th block of the frame to.
+    ///
+    void* getBlock(unsigned int i);
+
+    ///
+    /// \brief endFrame Makes the written blocks visible to the GPU.
+    ///
+    void endFrame();
+
+    ///
+    /// \brief bindBlocks Binds consecutive blocks of the frame to the binding point.
+    /// \param first Block to bind from. It must have been aligned with alignBlock().
+    /// \param numBlocks Number of blocks to bind. Blocks beyond those written this frame may be
+    ///                  bound to back a uniform block array that is only partially read.
+    ///
+    void bindBlocks(unsigned int first, unsigned int numBlocks = 1u);
+
+private:
+    void allocate(unsigned int numBlocksPerFrame);
+    void release();
+
+    std::string uniformBlockName;
+    unsigned int bindingPoint;
+
+    unsigned int blockStride_bytes;
+    unsigned int alignmentStride;
+    unsigned int maxBlocksPerBinding;
+    unsigned int numFrames;
+    unsigned int numBlocksPerFrame = 0u;
+
+    unsigned int frame = 0u;
+    unsigned int frameOffset_bytes = 0u;
+    unsigned int numFrameBlocks = 0u;
+
+    GLuint ubo = 0u;
+    bool persistent;
+    char *persistentMemory = nullptr;
+    char *frameMemory = nullptr;
+    std::vector<GLsync> frameFences;
+
+    /// Client memory that the blocks of the frame are written to if its region couldn't be mapped
+    bool staged = false;
+    std::vector<char> stagingMemory;
+};
+
+inline std::string UniformBufferRing::getUniformBlockName() const {return this->uniformBlockName;}
+inline unsigned int UniformBufferRing::getBindingPoint() const {return this->bindingPoint;}
+inline unsigned int UniformBufferRing::getBlockStride() const {return this->blockStride_bytes;}
+inline unsigned int UniformBufferRing::getMaxBlocksPerBinding() const {return this->maxBlocksPerBinding;}
+
+inline unsigned int UniformBufferRing::alignBlock(unsigned int i) const {
+    return (i + this->alignmentStride - 1u) / this->alignmentStride * this->alignmentStride;
+}
+
+inline void* UniformBufferRing::getBlock(unsigned int i) {
+    return this->frameMemory + i * this->blockStride_bytes;
+}
+
 } // namespace age
\ No newline at end of file
@@ -1,39 +1,105 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 #include <glm/fwd.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "GeometryArena.h"
+#include "VertexLayout.h"
 
 namespace age {
 
-class Vertex;
+struct Vertex;
 
 ///
-/// \brief Wrapper class for OpenGL Vertex Array Object.
+/// \brief Vertices and indices of a mesh.
+///
+/// They are stored in the GeometryArena of their layout so that vertex arrays of the same layout
+/// share the OpenGL vertex array object. Indices are stored as 16 bit integers if there are few
+/// enough vertices.
 ///
 class VertexArray {
 public:
     VertexArray(const std::vector<glm::vec3> &positions,
                 const std::vector<glm::vec3> &normals,
                 const std::vector<glm::vec2> &textureCoordinates,
-                const std::vector<glm::uvec3> &indices);
+                const std::vector<glm::uvec3> &indices,
+                const VertexLayout &layout = VertexLayout());
 
     VertexArray(const std::vector<Vertex> &vertices,
-                const std::vector<unsigned int> &indices);
+                const std::vector<unsigned int> &indices,
+                const VertexLayout &layout = VertexLayout());
 
     ~VertexArray();
 
     VertexArray(VertexArray &&) noexcept = default;
-    VertexArray& operator=(VertexArray &&) noexcept = default;
+    VertexArray& operator=(VertexArray &&vertexArray) noexcept;
 
     void render();
 
+    ///
+    /// \brief bind Binds the vertex array object of the arena so that several draws of vertex
+    ///             arrays of the same layout only bind it once.
+    ///
+    void bind();
+
+    ///
+    /// \brief draw Draws the vertex array. It must be bound.
+    ///
+    void draw();
+
+    ///
+    /// \brief drawInstanced Draws several instances of the vertex array with a single draw call.
+    ///                      It must be bound.
+    ///
+    void drawInstanced(unsigned int numInstances);
+
+    ///
+    /// \brief getId Returns the id of the OpenGL vertex array object which is shared by the
+    ///              vertex arrays of the same layout.
+    ///
+    unsigned int getId() const;
+    const VertexLayout& getLayout() const;
+
+    ///
+    /// \brief getPositionTransform Returns the transform from the stored positions to the
+    ///                             positions of the vertices.
+    ///
+    const glm::mat4& getPositionTransform() const;
+
+    ///
+    /// \brief getSize Returns the size of the vertices and indices in the arena.
+    ///
+    std::size_t getSize() const;
+
+    ///
+    /// \brief readGeometry Reads the vertex and index data back from the GPU.
+    ///
+    /// This waits for the GPU and is meant for processing geometry at load time, e.g. merging
+    /// static meshes. Quantized attributes are read back with their quantization error.
+    ///
+    void readGeometry(std::vector<Vertex> *vertices, std::vector<unsigned int> *indices) const;
+
 private:
-    unsigned int vao;
-    unsigned int vbo;
-    unsigned int ebo;
+    std::shared_ptr<GeometryArena> arena;
+    GeometryArena::Allocation *allocation;
 
     size_t numIndices;
+    glm::mat4 positionTransform;
+
+    /// GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    unsigned int indexType;
 };
 
+inline unsigned int VertexArray::getId() const {return this->arena->getVertexArrayId();}
+inline const VertexLayout& VertexArray::getLayout() const {return this->arena->getLayout();}
+inline const glm::mat4& VertexArray::getPositionTransform() const {return this->positionTransform;}
+
+inline std::size_t VertexArray::getSize() const {
+    return this->allocation->numVertices * this->getLayout().getStride() + this->allocation->indexSize_bytes;
+}
+
 } // namespace age
@@ -0,0 +1,60 @@
+#pragma once
+
+namespace age {
+
+///
+/// \brief Formats in which vertex arrays store the attributes of their vertices.
+///
+/// Vertices are stored interleaved. Quantized positions are stored relative to the bounds of the
+/// vertices. The model matrix must be multiplied by VertexArray::getPositionTransform() to
+/// restore them.
+///
+struct VertexLayout {
+    enum class Position {FLOAT, HALF_FLOAT, NORMALIZED_SHORT};
+    enum class Normal {FLOAT, OCTAHEDRAL};
+    enum class TextureCoordinates {FLOAT, HALF_FLOAT};
+
+    /// Format and offset of an attribute within a vertex
+    struct Attribute {
+        int numComponents;
+        unsigned int type;
+        bool normalized;
+        unsigned int offset_bytes;
+    };
+
+    /// Location of the vertex attribute that tells shaders whether normals are octahedral encoded
+    static constexpr unsigned int NORMAL_ENCODING_LOCATION = 3u;
+
+    ///
+    /// \brief compact Returns the layout with 16 instead of 32 bytes per vertex, i.e. 16 bit
+    ///                positions, octahedral encoded normals and half float texture coordinates.
+    ///
+    static VertexLayout compact();
+
+    Attribute getPositionAttribute() const;
+    Attribute getNormalAttribute() const;
+    Attribute getTextureCoordinatesAttribute() const;
+    unsigned int getStride() const;
+
+    ///
+    /// \brief setAttributePointers Points the attributes of the bound vertex array at the vertices
+    ///                             of the bound GL_ARRAY_BUFFER.
+    ///
+    void setAttributePointers() const;
+
+    ///
+    /// \brief setNormalEncoding Sets the attribute that tells shaders how normals are encoded.
+    ///
+    /// The attribute is not stored per vertex but is part of the context's state so it must be
+    /// set whenever a vertex array of another layout is bound.
+    ///
+    void setNormalEncoding() const;
+
+    bool operator<(const VertexLayout &layout) const;
+
+    Position position = Position::FLOAT;
+    Normal normal = Normal::FLOAT;
+    TextureCoordinates textureCoordinates = TextureCoordinates::FLOAT;
+};
+
+} // namespace age
@@ -3,25 +3,18 @@
 #include <random>
 
 #include <android_game_engine/Box.h>
+#include <android_game_engine/StaticBatch.h>
 #include <android_game_engine/Texture2D.h>
 
 JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI)(JNIEnv *env, jobject activity,
                                                  int width, int height, int rotation) {
+    age::GameEngine::onContextCreated();
     age::GameEngine::onSurfaceCreated(width, height, rotation,
                                       std::make_unique<age::GameActivity>());
 }
 
-JNI_METHOD_DEFINITION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-        float x, float y) {
-    reinterpret_cast<age::GameActivity*>(age::GameEngine::getGame())->onLeftJoystickInput(x, y);
-}
-
-JNI_METHOD_DEFINITION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-        float x, float y) {
-    reinterpret_cast<age::GameActivity*>(age::GameEngine::getGame())->onRightJoystickInput(x, y);
-}
-
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
+    auto lock = age::GameEngine::lockSimulation();
     reinterpret_cast<age::GameActivity*>(age::GameEngine::getGame())->onReset();
 }
 
@@ -51,15 +44,22 @@ void GameActivity::onCreate() {
     floor->setFriction(1.0f);
     this->addToWorldList(floor);
 
-    // Create boxes
+    // The floor never moves so it is drawn from a static batch and only simulated by itself
+    for (auto &batch : StaticBatch::build({floor.get()})) {
+        this->addToWorldList(batch);
+    }
+
+    // Create boxes. They share their textures and only differ in color so that they are drawn
+    // instanced.
     std::mt19937 rand;
     std::uniform_real_distribution<float> color(0.0f, 1.0f);
+    const Texture2D white(glm::vec3(1.0f));
 
     constexpr auto numBoxes = 100u;
     this->boxes.reserve(numBoxes);
     for (auto i = 0u; i < numBoxes; ++i) {
-        this->boxes.push_back(std::shared_ptr<Box>(new Box({Texture2D(glm::vec3(color(rand), color(rand), color(rand)))},
-                                                           {Texture2D(glm::vec3(1.0f))})));
+        this->boxes.push_back(std::shared_ptr<Box>(new Box({white}, {white})));
+        this->boxes.back()->setColor(glm::vec3(color(rand), color(rand), color(rand)));
         this->boxes.back()->setScale(glm::vec3(0.2f));
         this->boxes.back()->setMass(1.0f);
         this->addToWorldList(this->boxes.back());
@@ -68,6 +68,21 @@ void GameActivity::onCreate() {
     this->setRandomBoxPositions();
 }
 
+void GameActivity::onInput(const std::vector<InputEvent> &events) {
+    Game::onInput(events);
+
+    // Joystick 0 is the left joystick and joystick 1 the right one
+    for (const auto &event : events) {
+        if (event.type == InputEvent::Type::JOYSTICK) {
+            if (event.source == 0) {
+                this->onLeftJoystickInput(event.x, event.y);
+            } else {
+                this->onRightJoystickInput(event.x, event.y);
+            }
+        }
+    }
+}
+
 void GameActivity::onLeftJoystickInput(float x, float y) { this->getCam()->onMove({x, y}); }
 
 void GameActivity::onRightJoystickInput(float x, float y) { this->getCam()->onRotate({x, y}); }
@@ -8,10 +8,6 @@
 extern "C" {
 JNI_METHOD_DECLARATION(void, onSurfaceCreatedJNI)(JNIEnv *env, jobject activity,
                                                   int width, int height, int displayRotation);
-JNI_METHOD_DECLARATION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject activity,
-                                                     float x, float y);
-JNI_METHOD_DECLARATION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject activity,
-                                                      float x, float y);
 JNI_METHOD_DECLARATION(void, onResetJNI)(JNIEnv *env, jobject activity);
 }
 
@@ -23,6 +19,8 @@ class GameActivity : public Game {
 public:
     void onCreate() override;
 
+    void onInput(const std::vector<InputEvent> &events) override;
+
     void onLeftJoystickInput(float x, float y);
     void onRightJoystickInput(float x, float y);
 
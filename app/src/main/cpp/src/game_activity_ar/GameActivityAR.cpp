@@ -5,15 +5,13 @@
 
 JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI) (JNIEnv *env, jobject activity,
                                                   int width, int height, int displayRotation) {
+    age::GameEngine::onContextCreated();
     age::GameEngine::onSurfaceCreated(width, height, displayRotation,
                                       std::make_unique<age::GameActivityAR>());
 }
 
-JNI_METHOD_DEFINITION(void, onJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y) {
-    reinterpret_cast<age::GameActivityAR*>(age::GameEngine::getGame())->onJoystickInput(x, y);
-}
-
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
+    auto lock = age::GameEngine::lockSimulation();
     reinterpret_cast<age::GameActivityAR*>(age::GameEngine::getGame())->onReset();
 }
 
@@ -30,6 +28,16 @@ void GameActivityAR::onCreate() {
     this->atvCache->setMass(1.0f);
 }
 
+void GameActivityAR::onInput(const std::vector<InputEvent> &events) {
+    GameAR::onInput(events);
+
+    for (const auto &event : events) {
+        if (event.type == InputEvent::Type::JOYSTICK) {
+            this->onJoystickInput(event.x, event.y);
+        }
+    }
+}
+
 void GameActivityAR::onJoystickInput(float x, float y){
     if (this->atv != nullptr) {
         this->atv->onJoystickInput({x, y});
@@ -46,7 +54,7 @@ void GameActivityAR::onReset() {
     this->clearWorldList();
     this->setState(GameAR::State::TRACK_PLANES);
 
-    GameEngine::callJavaActivityVoidMethod("arPlaneInitialized", "()V");
+    GameEngine::postJavaActivityEvent(AR_PLANE_INITIALIZED_EVENT);
 }
 
 void GameActivityAR::onGameObjectTouched(age::GameObject *gameObject, const glm::vec3 &touchPoint,
@@ -68,7 +76,7 @@ void GameActivityAR::onGameObjectTouched(age::GameObject *gameObject, const glm:
 
         this->setState(GameAR::State::GAMEPLAY);
 
-        GameEngine::callJavaActivityVoidMethod("gameInitialized", "()V");
+        GameEngine::postJavaActivityEvent(GAME_INITIALIZED_EVENT);
     }
 }
 
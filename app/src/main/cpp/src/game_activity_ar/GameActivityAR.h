@@ -9,7 +9,6 @@
 extern "C" {
 JNI_METHOD_DECLARATION(void, onSurfaceCreatedJNI)(JNIEnv *env, jobject activity,
                                                   int width, int height, int displayRotation);
-JNI_METHOD_DECLARATION(void, onJoystickInputJNI)(JNIEnv *env, jobject gameActivity, float x, float y);
 JNI_METHOD_DECLARATION(void, onResetJNI)(JNIEnv *env, jobject gameActivity);
 }
 
@@ -20,8 +19,15 @@ class Vehicle;
 
 class GameActivityAR : public GameAR {
 public:
+    /// Ids of the events posted to GameActivityAR.kt in addition to the ones of GameAR
+    enum Event : int {
+        GAME_INITIALIZED_EVENT = GameAR::LAST_EVENT + 1 ///< The vehicle was placed on the floor
+    };
+
     void onCreate() override;
 
+    void onInput(const std::vector<InputEvent> &events) override;
+
     void onJoystickInput(float x, float y);
 
     void onReset();
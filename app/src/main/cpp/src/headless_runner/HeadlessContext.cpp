@@ -0,0 +1,115 @@
+#include "HeadlessContext.h"
+
+#include <cstring>
+#include <string>
+
+#include <EGL/eglext.h>
+
+#include <android_game_engine/Exception.h>
+
+namespace {
+
+EGLDisplay getDisplay();
+bool hasClientExtension(const char *extension);
+
+EGLDisplay getDisplay() {
+    if (hasClientExtension("EGL_MESA_platform_surfaceless")) {
+        auto eglGetPlatformDisplayEXT = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (eglGetPlatformDisplayEXT != nullptr) {
+            auto display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA,
+                                                    EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY) return display;
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool hasClientExtension(const char *extension) {
+    const auto extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions == nullptr) return false;
+
+    const auto length = std::strlen(extension);
+    for (auto e = std::strstr(extensions, extension); e != nullptr; e = std::strstr(e + length, extension)) {
+        const auto isStart = e == extensions || e[-1] == ' ';
+        const auto isEnd = e[length] == ' ' || e[length] == '\0';
+        if (isStart && isEnd) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+namespace age {
+
+HeadlessContext::HeadlessContext(int width, int height) :
+    display(getDisplay()), surface(EGL_NO_SURFACE), context(EGL_NO_CONTEXT) {
+    if (this->display == EGL_NO_DISPLAY ||
+            !eglInitialize(this->display, nullptr, nullptr)) {
+        throw WindowingSystemError("Failed to initialize EGL display");
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_ES_API)) {
+        eglTerminate(this->display);
+        throw WindowingSystemError("Failed to bind OpenGL ES API");
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_ES3_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_STENCIL_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(this->display, configAttributes, &config, 1, &numConfigs) ||
+            numConfigs == 0) {
+        eglTerminate(this->display);
+        throw WindowingSystemError("Failed to find an OpenGL ES 3 pbuffer EGL config");
+    }
+
+    const EGLint surfaceAttributes[] = {
+        EGL_WIDTH, width,
+        EGL_HEIGHT, height,
+        EGL_NONE
+    };
+    this->surface = eglCreatePbufferSurface(this->display, config, surfaceAttributes);
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 2,
+        EGL_NONE
+    };
+    this->context = eglCreateContext(this->display, config, EGL_NO_CONTEXT, contextAttributes);
+
+    if (this->surface == EGL_NO_SURFACE || this->context == EGL_NO_CONTEXT ||
+            !eglMakeCurrent(this->display, this->surface, this->surface, this->context)) {
+        const auto error = eglGetError();
+        this->destroy();
+        throw WindowingSystemError("Failed to create OpenGL ES 3.2 context, EGL error: " +
+                                   std::to_string(error));
+    }
+}
+
+HeadlessContext::~HeadlessContext() {
+    this->destroy();
+}
+
+void HeadlessContext::swapBuffers() {
+    eglSwapBuffers(this->display, this->surface);
+}
+
+void HeadlessContext::destroy() {
+    eglMakeCurrent(this->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (this->context != EGL_NO_CONTEXT) eglDestroyContext(this->display, this->context);
+    if (this->surface != EGL_NO_SURFACE) eglDestroySurface(this->display, this->surface);
+    eglTerminate(this->display);
+}
+
+} // namespace age
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <EGL/egl.h>
+
+namespace age {
+
+///
+/// \brief Offscreen OpenGL ES 3.2 context for running the engine without a display.
+///
+/// Mesa's surfaceless platform is used when it is available so that no X11/Wayland server is
+/// required. With LIBGL_ALWAYS_SOFTWARE=1 Mesa renders through llvmpipe on machines without a
+/// GPU. The context renders into a pbuffer that acts as the default framebuffer.
+///
+class HeadlessContext {
+public:
+    ///
+    /// Creates the context and makes it current on the calling thread.
+    /// \param width Default framebuffer width
+    /// \param height Default framebuffer height
+    /// \throws WindowingSystemError No suitable EGL display, config or context is available
+    ///
+    HeadlessContext(int width, int height);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext& operator=(const HeadlessContext &) = delete;
+
+    void swapBuffers();
+
+private:
+    void destroy();
+
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+};
+
+} // namespace age
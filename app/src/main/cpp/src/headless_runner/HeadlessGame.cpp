@@ -0,0 +1,59 @@
+#include "HeadlessGame.h"
+
+#include <random>
+
+#include <android_game_engine/Box.h>
+#include <android_game_engine/StaticBatch.h>
+#include <android_game_engine/Texture2D.h>
+
+namespace age {
+
+HeadlessGame::HeadlessGame(unsigned int numBoxes) : numBoxes(numBoxes) {}
+
+void HeadlessGame::onCreate() {
+    Game::onCreate();
+
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+    this->getDirectionalLight()->setLookAtDirection({1.0f, 1.0f, -3.0f});
+
+    this->getCam()->setPosition({-3.0f, 0.0f, 1.5f});
+    this->getCam()->setLookAtPoint({0.5f, 0.0f, 0.7f});
+
+    // Create floor
+    const auto scale = 50.0f;
+    std::shared_ptr<Box> floor(new Box({Texture2D("images/wood.png")},
+                                       {Texture2D(glm::vec3(1.0f))},
+                                       glm::vec2(scale)));
+
+    floor->setLabel("Floor");
+    floor->setScale(glm::vec3{scale, scale, 0.2f});
+    floor->setPosition(glm::vec3(0.0f));
+    floor->setSpecularExponent(32.0f);
+    floor->setFriction(1.0f);
+    this->addToWorldList(floor);
+
+    // The floor never moves so it is drawn from a static batch and only simulated by itself
+    for (auto &batch : StaticBatch::build({floor.get()})) {
+        this->addToWorldList(batch);
+    }
+
+    // Create boxes from a fixed seed so that every run simulates the same scene
+    std::mt19937 rand;
+    std::uniform_real_distribution<float> color(0.0f, 1.0f);
+    std::uniform_real_distribution<float> xy(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> z(0.0f, 3.0f);
+    const Texture2D white(glm::vec3(1.0f));
+
+    this->boxes.reserve(this->numBoxes);
+    for (auto i = 0u; i < this->numBoxes; ++i) {
+        this->boxes.push_back(std::shared_ptr<Box>(new Box({white}, {white})));
+        this->boxes.back()->setColor(glm::vec3(color(rand), color(rand), color(rand)));
+        this->boxes.back()->setScale(glm::vec3(0.2f));
+        this->boxes.back()->setMass(1.0f);
+        this->boxes.back()->setPosition({1.0f + xy(rand), 0.0f + xy(rand), 1.0f + z(rand)});
+        this->addToWorldList(this->boxes.back());
+    }
+}
+
+} // namespace age
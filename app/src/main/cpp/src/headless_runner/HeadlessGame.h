@@ -0,0 +1,26 @@
+#pragma once
+
+#include <android_game_engine/Game.h>
+
+#include <memory>
+#include <vector>
+
+namespace age {
+
+class Box;
+
+///
+/// \brief Deterministic benchmark scene of boxes falling onto a floor.
+///
+class HeadlessGame : public Game {
+public:
+    explicit HeadlessGame(unsigned int numBoxes);
+
+    void onCreate() override;
+
+private:
+    unsigned int numBoxes;
+    std::vector<std::shared_ptr<Box>> boxes;
+};
+
+} // namespace age
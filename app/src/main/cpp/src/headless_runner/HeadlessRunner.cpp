@@ -0,0 +1,292 @@
+///
+/// \brief Drives a Game through a fixed number of frames without a display and reports the
+///        frame times, e.g. for performance regression checks on CI machines without a GPU:
+///
+///     LIBGL_ALWAYS_SOFTWARE=1 headless_runner --frames 600 --trace trace.json
+///
+/// Running twice with the same --program-cache directory compares the startup time with cold
+/// and warm program binaries.
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <GLES3/gl32.h>
+
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/Game.h>
+#include <android_game_engine/GameEngine.h>
+#include <android_game_engine/GeometryArena.h>
+#include <android_game_engine/GLState.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/Profiler.h>
+#include <android_game_engine/ProgramBinaryCache.h>
+#include <android_game_engine/ProgramBuilder.h>
+#include <android_game_engine/ResourceCache.h>
+#include <android_game_engine/TextureStreamer.h>
+
+#include "HeadlessContext.h"
+#include "HeadlessGame.h"
+
+namespace {
+
+struct Options {
+    unsigned int numFrames = 600u;
+    unsigned int numBoxes = 100u;
+    int width = 1280;
+    int height = 720;
+    std::string assetsDirectory = ASSETS_DIR;
+    std::string tracePath;
+    std::string programCacheDirectory;
+    bool simulationThreaded = false;
+};
+
+void printUsage(const char *program);
+bool parseOptions(int argc, char *argv[], Options *options);
+void printFrameTimes(std::vector<double> frameTimes_ms);
+void printCullingStats(const char *pass, const age::CullingStats &stats);
+void printRenderStats(const char *pass, const age::RenderQueue::Stats &stats);
+void printGLStateStats(const age::GLState::Stats &stats);
+void printGeometryArenaStats(const std::vector<age::GeometryArena::Stats> &arenaStats);
+void printResourceCacheStats(const age::ResourceCache::Stats &stats);
+void printTextureStreamingStats(const age::TextureStreamer::Stats &stats);
+void printProgramBinaryStats(const age::ProgramBinaryCache::Stats &stats);
+void printProgramBuilderStats(const age::ProgramBuilder::Stats &stats);
+
+void printUsage(const char *program) {
+    std::printf("Usage: %s [options]\n"
+                "  --frames N      Number of frames to render (default: 600)\n"
+                "  --boxes N       Number of boxes in the scene (default: 100)\n"
+                "  --size WxH      Framebuffer size (default: 1280x720)\n"
+                "  --assets DIR    Assets directory (default: %s)\n"
+                "  --trace FILE    Write a Chrome trace of the run to FILE\n"
+                "  --program-cache DIR\n"
+                "                  Store and load program binaries in DIR\n"
+                "  --threaded      Run the simulation on its own thread\n",
+                program, ASSETS_DIR);
+}
+
+bool parseOptions(int argc, char *argv[], Options *options) {
+    for (auto i = 1; i < argc; ++i) {
+        const auto hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--frames") == 0 && hasValue) {
+            options->numFrames = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--boxes") == 0 && hasValue) {
+            options->numBoxes = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--size") == 0 && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &options->width, &options->height) != 2) return false;
+        } else if (std::strcmp(argv[i], "--assets") == 0 && hasValue) {
+            options->assetsDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            options->tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--program-cache") == 0 && hasValue) {
+            options->programCacheDirectory = argv[++i];
+        } else if (std::strcmp(argv[i], "--threaded") == 0) {
+            options->simulationThreaded = true;
+        } else {
+            return false;
+        }
+    }
+    return options->numFrames > 0u && options->width > 0 && options->height > 0;
+}
+
+void printFrameTimes(std::vector<double> frameTimes_ms) {
+    std::sort(frameTimes_ms.begin(), frameTimes_ms.end());
+
+    auto total_ms = 0.0;
+    for (auto frameTime_ms : frameTimes_ms) {
+        total_ms += frameTime_ms;
+    }
+
+    const auto percentile = [&frameTimes_ms](double p) {
+        return frameTimes_ms[static_cast<std::size_t>(p * (frameTimes_ms.size() - 1u))];
+    };
+
+    std::printf("frames: %zu\n", frameTimes_ms.size());
+    std::printf("mean_ms: %.3f\n", total_ms / frameTimes_ms.size());
+    std::printf("p50_ms: %.3f\n", percentile(0.5));
+    std::printf("p95_ms: %.3f\n", percentile(0.95));
+    std::printf("p99_ms: %.3f\n", percentile(0.99));
+    std::printf("max_ms: %.3f\n", frameTimes_ms.back());
+}
+
+void printCullingStats(const char *pass, const age::CullingStats &stats) {
+    std::printf("%s_visible: %u\n", pass, stats.numVisible);
+    std::printf("%s_culled: %u\n", pass, stats.numCulled);
+}
+
+void printRenderStats(const char *pass, const age::RenderQueue::Stats &stats) {
+    std::printf("%s_items: %u\n", pass, stats.numItems);
+    std::printf("%s_draw_calls: %u\n", pass, stats.numDrawCalls);
+    std::printf("%s_shader_changes: %u\n", pass, stats.numShaderChanges);
+    std::printf("%s_texture_changes: %u\n", pass, stats.numTextureChanges);
+    std::printf("%s_vertex_array_changes: %u\n", pass, stats.numVertexArrayChanges);
+}
+
+void printGLStateStats(const age::GLState::Stats &stats) {
+    std::printf("gl_state_calls_issued: %u\n", stats.numIssued);
+    std::printf("gl_state_calls_filtered: %u\n", stats.numFiltered);
+}
+
+void printGeometryArenaStats(const std::vector<age::GeometryArena::Stats> &arenaStats) {
+    // Sizes are summed over the arenas and fragmentation is that of the worst arena
+    age::GeometryArena::Stats total;
+    auto vertexFragmentation = 0.0f;
+    auto indexFragmentation = 0.0f;
+    for (const auto &stats : arenaStats) {
+        total.numAllocations += stats.numAllocations;
+        total.vertexCapacity_bytes += stats.vertexCapacity_bytes;
+        total.vertexUsed_bytes += stats.vertexUsed_bytes;
+        total.indexCapacity_bytes += stats.indexCapacity_bytes;
+        total.indexUsed_bytes += stats.indexUsed_bytes;
+        total.numCompactions += stats.numCompactions;
+        vertexFragmentation = std::max(vertexFragmentation, stats.getVertexFragmentation());
+        indexFragmentation = std::max(indexFragmentation, stats.getIndexFragmentation());
+    }
+
+    std::printf("geometry_arenas: %zu\n", arenaStats.size());
+    std::printf("geometry_allocations: %u\n", total.numAllocations);
+    std::printf("geometry_vertex_used_bytes: %zu\n", total.vertexUsed_bytes);
+    std::printf("geometry_vertex_capacity_bytes: %zu\n", total.vertexCapacity_bytes);
+    std::printf("geometry_vertex_fragmentation: %.3f\n", vertexFragmentation);
+    std::printf("geometry_index_used_bytes: %zu\n", total.indexUsed_bytes);
+    std::printf("geometry_index_capacity_bytes: %zu\n", total.indexCapacity_bytes);
+    std::printf("geometry_index_fragmentation: %.3f\n", indexFragmentation);
+    std::printf("geometry_compactions: %u\n", total.numCompactions);
+}
+
+void printResourceCacheStats(const age::ResourceCache::Stats &stats) {
+    std::printf("resource_cache_resources: %u\n", stats.numResources);
+    std::printf("resource_cache_unused: %u\n", stats.numUnused);
+    std::printf("resource_cache_used_bytes: %zu\n", stats.used_bytes);
+    std::printf("resource_cache_unused_bytes: %zu\n", stats.unused_bytes);
+    std::printf("resource_cache_hits: %u\n", stats.numHits);
+    std::printf("resource_cache_misses: %u\n", stats.numMisses);
+    std::printf("resource_cache_evictions: %u\n", stats.numEvictions);
+}
+
+void printTextureStreamingStats(const age::TextureStreamer::Stats &stats) {
+    std::printf("texture_streaming_streams: %u\n", stats.numStreams);
+    std::printf("texture_streaming_reloading: %u\n", stats.numReloading);
+    std::printf("texture_streaming_resident_bytes: %zu\n", stats.resident_bytes);
+    std::printf("texture_streaming_budget_bytes: %zu\n", stats.budget_bytes);
+    std::printf("texture_streaming_upgrades: %u\n", stats.numUpgrades);
+    std::printf("texture_streaming_downgrades: %u\n", stats.numDowngrades);
+}
+
+void printProgramBinaryStats(const age::ProgramBinaryCache::Stats &stats) {
+    std::printf("program_binaries_loaded: %u\n", stats.numLoaded);
+    std::printf("program_binaries_rejected: %u\n", stats.numRejected);
+    std::printf("program_binaries_stored: %u\n", stats.numStored);
+}
+
+void printProgramBuilderStats(const age::ProgramBuilder::Stats &stats) {
+    std::printf("programs_built: %u\n", stats.numBuilt);
+    std::printf("programs_built_in_parallel: %d\n", stats.parallel ? 1 : 0);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        age::HeadlessContext context(options.width, options.height);
+        age::ManagerAssets::init(options.assetsDirectory);
+        age::Profiler::setEnabled(!options.tracePath.empty());
+        age::GameEngine::setSimulationThreaded(options.simulationThreaded);
+        if (!options.programCacheDirectory.empty()) {
+            age::ProgramBinaryCache::init(options.programCacheDirectory);
+        }
+
+        // Startup includes building the game's shader programs. Frames are rendered without the
+        // programs that are still being built, which does not advance the simulation.
+        const auto startupStart = std::chrono::steady_clock::now();
+        age::GameEngine::onContextCreated();
+        age::GameEngine::onSurfaceCreated(options.width, options.height, 0,
+                                          std::make_unique<age::HeadlessGame>(options.numBoxes));
+        double firstFrame_ms = 0.0;
+        auto numLoadingFrames = 0u;
+        do {
+            age::GameEngine::update(std::chrono::duration<float>(0.0f));
+            glFinish();
+            context.swapBuffers();
+            if (numLoadingFrames++ == 0u) {
+                firstFrame_ms = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - startupStart).count();
+            }
+        } while (!age::GameEngine::areShadersReady());
+        const auto startup_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - startupStart).count();
+
+        // Every frame advances the simulation by one tick so that runs are reproducible
+        const std::chrono::duration<float> frameDuration(1.0f / 60.0f);
+        std::vector<double> frameTimes_ms;
+        frameTimes_ms.reserve(options.numFrames);
+
+        for (auto i = 0u; i < options.numFrames; ++i) {
+            const auto start = std::chrono::steady_clock::now();
+            age::GameEngine::update(frameDuration);
+
+            // Include the GPU work of the frame in its time
+            glFinish();
+            frameTimes_ms.push_back(std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count());
+            context.swapBuffers();
+        }
+
+        // Culling and render stats of the last frame
+        const auto game = age::GameEngine::getGame();
+        const auto worldPassCullingStats = game->getWorldPassCullingStats();
+        const auto shadowPassCullingStats = game->getShadowPassCullingStats();
+        const auto worldPassRenderStats = game->getWorldPassRenderStats();
+        const auto glStateStats = age::GLState::getLastFrameStats();
+
+        std::vector<age::GeometryArena::Stats> geometryArenaStats;
+        for (const auto &arena : age::GeometryArena::getArenas()) {
+            geometryArenaStats.push_back(arena->getStats());
+        }
+        const auto resourceCacheStats = age::ResourceCache::getStats();
+        const auto textureStreamingStats = age::TextureStreamer::getStats();
+
+        age::GameEngine::onPause();
+        age::GameEngine::onStop();
+        age::GameEngine::onDestroy();
+        age::ManagerAssets::shutdown();
+
+        std::printf("first_frame_ms: %.3f\n", firstFrame_ms);
+        std::printf("startup_ms: %.3f\n", startup_ms);
+        std::printf("loading_frames: %u\n", numLoadingFrames);
+        printFrameTimes(frameTimes_ms);
+        printCullingStats("world_pass", worldPassCullingStats);
+        printCullingStats("shadow_pass", shadowPassCullingStats);
+        printRenderStats("world_pass", worldPassRenderStats);
+        printGLStateStats(glStateStats);
+        printGeometryArenaStats(geometryArenaStats);
+        printResourceCacheStats(resourceCacheStats);
+        printTextureStreamingStats(textureStreamingStats);
+        printProgramBinaryStats(age::ProgramBinaryCache::getStats());
+        printProgramBuilderStats(age::ProgramBuilder::getStats());
+
+        if (!options.tracePath.empty() && !age::Profiler::writeChromeTrace(options.tracePath)) {
+            age::Log::error("Failed to write trace: " + options.tracePath);
+            return EXIT_FAILURE;
+        }
+    } catch (const age::Error &e) {
+        age::Log::fatal(e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,200 @@
+///
+/// \brief Reports the effect of every import time mesh optimization on the vertex count and the
+///        average cache miss ratio (ACMR) of models, by default of the bundled models:
+///
+///     mesh_benchmark [--assets DIR] [MODEL...]
+///
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#include <android_game_engine/AssimpIOSystem.h>
+#include <android_game_engine/Exception.h>
+#include <android_game_engine/Log.h>
+#include <android_game_engine/ManagerAssets.h>
+#include <android_game_engine/MeshOptimizer.h>
+#include <android_game_engine/Vertex.h>
+
+namespace {
+
+const std::vector<std::string> BUNDLED_MODELS {
+    "models/atv/ATV.3DS"
+};
+
+struct Geometry {
+    std::vector<age::Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Cache misses of a model after each optimization
+struct ModelStats {
+    std::size_t numTriangles = 0u;
+    std::size_t numVerticesInFile = 0u;
+    std::size_t numVerticesDeduplicated = 0u;
+    std::size_t numCacheMissesInFile = 0u;
+    std::size_t numCacheMissesDeduplicated = 0u;
+    std::size_t numCacheMissesVertexCache = 0u;
+    std::size_t numCacheMissesOverdraw = 0u;
+    double optimizeTime_ms = 0.0;
+};
+
+void printUsage(const char *program);
+
+// Geometry of the triangles of a model grouped by material like GameObject imports it
+std::map<unsigned int, Geometry> loadGeometry(const std::string &modelFilepath);
+
+ModelStats optimize(Geometry *geometry);
+void printStats(const std::string &modelFilepath, const ModelStats &stats);
+
+void printUsage(const char *program) {
+    std::printf("Usage: %s [options] [MODEL...]\n"
+                "  --assets DIR    Assets directory (default: %s)\n"
+                "  MODEL           Model relative to the assets directory (default: bundled models)\n",
+                program, ASSETS_DIR);
+}
+
+std::map<unsigned int, Geometry> loadGeometry(const std::string &modelFilepath) {
+    Assimp::Importer importer;
+    importer.SetIOHandler(new age::AssimpIOSystem);
+
+    const auto scene = importer.ReadFile(modelFilepath, aiProcess_Triangulate);
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        throw age::LoadError("Failed to load model from: " + modelFilepath);
+    }
+
+    std::map<unsigned int, Geometry> geometry;
+    for (auto m = 0u; m < scene->mNumMeshes; ++m) {
+        const auto mesh = scene->mMeshes[m];
+        auto &materialGeometry = geometry[mesh->mMaterialIndex];
+        const auto baseVertex = static_cast<unsigned int>(materialGeometry.vertices.size());
+
+        for (auto i = 0u; i < mesh->mNumVertices; ++i) {
+            const auto &position = mesh->mVertices[i];
+            const auto normal = mesh->mNormals ? mesh->mNormals[i] : aiVector3D(0.0f);
+            materialGeometry.vertices.emplace_back(
+                    glm::vec3(position.x, position.y, position.z),
+                    glm::vec3(normal.x, normal.y, normal.z),
+                    mesh->mTextureCoords[0] ?
+                        glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) :
+                        glm::vec2(0.0f));
+        }
+
+        for (auto f = 0u; f < mesh->mNumFaces; ++f) {
+            const auto &face = mesh->mFaces[f];
+            if (face.mNumIndices != 3u) continue;
+
+            for (auto i = 0u; i < 3u; ++i) {
+                materialGeometry.indices.push_back(baseVertex + face.mIndices[i]);
+            }
+        }
+    }
+
+    return geometry;
+}
+
+ModelStats optimize(Geometry *geometry) {
+    namespace MeshOptimizer = age::MeshOptimizer;
+
+    auto &vertices = geometry->vertices;
+    auto &indices = geometry->indices;
+
+    ModelStats stats;
+    stats.numTriangles = indices.size() / 3u;
+    stats.numVerticesInFile = vertices.size();
+    stats.numCacheMissesInFile = MeshOptimizer::countCacheMisses(indices, vertices.size());
+
+    const auto start = std::chrono::steady_clock::now();
+    MeshOptimizer::deduplicateVertices(&vertices, &indices);
+    stats.numVerticesDeduplicated = vertices.size();
+    stats.numCacheMissesDeduplicated = MeshOptimizer::countCacheMisses(indices, vertices.size());
+
+    const auto clusters = MeshOptimizer::optimizeVertexCache(&indices, vertices.size());
+    stats.numCacheMissesVertexCache = MeshOptimizer::countCacheMisses(indices, vertices.size());
+
+    MeshOptimizer::optimizeOverdraw(vertices, &indices, clusters);
+    stats.numCacheMissesOverdraw = MeshOptimizer::countCacheMisses(indices, vertices.size());
+
+    MeshOptimizer::optimizeVertexFetch(&vertices, &indices);
+    stats.optimizeTime_ms = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start).count();
+
+    return stats;
+}
+
+void printStats(const std::string &modelFilepath, const ModelStats &stats) {
+    const auto acmr = [&stats](std::size_t numCacheMisses) {
+        return stats.numTriangles == 0u ? 0.0 :
+               static_cast<double>(numCacheMisses) / static_cast<double>(stats.numTriangles);
+    };
+
+    std::printf("model: %s\n", modelFilepath.c_str());
+    std::printf("triangles: %zu\n", stats.numTriangles);
+    std::printf("vertices_in_file: %zu\n", stats.numVerticesInFile);
+    std::printf("vertices_deduplicated: %zu\n", stats.numVerticesDeduplicated);
+    std::printf("acmr_in_file: %.3f\n", acmr(stats.numCacheMissesInFile));
+    std::printf("acmr_deduplicated: %.3f\n", acmr(stats.numCacheMissesDeduplicated));
+    std::printf("acmr_vertex_cache: %.3f\n", acmr(stats.numCacheMissesVertexCache));
+    std::printf("acmr_overdraw: %.3f\n", acmr(stats.numCacheMissesOverdraw));
+    std::printf("optimize_ms: %.3f\n", stats.optimizeTime_ms);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string assetsDirectory = ASSETS_DIR;
+    std::vector<std::string> modelFilepaths;
+    for (auto i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--assets") == 0 && i + 1 < argc) {
+            assetsDirectory = argv[++i];
+        } else if (argv[i][0] == '-') {
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        } else {
+            modelFilepaths.emplace_back(argv[i]);
+        }
+    }
+    if (modelFilepaths.empty()) {
+        modelFilepaths = BUNDLED_MODELS;
+    }
+
+    try {
+        age::ManagerAssets::init(assetsDirectory);
+
+        for (const auto &modelFilepath : modelFilepaths) {
+            // Materials are optimized separately but reported together
+            ModelStats modelStats;
+            auto geometry = loadGeometry(modelFilepath);
+            for (auto &materialGeometry : geometry) {
+                const auto stats = optimize(&materialGeometry.second);
+                modelStats.numTriangles += stats.numTriangles;
+                modelStats.numVerticesInFile += stats.numVerticesInFile;
+                modelStats.numVerticesDeduplicated += stats.numVerticesDeduplicated;
+                modelStats.numCacheMissesInFile += stats.numCacheMissesInFile;
+                modelStats.numCacheMissesDeduplicated += stats.numCacheMissesDeduplicated;
+                modelStats.numCacheMissesVertexCache += stats.numCacheMissesVertexCache;
+                modelStats.numCacheMissesOverdraw += stats.numCacheMissesOverdraw;
+                modelStats.optimizeTime_ms += stats.optimizeTime_ms;
+            }
+            printStats(modelFilepath, modelStats);
+        }
+
+        age::ManagerAssets::shutdown();
+    } catch (const age::Error &e) {
+        age::Log::fatal(e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
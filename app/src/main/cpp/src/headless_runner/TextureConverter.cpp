@@ -0,0 +1,505 @@
+///
+/// \brief Converts images to KTX2 files with ETC2 compressed mip levels that Texture2D and
+///        Skybox upload without decoding:
+///
+///     texture_converter [--srgb] [--no-mipmaps] OUTPUT INPUT       2D texture
+///     texture_converter [--srgb] [--no-mipmaps] OUTPUT INPUT x6    Cubemap in the face order
+///                                                                  front, back, right, left,
+///                                                                  top, bottom
+///
+/// Opaque images are stored as ETC2 RGB8 (4 bits per pixel) and others as ETC2 RGBA8 with EAC
+/// alpha (8 bits per pixel). The RGB blocks only use the ETC1 compatible modes. For ASTC use an
+/// external encoder such as astcenc with toktx.
+///
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <stb_image.h>
+
+#include <android_game_engine/KTX2.h>
+
+namespace {
+
+struct Options {
+    bool srgb = false;
+    bool mipmaps = true;
+    std::string outputFilepath;
+    std::vector<std::string> inputFilepaths;
+};
+
+struct RGBAImage {
+    int width;
+    int height;
+    std::vector<std::uint8_t> pixels;
+};
+
+// Modifiers of the ETC1 intensity tables
+constexpr int ETC_MODIFIERS[8][2] {
+    {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183}
+};
+
+// Modifiers of the EAC alpha tables
+constexpr int EAC_MODIFIERS[16][8] {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9}, {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9}, {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9}, {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8}, {-3, -5, -7, -9, 2, 4, 6, 8}
+};
+
+// Data format descriptor values of the Khronos Data Format specification
+constexpr std::uint32_t KHR_DF_MODEL_ETC2 = 161u;
+constexpr std::uint32_t KHR_DF_CHANNEL_ETC2_COLOR = 2u;
+constexpr std::uint32_t KHR_DF_CHANNEL_ETC2_ALPHA = 15u;
+constexpr std::uint32_t KHR_DF_PRIMARIES_BT709 = 1u;
+constexpr std::uint32_t KHR_DF_TRANSFER_LINEAR = 1u;
+constexpr std::uint32_t KHR_DF_TRANSFER_SRGB = 2u;
+
+// A 4x4 block of RGBA pixels in column major order like the pixel indices of ETC blocks
+using Block = std::array<std::array<int, 4>, 16>;
+
+void printUsage(const char *program);
+bool parseOptions(int argc, char *argv[], Options *options);
+
+RGBAImage loadImage(const std::string &filepath, bool flip);
+RGBAImage downsample(const RGBAImage &image);
+Block readBlock(const RGBAImage &image, int x, int y);
+
+// Encodes the colors of a block in the individual or differential mode of ETC1, which ETC2
+// decodes the same, with the smallest squared error
+std::uint64_t encodeColorBlock(const Block &block);
+std::uint64_t encodeAlphaBlock(const Block &block);
+
+std::vector<std::uint8_t> compress(const RGBAImage &image, bool alpha);
+bool writeKTX2(const std::string &filepath, std::uint32_t vkFormat, bool srgb, int width,
+               int height, const std::vector<std::vector<std::vector<std::uint8_t>>> &levels);
+
+void appendBigEndian(std::uint64_t value, std::vector<std::uint8_t> *data);
+void appendLittleEndian(std::uint64_t value, std::size_t size, std::vector<std::uint8_t> *data);
+
+void printUsage(const char *program) {
+    std::printf("Usage: %s [options] OUTPUT INPUT [INPUT x5]\n"
+                "  --srgb          Mark the colors as sRGB encoded\n"
+                "  --no-mipmaps    Only store the base level\n"
+                "  OUTPUT          KTX2 file to write\n"
+                "  INPUT           Image of a 2D texture or 6 images of the faces of a cubemap\n",
+                program);
+}
+
+bool parseOptions(int argc, char *argv[], Options *options) {
+    std::vector<std::string> filepaths;
+    for (auto i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--srgb") == 0) {
+            options->srgb = true;
+        } else if (std::strcmp(argv[i], "--no-mipmaps") == 0) {
+            options->mipmaps = false;
+        } else if (argv[i][0] == '-') {
+            return false;
+        } else {
+            filepaths.emplace_back(argv[i]);
+        }
+    }
+
+    if (filepaths.size() != 2u && filepaths.size() != 7u) return false;
+
+    options->outputFilepath = filepaths.front();
+    options->inputFilepaths.assign(filepaths.cbegin() + 1, filepaths.cend());
+    return true;
+}
+
+RGBAImage loadImage(const std::string &filepath, bool flip) {
+    RGBAImage image;
+    int numChannels;
+    stbi_set_flip_vertically_on_load(flip);
+    const auto pixels = stbi_load(filepath.c_str(), &image.width, &image.height, &numChannels, 4);
+    if (!pixels) return image;
+
+    image.pixels.assign(pixels, pixels + image.width * image.height * 4);
+    stbi_image_free(pixels);
+    return image;
+}
+
+RGBAImage downsample(const RGBAImage &image) {
+    RGBAImage level;
+    level.width = std::max(image.width / 2, 1);
+    level.height = std::max(image.height / 2, 1);
+    level.pixels.resize(level.width * level.height * 4);
+
+    // Box filter that clamps to the edge of odd sizes
+    for (auto y = 0; y < level.height; ++y) {
+        for (auto x = 0; x < level.width; ++x) {
+            const auto x0 = std::min(2 * x, image.width - 1), x1 = std::min(2 * x + 1, image.width - 1);
+            const auto y0 = std::min(2 * y, image.height - 1), y1 = std::min(2 * y + 1, image.height - 1);
+            for (auto c = 0; c < 4; ++c) {
+                const auto sum = image.pixels[(y0 * image.width + x0) * 4 + c] +
+                                 image.pixels[(y0 * image.width + x1) * 4 + c] +
+                                 image.pixels[(y1 * image.width + x0) * 4 + c] +
+                                 image.pixels[(y1 * image.width + x1) * 4 + c];
+                level.pixels[(y * level.width + x) * 4 + c] = static_cast<std::uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+    return level;
+}
+
+Block readBlock(const RGBAImage &image, int x, int y) {
+    Block block;
+    for (auto i = 0; i < 16; ++i) {
+        // Blocks beyond the edge of the image repeat its last row and column
+        const auto px = std::min(x + i / 4, image.width - 1);
+        const auto py = std::min(y + i % 4, image.height - 1);
+        for (auto c = 0; c < 4; ++c) {
+            block[i][c] = image.pixels[(py * image.width + px) * 4 + c];
+        }
+    }
+    return block;
+}
+
+std::uint64_t encodeColorBlock(const Block &block) {
+    auto bestError = std::numeric_limits<int>::max();
+    std::uint64_t bestBits = 0u;
+
+    for (auto flip = 0; flip < 2; ++flip) {
+        // Pixels of the two sub-blocks, side by side or on top of each other if flipped
+        std::array<std::array<int, 8>, 2> subBlocks;
+        std::array<int, 2> numPixels {0, 0};
+        for (auto i = 0; i < 16; ++i) {
+            const auto s = flip ? (i % 4) / 2 : (i / 4) / 2;
+            subBlocks[s][numPixels[s]++] = i;
+        }
+
+        std::array<std::array<int, 3>, 2> averages;
+        for (auto s = 0; s < 2; ++s) {
+            for (auto c = 0; c < 3; ++c) {
+                auto sum = 0;
+                for (const auto i : subBlocks[s]) sum += block[i][c];
+                averages[s][c] = (sum + 4) / 8;
+            }
+        }
+
+        for (auto differential = 0; differential < 2; ++differential) {
+            // Quantize the base colors to 5 bits with 3 bit deltas or to 4 bits each
+            std::array<std::array<int, 3>, 2> quantized, bases;
+            auto representable = true;
+            for (auto s = 0; s < 2; ++s) {
+                for (auto c = 0; c < 3; ++c) {
+                    if (differential) {
+                        quantized[s][c] = (averages[s][c] * 31 + 127) / 255;
+                        bases[s][c] = quantized[s][c] << 3 | quantized[s][c] >> 2;
+                    } else {
+                        quantized[s][c] = (averages[s][c] * 15 + 127) / 255;
+                        bases[s][c] = quantized[s][c] * 17;
+                    }
+                }
+            }
+            if (differential) {
+                for (auto c = 0; c < 3; ++c) {
+                    const auto delta = quantized[1][c] - quantized[0][c];
+                    representable = representable && delta >= -4 && delta <= 3;
+                }
+            }
+            if (!representable) continue;
+
+            std::uint64_t bits = 0u;
+            std::array<std::uint32_t, 2> tables;
+            std::uint32_t msbs = 0u, lsbs = 0u;
+            auto blockError = 0;
+
+            for (auto s = 0; s < 2; ++s) {
+                auto bestTableError = std::numeric_limits<int>::max();
+                std::uint32_t bestMsbs = 0u, bestLsbs = 0u;
+
+                for (auto t = 0u; t < 8u; ++t) {
+                    const int modifiers[4] {ETC_MODIFIERS[t][0], ETC_MODIFIERS[t][1],
+                                            -ETC_MODIFIERS[t][0], -ETC_MODIFIERS[t][1]};
+                    auto tableError = 0;
+                    std::uint32_t tableMsbs = 0u, tableLsbs = 0u;
+
+                    for (const auto i : subBlocks[s]) {
+                        auto bestPixelError = std::numeric_limits<int>::max();
+                        auto bestModifier = 0u;
+                        for (auto m = 0u; m < 4u; ++m) {
+                            auto pixelError = 0;
+                            for (auto c = 0; c < 3; ++c) {
+                                const auto value = std::min(std::max(bases[s][c] + modifiers[m], 0), 255);
+                                pixelError += (value - block[i][c]) * (value - block[i][c]);
+                            }
+                            if (pixelError < bestPixelError) {
+                                bestPixelError = pixelError;
+                                bestModifier = m;
+                            }
+                        }
+                        tableError += bestPixelError;
+                        tableMsbs |= (bestModifier >> 1u) << i;
+                        tableLsbs |= (bestModifier & 1u) << i;
+                    }
+
+                    if (tableError < bestTableError) {
+                        bestTableError = tableError;
+                        tables[s] = t;
+                        bestMsbs = tableMsbs;
+                        bestLsbs = tableLsbs;
+                    }
+                }
+
+                blockError += bestTableError;
+                msbs |= bestMsbs;
+                lsbs |= bestLsbs;
+            }
+
+            if (blockError >= bestError) continue;
+
+            for (auto c = 0; c < 3; ++c) {
+                const auto shift = 59u - 8u * c;
+                if (differential) {
+                    bits |= static_cast<std::uint64_t>(quantized[0][c]) << shift;
+                    bits |= static_cast<std::uint64_t>((quantized[1][c] - quantized[0][c]) & 7) << (shift - 3u);
+                } else {
+                    bits |= static_cast<std::uint64_t>(quantized[0][c]) << (shift + 1u);
+                    bits |= static_cast<std::uint64_t>(quantized[1][c]) << (shift - 3u);
+                }
+            }
+            bits |= static_cast<std::uint64_t>(tables[0]) << 37u | static_cast<std::uint64_t>(tables[1]) << 34u;
+            bits |= static_cast<std::uint64_t>(differential) << 33u | static_cast<std::uint64_t>(flip) << 32u;
+            bits |= static_cast<std::uint64_t>(msbs) << 16u | lsbs;
+
+            bestError = blockError;
+            bestBits = bits;
+        }
+    }
+
+    return bestBits;
+}
+
+std::uint64_t encodeAlphaBlock(const Block &block) {
+    auto min = 255, max = 0;
+    for (const auto &pixel : block) {
+        min = std::min(min, pixel[3]);
+        max = std::max(max, pixel[3]);
+    }
+
+    auto bestError = std::numeric_limits<int>::max();
+    std::uint64_t bestBits = 0u;
+    for (auto t = 0u; t < 16u; ++t) {
+        // Spread the modifiers of the table over the range of the alpha values
+        const auto &modifiers = EAC_MODIFIERS[t];
+        const auto spread = modifiers[7] - modifiers[3];
+        const auto multiplier = std::min(std::max((max - min + spread / 2) / spread, 1), 15);
+        const auto base = std::min(std::max((min + max) / 2 - multiplier * (modifiers[7] + modifiers[3]) / 2, 0), 255);
+
+        auto error = 0;
+        std::uint64_t indices = 0u;
+        for (auto i = 0; i < 16; ++i) {
+            auto bestPixelError = std::numeric_limits<int>::max();
+            auto bestIndex = 0u;
+            for (auto m = 0u; m < 8u; ++m) {
+                const auto value = std::min(std::max(base + modifiers[m] * multiplier, 0), 255);
+                const auto pixelError = (value - block[i][3]) * (value - block[i][3]);
+                if (pixelError < bestPixelError) {
+                    bestPixelError = pixelError;
+                    bestIndex = m;
+                }
+            }
+            error += bestPixelError;
+            indices |= static_cast<std::uint64_t>(bestIndex) << (45u - 3u * i);
+        }
+
+        if (error < bestError) {
+            bestError = error;
+            bestBits = static_cast<std::uint64_t>(base) << 56u |
+                       static_cast<std::uint64_t>(multiplier) << 52u |
+                       static_cast<std::uint64_t>(t) << 48u | indices;
+        }
+    }
+    return bestBits;
+}
+
+std::vector<std::uint8_t> compress(const RGBAImage &image, bool alpha) {
+    std::vector<std::uint8_t> data;
+    for (auto y = 0; y < image.height; y += 4) {
+        for (auto x = 0; x < image.width; x += 4) {
+            const auto block = readBlock(image, x, y);
+            if (alpha) {
+                appendBigEndian(encodeAlphaBlock(block), &data);
+            }
+            appendBigEndian(encodeColorBlock(block), &data);
+        }
+    }
+    return data;
+}
+
+bool writeKTX2(const std::string &filepath, std::uint32_t vkFormat, bool srgb, int width,
+               int height, const std::vector<std::vector<std::vector<std::uint8_t>>> &levels) {
+    const auto alpha = vkFormat == age::KTX2::VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK ||
+                       vkFormat == age::KTX2::VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK;
+    const auto numFaces = levels.front().size();
+    const auto numLevels = levels.size();
+
+    // Basic data format descriptor with a sample per ETC2 channel
+    const auto numSamples = alpha ? 2u : 1u;
+    const auto descriptorBlockSize_bytes = 24u + 16u * numSamples;
+    std::vector<std::uint8_t> dfd;
+    appendLittleEndian(4u + descriptorBlockSize_bytes, 4u, &dfd);
+    appendLittleEndian(0u, 4u, &dfd);
+    appendLittleEndian(2u | descriptorBlockSize_bytes << 16u, 4u, &dfd);
+    appendLittleEndian(KHR_DF_MODEL_ETC2 | KHR_DF_PRIMARIES_BT709 << 8u |
+                       (srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16u, 4u, &dfd);
+    appendLittleEndian(3u | 3u << 8u, 4u, &dfd);
+    appendLittleEndian(alpha ? 16u : 8u, 4u, &dfd);
+    appendLittleEndian(0u, 4u, &dfd);
+    for (auto s = 0u; s < numSamples; ++s) {
+        const auto channel = alpha && s == 0u ? KHR_DF_CHANNEL_ETC2_ALPHA : KHR_DF_CHANNEL_ETC2_COLOR;
+        appendLittleEndian(64u * s | 63u << 16u | channel << 24u, 4u, &dfd);
+        appendLittleEndian(0u, 4u, &dfd);
+        appendLittleEndian(0u, 4u, &dfd);
+        appendLittleEndian(std::numeric_limits<std::uint32_t>::max(), 4u, &dfd);
+    }
+
+    // Mip levels are stored from the smallest and aligned to the block size
+    const std::size_t alignment_bytes = alpha ? 16u : 8u;
+    const auto dfdOffset_bytes = age::KTX2::HEADER_SIZE_bytes +
+                                 numLevels * age::KTX2::LEVEL_INDEX_ENTRY_SIZE_bytes;
+    auto offset_bytes = dfdOffset_bytes + dfd.size();
+    std::vector<std::size_t> levelOffsets_bytes(numLevels), levelSizes_bytes(numLevels);
+    for (auto i = numLevels; i > 0u; --i) {
+        offset_bytes = (offset_bytes + alignment_bytes - 1u) / alignment_bytes * alignment_bytes;
+        levelOffsets_bytes[i - 1u] = offset_bytes;
+        levelSizes_bytes[i - 1u] = levels[i - 1u].front().size() * numFaces;
+        offset_bytes += levelSizes_bytes[i - 1u];
+    }
+
+    std::vector<std::uint8_t> file(age::KTX2::IDENTIFIER,
+                                   age::KTX2::IDENTIFIER + age::KTX2::IDENTIFIER_SIZE);
+    appendLittleEndian(vkFormat, 4u, &file);
+    appendLittleEndian(1u, 4u, &file);
+    appendLittleEndian(width, 4u, &file);
+    appendLittleEndian(height, 4u, &file);
+    appendLittleEndian(0u, 4u, &file);
+    appendLittleEndian(0u, 4u, &file);
+    appendLittleEndian(numFaces, 4u, &file);
+    appendLittleEndian(numLevels, 4u, &file);
+    appendLittleEndian(0u, 4u, &file);
+
+    appendLittleEndian(dfdOffset_bytes, 4u, &file);
+    appendLittleEndian(dfd.size(), 4u, &file);
+    appendLittleEndian(0u, 4u, &file);
+    appendLittleEndian(0u, 4u, &file);
+    appendLittleEndian(0u, 8u, &file);
+    appendLittleEndian(0u, 8u, &file);
+
+    for (auto i = 0u; i < numLevels; ++i) {
+        appendLittleEndian(levelOffsets_bytes[i], 8u, &file);
+        appendLittleEndian(levelSizes_bytes[i], 8u, &file);
+        appendLittleEndian(levelSizes_bytes[i], 8u, &file);
+    }
+    file.insert(file.end(), dfd.cbegin(), dfd.cend());
+
+    for (auto i = numLevels; i > 0u; --i) {
+        file.resize(levelOffsets_bytes[i - 1u], 0u);
+        for (const auto &face : levels[i - 1u]) {
+            file.insert(file.end(), face.cbegin(), face.cend());
+        }
+    }
+
+    const auto output = std::fopen(filepath.c_str(), "wb");
+    if (!output) return false;
+
+    const auto written = std::fwrite(file.data(), 1u, file.size(), output) == file.size();
+    return std::fclose(output) == 0 && written;
+}
+
+void appendBigEndian(std::uint64_t value, std::vector<std::uint8_t> *data) {
+    for (auto i = 8u; i > 0u; --i) {
+        data->push_back(static_cast<std::uint8_t>(value >> (8u * (i - 1u))));
+    }
+}
+
+void appendLittleEndian(std::uint64_t value, std::size_t size, std::vector<std::uint8_t> *data) {
+    for (auto i = 0u; i < size; ++i) {
+        data->push_back(static_cast<std::uint8_t>(value >> (8u * i)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // 2D textures are flipped like Texture2D flips decoded images. Cubemap faces are not.
+    const auto cubemap = options.inputFilepaths.size() == 6u;
+    std::vector<RGBAImage> faces;
+    auto alpha = false;
+    for (const auto &inputFilepath : options.inputFilepaths) {
+        faces.push_back(loadImage(inputFilepath, !cubemap));
+        const auto &face = faces.back();
+        if (face.pixels.empty()) {
+            std::fprintf(stderr, "Failed to load image: %s\n", inputFilepath.c_str());
+            return EXIT_FAILURE;
+        }
+        if (cubemap && (face.width != face.height || face.width != faces.front().width)) {
+            std::fprintf(stderr, "Cubemap faces must be square and of equal size: %s\n",
+                         inputFilepath.c_str());
+            return EXIT_FAILURE;
+        }
+
+        for (auto i = 3u; i < face.pixels.size(); i += 4u) {
+            alpha = alpha || face.pixels[i] < 255u;
+        }
+    }
+
+    const auto width = faces.front().width;
+    const auto height = faces.front().height;
+
+    // Compressed levels of every face from the largest
+    std::vector<std::vector<std::vector<std::uint8_t>>> levels;
+    std::size_t uncompressedSize_bytes = 0u;
+    for (;;) {
+        levels.emplace_back();
+        for (const auto &face : faces) {
+            levels.back().push_back(compress(face, alpha));
+            uncompressedSize_bytes += face.pixels.size();
+        }
+
+        const auto &face = faces.front();
+        if (!options.mipmaps || (face.width == 1 && face.height == 1)) break;
+        for (auto &level : faces) {
+            level = downsample(level);
+        }
+    }
+
+    const auto vkFormat = alpha ?
+            (options.srgb ? age::KTX2::VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK :
+                            age::KTX2::VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK) :
+            (options.srgb ? age::KTX2::VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK :
+                            age::KTX2::VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK);
+    if (!writeKTX2(options.outputFilepath, vkFormat, options.srgb, width, height, levels)) {
+        std::fprintf(stderr, "Failed to write: %s\n", options.outputFilepath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::size_t compressedSize_bytes = 0u;
+    for (const auto &level : levels) {
+        for (const auto &face : level) compressedSize_bytes += face.size();
+    }
+    std::printf("format: %s\n", alpha ? "ETC2_RGBA8" : "ETC2_RGB8");
+    std::printf("faces: %zu\n", faces.size());
+    std::printf("mip_levels: %zu\n", levels.size());
+    std::printf("uncompressed_bytes: %zu\n", uncompressedSize_bytes);
+    std::printf("compressed_bytes: %zu\n", compressedSize_bytes);
+    return EXIT_SUCCESS;
+}
@@ -4,25 +4,18 @@
 
 #include <GLES3/gl32.h>
 
+#include <android_game_engine/GLState.h>
 #include <network/MsgTypeId.h>
 
 JNI_METHOD_DEFINITION(void, onSurfaceCreatedJNI)(JNIEnv *env, jobject activity,
                                                  int width, int height, int displayRotation) {
+    age::GameEngine::onContextCreated();
     age::GameEngine::onSurfaceCreated(width, height, displayRotation,
                                       std::make_unique<age::MobileControlStation>());
 }
 
-JNI_METHOD_DEFINITION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-                                                    float x, float y) {
-    reinterpret_cast<age::MobileControlStation*>(age::GameEngine::getGame())->onLeftJoystickInput(x, y);
-}
-
-JNI_METHOD_DEFINITION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-                                                     float x, float y) {
-    reinterpret_cast<age::MobileControlStation*>(age::GameEngine::getGame())->onRightJoystickInput(x, y);
-}
-
 JNI_METHOD_DEFINITION(void, onResetJNI)(JNIEnv *env, jobject gameActivity) {
+    auto lock = age::GameEngine::lockSimulation();
     reinterpret_cast<age::MobileControlStation*>(age::GameEngine::getGame())->onReset();
 }
 
@@ -39,7 +32,7 @@ MobileControlStation::MobileControlStation() : Game(),
 
 void MobileControlStation::onWindowChanged(int width, int height, int displayRotation) {
     Game::onWindowChanged(width, height, displayRotation);
-    glViewport(0, 0, width, height);
+    GLState::viewport(0, 0, width, height);
 }
 
 void MobileControlStation::onUpdate(std::chrono::duration<float> updateDuration) {
@@ -47,13 +40,29 @@ void MobileControlStation::onUpdate(std::chrono::duration<float> updateDuration)
     this->ntwkNode.runOnce();
 }
 
-void MobileControlStation::render() {
+void MobileControlStation::render(float interpolation) {
     glClear(GL_COLOR_BUFFER_BIT);
+    if (!this->imageMsgDisplayShader.isReady()) return;
 
     this->imageMsgDisplayShader.use();
     this->imgMsgDisplay.render(&this->imageMsgDisplayShader);
 }
 
+void MobileControlStation::onInput(const std::vector<InputEvent> &events) {
+    Game::onInput(events);
+
+    // Joystick 0 is the left joystick and joystick 1 the right one
+    for (const auto &event : events) {
+        if (event.type == InputEvent::Type::JOYSTICK) {
+            if (event.source == 0) {
+                this->onLeftJoystickInput(event.x, event.y);
+            } else {
+                this->onRightJoystickInput(event.x, event.y);
+            }
+        }
+    }
+}
+
 void MobileControlStation::onLeftJoystickInput(float x, float y) { }
 void MobileControlStation::onRightJoystickInput(float x, float y) { }
 void MobileControlStation::onReset() {}
@@ -14,10 +14,6 @@
 extern "C" {
 JNI_METHOD_DECLARATION(void, onSurfaceCreatedJNI)(JNIEnv *env, jobject activity,
                                                   int width, int height, int displayRotation);
-JNI_METHOD_DECLARATION(void, onLeftJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-    float x, float y);
-JNI_METHOD_DECLARATION(void, onRightJoystickInputJNI)(JNIEnv *env, jobject gameActivity,
-    float x, float y);
 JNI_METHOD_DECLARATION(void, onResetJNI)(JNIEnv *env, jobject gameActivity);
 }
 
@@ -30,7 +26,9 @@ public:
     void onWindowChanged(int width, int height, int displayRotation) override;
 
     void onUpdate(std::chrono::duration<float> updateDuration) override;
-    void render() override;
+    void render(float interpolation) override;
+
+    void onInput(const std::vector<InputEvent> &events) override;
 
     void onLeftJoystickInput(float x, float y);
     void onRightJoystickInput(float x, float y);
@@ -7,13 +7,14 @@ import android.opengl.GLSurfaceView
 import android.os.Bundle
 import android.os.Handler
 import android.os.Looper
-import android.view.MotionEvent
 import android.view.View.OnTouchListener
 import android.widget.Toast
 import androidx.appcompat.app.AppCompatActivity
 import androidx.core.app.ActivityCompat
 import com.example.androidgameengine.databinding.ArActivityGameBinding
 import com.google.android.material.snackbar.Snackbar
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 import javax.microedition.khronos.egl.EGLConfig
 import javax.microedition.khronos.opengles.GL10
 
@@ -25,6 +26,11 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
         private const val SNACKBAR_COLOR = -0x40cdcdce
         private const val SNACKBAR_TEXT_COLOR = Color.WHITE
 
+        // Native events, which must match age::GameAR::Event and age::GameActivityAR::Event
+        private const val NATIVE_EVENT_SIZE = 16
+        private const val AR_PLANE_INITIALIZED_EVENT = 1
+        private const val GAME_INITIALIZED_EVENT = 2
+
         init { System.loadLibrary("game_activity_ar") }
     }
 
@@ -32,8 +38,6 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
     ///
     /// Functions to be declared and implemented by the custom Game class.
     ///@{
-    private external fun onJoystickInputJNI(x: Float, y: Float)
-
     private external fun onResetJNI()
     ///@}
 
@@ -53,12 +57,12 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
 
     private external fun updateJNI()
 
-    private external fun onTouchDownEventJNI(x: Float, y: Float)
-    private external fun onTouchMoveEventJNI(x: Float, y: Float)
-    private external fun onTouchUpEventJNI(x: Float, y: Float)
+    private external fun setInputEventBufferJNI(buffer: ByteBuffer)
+    private external fun onInputEventsJNI(numEvents: Int)
     ///@}
 
     private lateinit var binding: ArActivityGameBinding
+    private val inputEvents = InputEventBuffer(512)
 
     private lateinit var arPlaneInitializedHandler: Handler
     private val arPlaneInitializedRunnable = Runnable {
@@ -89,14 +93,10 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
         this.binding.glSurfaceView.setEGLContextClientVersion(3)
         this.binding.glSurfaceView.preserveEGLContextOnPause = true
         this.binding.glSurfaceView.setRenderer(this)
-        this.binding.glSurfaceView.setOnTouchListener(OnTouchListener { _, event -> // Save event results before passing it to glSurfaceView thread to prevent race condition
-            this.binding.glSurfaceView.queueEvent{
-                when (event.action) {
-                    MotionEvent.ACTION_DOWN -> onTouchDownEventJNI( event.x, event.y )
-                    MotionEvent.ACTION_MOVE -> onTouchMoveEventJNI( event.x, event.y )
-                    MotionEvent.ACTION_UP -> onTouchUpEventJNI( event.x, event.y )
-                }
-            }
+        this.setInputEventBufferJNI(this.inputEvents.buffer)
+        this.binding.glSurfaceView.setOnTouchListener(OnTouchListener { _, event ->
+            this.inputEvents.addTouchEvent(event)
+            this.sendInputEvents()
             true
         })
 
@@ -177,14 +177,8 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
 
         this.binding.joystick.setOnTouchListener { view, event ->
             val result = view.onTouchEvent(event)
-            this.binding.glSurfaceView.queueEvent {
-                when (event.action) {
-                    MotionEvent.ACTION_DOWN, MotionEvent.ACTION_MOVE -> this.onJoystickInputJNI(
-                        this.binding.joystick.xAxis, this.binding.joystick.yAxis)
-
-                    MotionEvent.ACTION_UP -> this.onJoystickInputJNI(0.0f, 0.0f)
-                }
-            }
+            this.inputEvents.addJoystickEvent(0, this.binding.joystick, event)
+            this.sendInputEvents()
             result
         }
 
@@ -193,11 +187,27 @@ class GameActivityAR: AppCompatActivity(), ActivityCompat.OnRequestPermissionsRe
         }
     }
 
+    private fun sendInputEvents() {
+        this.inputEvents.flush { numEvents -> this.onInputEventsJNI(numEvents) }
+    }
+
     override fun onSurfaceChanged(gl: GL10, width: Int, height: Int) =
         this.onSurfaceChangedJNI(width, height, this.windowManager.defaultDisplay.rotation)
 
     override fun onDrawFrame(gl: GL10) = updateJNI()
 
+    /// Receives the events that the game posted during a frame. Invoked by the game engine on the
+    /// GL thread.
+    private fun onNativeEvents(events: ByteBuffer, numEvents: Int) {
+        events.order(ByteOrder.nativeOrder())
+        for (i in 0 until numEvents) {
+            when (events.getInt(i * NATIVE_EVENT_SIZE)) {
+                AR_PLANE_INITIALIZED_EVENT -> this.arPlaneInitialized()
+                GAME_INITIALIZED_EVENT -> this.gameInitialized()
+            }
+        }
+    }
+
     private fun arPlaneInitialized(): Unit {
         this.arPlaneInitializedHandler.post(arPlaneInitializedRunnable)
     }
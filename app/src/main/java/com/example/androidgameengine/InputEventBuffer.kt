@@ -0,0 +1,92 @@
+package com.example.androidgameengine
+
+import android.view.MotionEvent
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/// Input events collected on the UI thread in memory that is shared with the game engine.
+///
+/// The layout of an event must match age::InputEvent. The buffer is only accessed by the UI
+/// thread: after adding the samples of a MotionEvent, flush() hands them to the engine's
+/// onInputEventsJNI function, which pushes them into the engine's lock-free input ring in a single
+/// JNI call. Events that are added while the buffer is full are dropped.
+class InputEventBuffer(private val capacity: Int) {
+    companion object {
+        const val TOUCH_DOWN = 0
+        const val TOUCH_MOVE = 1
+        const val TOUCH_UP = 2
+        const val JOYSTICK = 3
+
+        private const val EVENT_SIZE = 24
+        private const val NANOSECONDS_PER_MILLISECOND = 1000000L
+    }
+
+    val buffer: ByteBuffer =
+        ByteBuffer.allocateDirect(capacity * EVENT_SIZE).order(ByteOrder.nativeOrder())
+
+    val size
+        get() = this.buffer.position() / EVENT_SIZE
+
+    fun add(type: Int, source: Int, x: Float, y: Float, eventTime_ms: Long) {
+        if (this.size == this.capacity) return
+
+        this.buffer.putInt(type)
+            .putInt(source)
+            .putFloat(x)
+            .putFloat(y)
+            .putLong(eventTime_ms * NANOSECONDS_PER_MILLISECOND)
+    }
+
+    /// Adds a sample of every pointer of the event, including the samples batched into a move
+    /// since the last event. The source of touch events is the pointer id.
+    fun addTouchEvent(event: MotionEvent) {
+        when (event.actionMasked) {
+            MotionEvent.ACTION_DOWN, MotionEvent.ACTION_POINTER_DOWN ->
+                this.addPointer(TOUCH_DOWN, event, event.actionIndex)
+
+            MotionEvent.ACTION_MOVE -> {
+                for (h in 0 until event.historySize) {
+                    for (p in 0 until event.pointerCount) {
+                        this.add(TOUCH_MOVE, event.getPointerId(p), event.getHistoricalX(p, h),
+                                 event.getHistoricalY(p, h), event.getHistoricalEventTime(h))
+                    }
+                }
+                for (p in 0 until event.pointerCount) {
+                    this.addPointer(TOUCH_MOVE, event, p)
+                }
+            }
+
+            MotionEvent.ACTION_UP, MotionEvent.ACTION_POINTER_UP ->
+                this.addPointer(TOUCH_UP, event, event.actionIndex)
+
+            MotionEvent.ACTION_CANCEL -> {
+                for (p in 0 until event.pointerCount) {
+                    this.addPointer(TOUCH_UP, event, p)
+                }
+            }
+        }
+    }
+
+    fun addJoystickEvent(joystickIndex: Int, joystick: Joystick, event: MotionEvent) {
+        when (event.actionMasked) {
+            MotionEvent.ACTION_DOWN, MotionEvent.ACTION_MOVE -> this.add(
+                JOYSTICK, joystickIndex, joystick.xAxis, joystick.yAxis, event.eventTime)
+
+            else -> this.add(JOYSTICK, joystickIndex, 0.0f, 0.0f, event.eventTime)
+        }
+    }
+
+    /// Passes the number of added events to send, e.g. the engine's onInputEventsJNI, and clears
+    /// the buffer.
+    fun flush(send: (Int) -> Unit) {
+        if (this.size > 0) {
+            send(this.size)
+        }
+        this.buffer.clear()
+    }
+
+    private fun addPointer(type: Int, event: MotionEvent, pointerIndex: Int) {
+        this.add(type, event.getPointerId(pointerIndex), event.getX(pointerIndex),
+                 event.getY(pointerIndex), event.eventTime)
+    }
+}
@@ -4,10 +4,10 @@ import android.content.Context
 import android.content.res.AssetManager
 import android.opengl.GLSurfaceView
 import android.os.Bundle
-import android.view.MotionEvent
 import androidx.appcompat.app.AppCompatActivity
 import com.example.androidgameengine.databinding.ActivityGameBinding
 import com.example.androidgameengine.databinding.StationControlMobileBinding
+import java.nio.ByteBuffer
 import javax.microedition.khronos.egl.EGLConfig
 import javax.microedition.khronos.opengles.GL10
 
@@ -22,8 +22,6 @@ class MobileControlStation : AppCompatActivity(), GLSurfaceView.Renderer {
     ///
     /// Functions to be declared and implemented by the custom Game class.
     ///@{
-    private external fun onLeftJoystickInputJNI(x: Float, y: Float)
-    private external fun onRightJoystickInputJNI(x: Float, y: Float)
     private external fun onResetJNI()
     ///@}
 
@@ -43,12 +41,12 @@ class MobileControlStation : AppCompatActivity(), GLSurfaceView.Renderer {
 
     private external fun updateJNI()
 
-    private external fun onTouchDownEventJNI(x: Float, y: Float)
-    private external fun onTouchMoveEventJNI(x: Float, y: Float)
-    private external fun onTouchUpEventJNI(x: Float, y: Float)
+    private external fun setInputEventBufferJNI(buffer: ByteBuffer)
+    private external fun onInputEventsJNI(numEvents: Int)
     ///@}
 
     private lateinit var binding: StationControlMobileBinding
+    private val inputEvents = InputEventBuffer(512)
 
     override fun onCreate(savedInstanceState: Bundle?) {
         super.onCreate(savedInstanceState)
@@ -61,14 +59,10 @@ class MobileControlStation : AppCompatActivity(), GLSurfaceView.Renderer {
         this.binding.glSurfaceView.setEGLContextClientVersion(3)
         this.binding.glSurfaceView.preserveEGLContextOnPause = true
         this.binding.glSurfaceView.setRenderer(this)
+        this.setInputEventBufferJNI(this.inputEvents.buffer)
         this.binding.glSurfaceView.setOnTouchListener{_, event ->
-            this.binding.glSurfaceView.queueEvent{
-                when (event.action) {
-                    MotionEvent.ACTION_DOWN -> this.onTouchDownEventJNI(event.x, event.y)
-                    MotionEvent.ACTION_MOVE -> this.onTouchMoveEventJNI(event.x, event.y)
-                    MotionEvent.ACTION_UP -> this.onTouchUpEventJNI(event.x, event.y)
-                }
-            }
+            this.inputEvents.addTouchEvent(event)
+            this.sendInputEvents()
             true
         }
 
@@ -111,28 +105,15 @@ class MobileControlStation : AppCompatActivity(), GLSurfaceView.Renderer {
 
         this.binding.leftJoystick.setOnTouchListener{view, event ->
             val result = view.onTouchEvent(event)
-            this.binding.glSurfaceView.queueEvent{
-                when (event.action) {
-                    MotionEvent.ACTION_DOWN, MotionEvent.ACTION_MOVE -> this.onLeftJoystickInputJNI(
-                            this.binding.leftJoystick.xAxis, this.binding.leftJoystick.yAxis)
-
-                    else -> this.onLeftJoystickInputJNI(0.0f, 0.0f)
-                }
-            }
+            this.inputEvents.addJoystickEvent(0, this.binding.leftJoystick, event)
+            this.sendInputEvents()
             result
         }
 
         this.binding.rightJoystick.setOnTouchListener{view, event ->
             val result = view.onTouchEvent(event)
-            this.binding.glSurfaceView.queueEvent{
-                when (event.action) {
-                    MotionEvent.ACTION_DOWN, MotionEvent.ACTION_MOVE ->
-                        this.onRightJoystickInputJNI(
-                            this.binding.rightJoystick.xAxis, this.binding.rightJoystick.yAxis)
-
-                    else -> this.onRightJoystickInputJNI(0.0f, 0.0f)
-                }
-            }
+            this.inputEvents.addJoystickEvent(1, this.binding.rightJoystick, event)
+            this.sendInputEvents()
             result
         }
 
@@ -141,6 +122,10 @@ class MobileControlStation : AppCompatActivity(), GLSurfaceView.Renderer {
         }
     }
 
+    private fun sendInputEvents() {
+        this.inputEvents.flush { numEvents -> this.onInputEventsJNI(numEvents) }
+    }
+
     override fun onSurfaceChanged(gl: GL10, width: Int, height: Int) =
         this.onSurfaceChangedJNI(width, height, this.windowManager.defaultDisplay.rotation)
 